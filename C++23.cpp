@@ -10,56 +10,15 @@
  * - Deduced `this` for simplified member function overloads.
  */
 
-#include <iostream>
 #include <string>
 #include <vector>
 #include <map>      // For comparison with flat_map
 #include <flat_map> // C++23: std::flat_map for contiguous key-value storage.
+#include <functional>
 #include <print>    // C++23: std::print for formatted output.
 #include <string_view>
 
-/**
- * @brief A class demonstrating deduced `this` in C++23.
- * @details Deduced `this` allows for more flexible member function overloads
- *          based on the cv-qualifiers and ref-qualifiers of the object.
- */
-class MyClass
-{
-    int value_ = 0;
-
-public:
-    /**
-     * @brief Constructor for MyClass.
-     * @param val Initial value.
-     */
-    MyClass(int val) : value_(val) {}
-
-    /**
-     * @brief Returns the value by const reference.
-     * @tparam Self The deduced type of `*this`.
-     * @param self The object itself (deduced `this`).
-     * @return A const reference to the value.
-     * @details This overload is chosen when the object is `const`.
-     */
-    auto get_value(this const MyClass &self) -> const int &
-    { ///< C++23: Deduced `this` for const-qualified member function.
-        std::cout << "(const ref) ";
-        return self.value_;
-    }
-
-    /**
-     * @brief Returns the value by non-const reference.
-     * @tparam Self The deduced type of `*this`.
-     * @param self The object itself (deduced `this`).
-     * @return A non-const reference to the value.
-     * @details This overload is chosen when the object is non-`const`.
-     */
-    auto get_value(this MyClass &self) -> int &
-    { ///< C++23: Deduced `this` for non-const-qualified member function.
-        std::cout << "(non-const ref) ";
-        return self.value_;
-    }
-};
+#include "my_class.hpp" // MyClass, whose get_value tracing is chosen by LEARNINGS_ACCESS_TRACE.
 
 /**
  * @brief A compile-time function demonstrating `if consteval`.
@@ -93,7 +52,8 @@ const char *check_consteval(int val)
 int main()
 {
     // C++23: std::flat_map
-    std::flat_map<std::string, int> ages; ///< C++23: std::flat_map for contiguous storage and better cache performance.
+    // std::less<> is transparent, so string_view and const char* lookups need no temporary std::string.
+    std::flat_map<std::string, int, std::less<>> ages; ///< C++23: std::flat_map for contiguous storage and better cache performance.
     ages["Alice"] = 30;
     ages["Bob"] = 25;
     ages["Charlie"] = 35;
@@ -104,6 +64,12 @@ int main()
         std::print("  {}: {}\n", name, age);
     }
 
+    std::string_view lookup = "Bob";
+    if (const auto it = ages.find(lookup); it != ages.end())
+    { // Heterogeneous lookup: the string_view is compared in place.
+        std::print("{} is {}.\n", it->first, it->second);
+    }
+
     // C++23: std::string::contains
     std::string sentence = "The quick brown fox jumps over the lazy dog.";
     if (sentence.contains("fox"))
@@ -128,6 +94,15 @@ int main()
 
     std::print("obj.get_value(): {}\n", obj.get_value());
     std::print("const_obj.get_value(): {}\n", const_obj.get_value());
+    std::print("MyClass(300).get_value(): {}\n", MyClass(300).get_value()); // Rvalue: the payload is moved out.
+
+    if constexpr (std::same_as<learnings::default_access_trace, learnings::trace_ring_buffer>)
+    { // Built with LEARNINGS_ACCESS_TRACE=ring_buffer: inspect with `trace_dump c++23.trace`.
+        if (const auto written = learnings::trace_ring_buffer::dump("c++23.trace"))
+        {
+            std::print("Wrote {} accesses to c++23.trace.\n", *written);
+        }
+    }
 
     return 0;
 }
@@ -0,0 +1,65 @@
+/**
+ * @file alloc_counter.hpp
+ * @brief Replaces the global allocation functions to count heap traffic.
+ *
+ * Include this header in exactly one translation unit of a benchmark: it
+ * defines the replaceable `operator new`/`operator delete`, which may only be
+ * defined once per program. The counters are process-wide and relaxed, which
+ * is precise for single-threaded measurement sections.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+
+namespace bench
+{
+    /**
+     * @brief Process-wide heap counters maintained by the replaced operators.
+     */
+    struct alloc_stats
+    {
+        static inline std::atomic<std::size_t> allocations{0}; ///< Calls to operator new.
+        static inline std::atomic<std::size_t> live_bytes{0};  ///< Bytes currently allocated.
+    };
+
+    namespace detail
+    {
+        /// Each block is prefixed with its size so that unsized delete can account for it.
+        inline constexpr std::size_t alloc_header = alignof(std::max_align_t);
+
+        inline void *counted_alloc(std::size_t size)
+        {
+            void *block = std::malloc(size + alloc_header);
+            if (block == nullptr)
+            {
+                throw std::bad_alloc();
+            }
+            *static_cast<std::size_t *>(block) = size;
+            alloc_stats::allocations.fetch_add(1, std::memory_order_relaxed);
+            alloc_stats::live_bytes.fetch_add(size, std::memory_order_relaxed);
+            return static_cast<std::byte *>(block) + alloc_header;
+        }
+
+        inline void counted_free(void *ptr) noexcept
+        {
+            if (ptr == nullptr)
+            {
+                return;
+            }
+            void *block = static_cast<std::byte *>(ptr) - alloc_header;
+            alloc_stats::live_bytes.fetch_sub(*static_cast<std::size_t *>(block), std::memory_order_relaxed);
+            std::free(block);
+        }
+    } // namespace detail
+} // namespace bench
+
+void *operator new(std::size_t size) { return bench::detail::counted_alloc(size); }
+void *operator new[](std::size_t size) { return bench::detail::counted_alloc(size); }
+void operator delete(void *ptr) noexcept { bench::detail::counted_free(ptr); }
+void operator delete[](void *ptr) noexcept { bench::detail::counted_free(ptr); }
+void operator delete(void *ptr, std::size_t) noexcept { bench::detail::counted_free(ptr); }
+void operator delete[](void *ptr, std::size_t) noexcept { bench::detail::counted_free(ptr); }
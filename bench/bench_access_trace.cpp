@@ -0,0 +1,171 @@
+/**
+ * @file bench_access_trace.cpp
+ * @brief Cost of `MyClass::get_value` under each tracing policy: none, ring buffer and iostream.
+ *
+ * Every variant sums `get_value()` over an array of objects, alternating the
+ * const and non-const overloads. The iostream variant writes into a stream
+ * buffer that only counts characters, so the cost measured is the stream
+ * machinery and not a terminal. The ring buffer variant also runs on several
+ * threads at once, to show that recording shares nothing between threads.
+ * Checks: all variants compute the same sum, the iostream output has the
+ * expected length, and a dump read back holds the last `trace_ring::capacity`
+ * accesses of the recording thread.
+ *
+ * Usage: `bench_access_trace [accesses]` (default 10'000'000).
+ */
+
+#include "bench_common.hpp"
+#include "my_class.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+#include <filesystem>
+#include <iostream>
+#include <print>
+#include <streambuf>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace
+{
+    /**
+     * @brief A stream buffer that discards output and counts it.
+     */
+    class counting_buffer : public std::streambuf
+    {
+    public:
+        std::size_t written = 0;
+
+    protected:
+        int_type overflow(int_type c) override
+        {
+            ++written;
+            return traits_type::not_eof(c);
+        }
+
+        std::streamsize xsputn(const char *, std::streamsize n) override
+        {
+            written += static_cast<std::size_t>(n);
+            return n;
+        }
+    };
+
+    /**
+     * @brief Sums `get_value()` for @p accesses calls, half through each overload.
+     */
+    template <typename Trace>
+    long long sum_values(std::vector<learnings::basic_my_class<int, Trace>> &objects, std::size_t accesses)
+    {
+        long long sum = 0;
+        for (std::size_t i = 0; i < accesses; i += 2)
+        {
+            auto &object = objects[(i / 2) % objects.size()];
+            sum += object.get_value();
+            sum += std::as_const(object).get_value();
+        }
+        return sum;
+    }
+
+    template <typename Trace>
+    std::vector<learnings::basic_my_class<int, Trace>> make_objects()
+    {
+        std::vector<learnings::basic_my_class<int, Trace>> objects;
+        for (int i = 0; i < 1024; ++i)
+        {
+            objects.emplace_back(i);
+        }
+        return objects;
+    }
+
+    template <typename Trace>
+    long long measure(const char *variant, std::size_t accesses)
+    {
+        auto objects = make_objects<Trace>();
+        long long sum = 0;
+        const double ns = bench::time_ns([&] { sum = sum_values(objects, accesses); });
+        bench::do_not_optimize(sum);
+        bench::print_csv_row("access_trace", variant, accesses, "ns_per_access", ns / static_cast<double>(accesses));
+        return sum;
+    }
+} // namespace
+
+int main(int argc, char **argv)
+{
+    const std::size_t accesses = bench::max_size_arg(argc, argv, 10'000'000) & ~std::size_t{1};
+    const std::size_t stream_accesses = accesses / 10 & ~std::size_t{1}; // The stream is too slow for the full count.
+
+    bench::print_csv_header();
+    bool ok = true;
+    const long long expected = measure<learnings::trace_none>("none", accesses);
+    ok = measure<learnings::trace_ring_buffer>("ring_buffer", accesses) == expected && ok;
+
+    {
+        counting_buffer sink;
+        std::streambuf *const console = std::cout.rdbuf(&sink);
+        const long long stream_sum = measure<learnings::trace_iostream>("iostream", stream_accesses);
+        std::cout.rdbuf(console);
+        auto reference = make_objects<learnings::trace_none>();
+        ok = stream_sum == sum_values(reference, stream_accesses) && ok;
+        const std::size_t per_pair = std::string_view("(non-const ref) (const ref) ").size();
+        if (sink.written != stream_accesses / 2 * per_pair)
+        {
+            std::print(stderr, "iostream policy wrote {} characters, expected {}\n", sink.written,
+                       stream_accesses / 2 * per_pair);
+            ok = false;
+        }
+    }
+
+    const unsigned threads = std::max(std::thread::hardware_concurrency(), 2u);
+    {
+        const std::size_t per_thread = accesses / threads & ~std::size_t{1};
+        std::vector<long long> sums(threads);
+        const double ns = bench::time_ns([&] {
+            std::vector<std::jthread> workers;
+            for (unsigned t = 0; t < threads; ++t)
+            {
+                workers.emplace_back([&, t] {
+                    auto objects = make_objects<learnings::trace_ring_buffer>();
+                    sums[t] = sum_values(objects, per_thread);
+                });
+            }
+        });
+        bench::print_csv_row("access_trace", "ring_buffer/threads_" + std::to_string(threads), per_thread * threads,
+                             "ns_per_access", ns / static_cast<double>(per_thread * threads));
+        auto reference = make_objects<learnings::trace_none>();
+        const long long per_thread_sum = sum_values(reference, per_thread);
+        ok = std::ranges::all_of(sums, [&](long long sum) { return sum == per_thread_sum; }) && ok;
+    }
+
+    // The main thread's ring holds its last `capacity` accesses, or all of them, alternating the two overloads.
+    const auto path = std::filesystem::temp_directory_path() / "bench_access_trace.trace";
+    const auto written = learnings::trace_ring_buffer::dump(path);
+    const auto trace = learnings::read_trace_file(path);
+    std::filesystem::remove(path);
+    if (!written || !trace || trace->second.size() != *written)
+    {
+        std::print(stderr, "trace dump did not round-trip\n");
+        return EXIT_FAILURE;
+    }
+    std::size_t main_thread_events = 0;
+    learnings::access_kind last_kind{};
+    for (const auto &event : trace->second)
+    {
+        if (event.thread == 0)
+        {
+            ++main_thread_events;
+            last_kind = event.kind;
+        }
+    }
+    const std::size_t expected_events = std::min(accesses, learnings::trace_ring::capacity);
+    if (main_thread_events != expected_events ||
+        (expected_events != 0 && last_kind != learnings::access_kind::const_ref))
+    {
+        std::print(stderr, "trace holds {} events of the main thread, expected {}\n", main_thread_events,
+                   expected_events);
+        ok = false;
+    }
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
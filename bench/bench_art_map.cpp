@@ -0,0 +1,127 @@
+/**
+ * @file bench_art_map.cpp
+ * @brief Point and prefix queries on `art_map` against `std::flat_map<std::string, int>`.
+ *
+ * Point lookups mix hits with names that are absent. Prefix queries sum the
+ * values of every name starting with a random 1-4 byte prefix of a real name;
+ * the flat_map answers them with `lower_bound` plus a scan while the prefix
+ * still matches. The tree is bulk-loaded from the flat_map, and every query
+ * must agree with it.
+ *
+ * Usage: `bench_art_map [size]` (default 1'000'000).
+ */
+
+#include "art_map.hpp"
+#include "bench_common.hpp"
+#include "flat_map_bulk.hpp"
+
+#include <cstdlib>
+#include <flat_map>
+#include <print>
+#include <random>
+#include <string>
+#include <string_view>
+#include <vector>
+
+int main(int argc, char **argv)
+{
+    const std::size_t max_n = bench::max_size_arg(argc, argv, 1'000'000);
+    constexpr std::size_t lookups = 1'000'000;
+    constexpr std::size_t prefix_queries = 10'000;
+
+    bench::print_csv_header();
+    bool ok = true;
+    for (const std::size_t n : bench::size_ladder(1'000, max_n))
+    {
+        // The second half of the generated names is never inserted and supplies the misses.
+        const auto names = bench::make_names(2 * n);
+        learnings::flat_map_bulk_loader<std::string, int, std::less<>> loader;
+        for (std::size_t i = 0; i < n; ++i)
+        {
+            loader.add(names[i], static_cast<int>(i % 100));
+        }
+        const std::flat_map<std::string, int, std::less<>> ages = std::move(loader).build();
+
+        double ns = bench::time_ns([&] { bench::do_not_optimize(learnings::art_map<int>(ages).size()); });
+        bench::print_csv_row("art_build", "bulk_load", n, "ns_per_key", ns / n);
+        const learnings::art_map<int> tree(ages);
+
+        std::mt19937_64 rng(41);
+        std::vector<std::string> probes(lookups);
+        for (std::size_t i = 0; i < lookups; ++i)
+        {
+            probes[i] = names[rng() % n + (i % 2 == 1 ? n : 0)];
+        }
+
+        long sum = 0;
+        ns = bench::time_ns([&] {
+            for (const auto &probe : probes)
+            {
+                const auto it = ages.find(std::string_view(probe));
+                sum += it == ages.end() ? 0 : it->second;
+            }
+        });
+        bench::print_csv_row("art_point", "flat_map", n, "ns_per_lookup", ns / lookups);
+
+        long tree_sum = 0;
+        ns = bench::time_ns([&] {
+            for (const auto &probe : probes)
+            {
+                const int *value = tree.find(probe);
+                tree_sum += value == nullptr ? 0 : *value;
+            }
+        });
+        bench::print_csv_row("art_point", "art_map", n, "ns_per_lookup", ns / lookups);
+        ok = ok && sum == tree_sum;
+
+        for (const std::size_t length : {1, 2, 4})
+        {
+            std::vector<std::string> prefixes(prefix_queries);
+            for (auto &prefix : prefixes)
+            {
+                prefix = names[rng() % n].substr(0, length);
+            }
+
+            long scan_sum = 0;
+            ns = bench::time_ns([&] {
+                for (const auto &prefix : prefixes)
+                {
+                    for (auto it = ages.lower_bound(std::string_view(prefix));
+                         it != ages.end() && std::string_view(it->first).starts_with(prefix); ++it)
+                    {
+                        scan_sum += it->second;
+                    }
+                }
+            });
+            const std::string variant = "prefix_" + std::to_string(length);
+            bench::print_csv_row("art_prefix", "flat_map/" + variant, n, "ns_per_query", ns / prefix_queries);
+
+            long prefix_sum = 0;
+            ns = bench::time_ns([&] {
+                for (const auto &prefix : prefixes)
+                {
+                    tree.for_each_with_prefix(prefix, [&](std::string_view, int value) { prefix_sum += value; });
+                }
+            });
+            bench::print_csv_row("art_prefix", "art_map/" + variant, n, "ns_per_query", ns / prefix_queries);
+            bench::do_not_optimize(scan_sum);
+            ok = ok && scan_sum == prefix_sum;
+        }
+
+        // Full iteration must reproduce the flat_map's order exactly.
+        auto it = ages.begin();
+        tree.for_each([&](std::string_view key, int value) {
+            ok = ok && it != ages.end() && it->first == key && it->second == value;
+            ++it;
+        });
+        ok = ok && it == ages.end();
+        bench::do_not_optimize(sum);
+    }
+
+    if (!ok)
+    {
+        std::print(stderr, "art_map disagrees with flat_map\n");
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,97 @@
+/**
+ * @file bench_bloom_filter.cpp
+ * @brief End-to-end lookups through `bloom_filtered_map` against a bare `std::flat_map<std::string, int>`.
+ *
+ * Probe streams mix hits with absent names at miss ratios from 50% to 99%,
+ * for filters sized for 1% and 0.1% false positives. The measured false
+ * positive rate and filter size are reported next to the latency; the
+ * filtered map must return the same results as the bare one.
+ *
+ * Usage: `bench_bloom_filter [size]` (default 1'000'000).
+ */
+
+#include "bench_common.hpp"
+#include "bloom_filter.hpp"
+#include "flat_map_bulk.hpp"
+
+#include <cstdlib>
+#include <flat_map>
+#include <print>
+#include <random>
+#include <string>
+#include <vector>
+
+int main(int argc, char **argv)
+{
+    const std::size_t n = bench::max_size_arg(argc, argv, 1'000'000);
+    constexpr std::size_t lookups = 1'000'000;
+
+    // The second half of the generated names is never inserted and supplies the misses.
+    const auto names = bench::make_names(2 * n);
+    learnings::flat_map_bulk_loader<std::string, int> loader;
+    for (std::size_t i = 0; i < n; ++i)
+    {
+        loader.add(names[i], static_cast<int>(i % 100));
+    }
+    const auto ages = std::move(loader).build();
+
+    bench::print_csv_header();
+    bool ok = true;
+    for (const double fpr : {0.01, 0.001})
+    {
+        const learnings::bloom_filtered_map<std::string, int> filtered(ages, fpr);
+        const std::string suffix = "fpr_" + std::to_string(fpr).substr(0, 5);
+        bench::print_csv_row("bloom_memory", suffix, n, "bits_per_key",
+                             8.0 * static_cast<double>(filtered.filter().memory_bytes()) / n);
+
+        for (const int miss_percent : {50, 90, 99})
+        {
+            std::mt19937_64 rng(37);
+            std::uniform_int_distribution<std::size_t> pick(0, n - 1);
+            std::uniform_int_distribution<int> percent(0, 99);
+            std::vector<std::string> probes(lookups);
+            for (auto &probe : probes)
+            {
+                probe = names[pick(rng) + (percent(rng) < miss_percent ? n : 0)];
+            }
+            const std::string variant = "miss_" + std::to_string(miss_percent) + "/" + suffix;
+
+            long sum = 0;
+            double ns = bench::time_ns([&] {
+                for (const auto &probe : probes)
+                {
+                    const auto it = ages.find(probe);
+                    sum += it == ages.end() ? 0 : it->second;
+                }
+            });
+            bench::print_csv_row("bloom_lookup", "flat_map/" + variant, n, "ns_per_lookup", ns / lookups);
+
+            long filtered_sum = 0;
+            ns = bench::time_ns([&] {
+                for (const auto &probe : probes)
+                {
+                    const auto it = filtered.find(probe);
+                    filtered_sum += it == filtered.end() ? 0 : it->second;
+                }
+            });
+            bench::print_csv_row("bloom_lookup", "bloom_filtered_map/" + variant, n, "ns_per_lookup", ns / lookups);
+            bench::do_not_optimize(sum);
+            ok = ok && sum == filtered_sum;
+        }
+
+        // False positives: absent names the filter lets through.
+        std::size_t passed = 0;
+        for (std::size_t i = n; i < 2 * n; ++i)
+        {
+            passed += filtered.filter().may_contain(names[i]) ? 1 : 0;
+        }
+        bench::print_csv_row("bloom_false_positives", suffix, n, "rate", static_cast<double>(passed) / n);
+    }
+
+    if (!ok)
+    {
+        std::print(stderr, "bloom_filtered_map disagrees with flat_map\n");
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,108 @@
+/**
+ * @file bench_buffered_flat_map.cpp
+ * @brief Streaming-insert throughput of `buffered_flat_map` against `std::flat_map` and `std::map`.
+ *
+ * Each variant receives the same stream of name/age upserts with one erase in
+ * sixteen, then is iterated once. Plain `std::flat_map` inserts are quadratic
+ * and only run up to 100'000 operations. All variants must end with equal
+ * contents.
+ *
+ * Usage: `bench_buffered_flat_map [max_size]` (default 10'000'000).
+ */
+
+#include "bench_common.hpp"
+#include "buffered_flat_map.hpp"
+
+#include <cstdlib>
+#include <flat_map>
+#include <map>
+#include <print>
+#include <string>
+#include <vector>
+
+namespace
+{
+    constexpr std::size_t incremental_limit = 100'000;
+
+    using ages_map = std::flat_map<std::string, int>;
+
+    /**
+     * @brief Replays the stream into @p map; every sixteenth operation erases an earlier key.
+     */
+    template <typename Map>
+    void replay(Map &map, const std::vector<std::string> &names)
+    {
+        for (std::size_t i = 0; i < names.size(); ++i)
+        {
+            if (i % 16 == 15)
+            {
+                map.erase(names[i / 2]);
+            }
+            else
+            {
+                map.insert_or_assign(names[i], static_cast<int>(i % 100));
+            }
+        }
+    }
+
+    /**
+     * @brief Times replay plus one full iteration, reports the rate and returns the final contents.
+     */
+    template <typename Map>
+    ages_map run(Map &map, const char *variant, const std::vector<std::string> &names)
+    {
+        long sum = 0;
+        const double ns = bench::time_ns([&] {
+            replay(map, names);
+            for (const auto &[name, age] : map)
+            {
+                sum += age;
+            }
+        });
+        bench::do_not_optimize(sum);
+        bench::print_csv_row("streaming_insert", variant, names.size(), "inserts_per_sec", names.size() * 1e9 / ns);
+
+        ages_map result;
+        for (const auto &[name, age] : map)
+        {
+            result.emplace(name, age);
+        }
+        return result;
+    }
+} // namespace
+
+int main(int argc, char **argv)
+{
+    const std::size_t max_size = bench::max_size_arg(argc, argv, 10'000'000);
+
+    bench::print_csv_header();
+    bool ok = true;
+    for (const std::size_t n : bench::size_ladder(10'000, max_size))
+    {
+        // Half of the stream overwrites keys that were already inserted.
+        auto names = bench::make_names(n / 2);
+        const std::vector<std::string> repeats = names; // Inserting a vector's own range into it is undefined.
+        names.insert(names.end(), repeats.begin(), repeats.end());
+
+        std::map<std::string, int> tree;
+        const ages_map expected = run(tree, "std::map", names);
+
+        learnings::buffered_flat_map<std::string, int> inline_buffered;
+        ok = ok && run(inline_buffered, "buffered_flat_map/inline", names) == expected;
+
+        learnings::buffered_flat_map<std::string, int> background_buffered({}, learnings::merge_mode::background);
+        ok = ok && run(background_buffered, "buffered_flat_map/background", names) == expected;
+
+        if (n <= incremental_limit)
+        {
+            ages_map plain;
+            ok = ok && run(plain, "flat_map", names) == expected;
+        }
+        if (!ok)
+        {
+            std::print(stderr, "buffered_flat_map disagrees with std::map at {} operations\n", n);
+            return EXIT_FAILURE;
+        }
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,232 @@
+/**
+ * @file bench_case_insensitive_search.cpp
+ * @brief Case-insensitive search folded in registers against lower-casing a copy and calling `contains`.
+ *
+ * Three workloads:
+ *  - a million short ASCII log lines tested for a mixed-case needle, where
+ *    the copy costs an allocation per line;
+ *  - a large mixed Latin/Greek/Cyrillic UTF-8 text in which every
+ *    occurrence of a Cyrillic needle is counted, against a folded copy;
+ *  - validating that text and finding a needle near its end, as two passes
+ *    (`validate_utf8`, then `find_icase_utf8`) and as one fused pass.
+ * Every variant must agree with the copy-based search.
+ *
+ * Usage: `bench_case_insensitive_search [lines]` (default 1'000'000).
+ */
+
+#include "bench_common.hpp"
+#include "case_insensitive_search.hpp"
+
+#include <cstdlib>
+#include <print>
+#include <random>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace
+{
+    bool ok = true;
+
+    /**
+     * @brief Times @p run and checks its result against @p expected.
+     */
+    template <typename F>
+    void measure(const char *benchmark, const char *variant, std::size_t size, double units, const char *metric,
+                 std::size_t expected, F run)
+    {
+        std::size_t result = 0;
+        const double ns = bench::time_ns([&] { result = run(); });
+        bench::print_csv_row(benchmark, variant, size, metric, ns / units);
+        bench::do_not_optimize(result);
+        if (result != expected)
+        {
+            std::print(stderr, "{} {}: got {}, expected {}\n", benchmark, variant, result, expected);
+            ok = false;
+        }
+    }
+
+    std::string ascii_lower_copy(std::string_view s)
+    {
+        std::string out(s);
+        for (char &c : out)
+        {
+            c = learnings::detail::ascii_fold(c);
+        }
+        return out;
+    }
+
+    /**
+     * @brief What callers write today: a folded copy of the text, character by character.
+     */
+    std::string utf8_fold_copy(std::string_view s)
+    {
+        std::string out;
+        out.reserve(s.size());
+        for (std::size_t i = 0; i < s.size();)
+        {
+            const auto c = learnings::detail::decode_utf8(s.substr(i));
+            const char32_t folded = learnings::fold_case(c.code_point);
+            if (folded == c.code_point || folded >= 0x800)
+            {
+                out.append(s.substr(i, c.length));
+            }
+            else
+            {
+                char bytes[2];
+                out.append(bytes, learnings::detail::encode_utf8_short(folded, bytes));
+            }
+            i += c.length;
+        }
+        return out;
+    }
+
+    void ascii_lines(std::size_t lines)
+    {
+        const auto names = bench::make_names(lines);
+        std::vector<std::string> log(lines);
+        for (std::size_t i = 0; i < lines; ++i)
+        {
+            log[i] = "request from " + names[i] + " took " + std::to_string(i % 1000) + "ms status " +
+                     (i % 97 == 0 ? "Gateway TIMEOUT" : i % 89 == 0 ? "gateway timeout" : "ok");
+        }
+        constexpr std::string_view needle = "Gateway Timeout";
+        const std::string lower_needle = ascii_lower_copy(needle);
+        std::size_t expected = 0;
+        for (const auto &line : log)
+        {
+            expected += std::string_view(ascii_lower_copy(line)).contains(lower_needle) ? 1 : 0;
+        }
+        const double n = static_cast<double>(lines);
+
+        measure("icase_lines", "lower_copy_then_contains", lines, n, "ns_per_line", expected, [&] {
+            std::size_t count = 0;
+            for (const auto &line : log)
+            {
+                count += ascii_lower_copy(line).contains(ascii_lower_copy(needle)) ? 1 : 0;
+            }
+            return count;
+        });
+        measure("icase_lines", "contains_icase", lines, n, "ns_per_line", expected, [&] {
+            std::size_t count = 0;
+            for (const auto &line : log)
+            {
+                count += learnings::contains_icase(line, needle) ? 1 : 0;
+            }
+            return count;
+        });
+        measure("icase_lines", "contains_icase_utf8", lines, n, "ns_per_line", expected, [&] {
+            std::size_t count = 0;
+            for (const auto &line : log)
+            {
+                count += learnings::contains_icase_utf8(line, needle) ? 1 : 0;
+            }
+            return count;
+        });
+    }
+
+    /**
+     * @brief About @p bytes of words drawn from several scripts, in random case.
+     */
+    std::string make_multilingual_text(std::size_t bytes)
+    {
+        const std::vector<std::string_view> words = {
+            "error",    "Fehler", "erreur",  "café",      "Ĺódź", "σφάλμα", "ΣΦΆΛΜΑ", "ошибка", "ОШИБКА", "сервер",
+            "Сервер",   "запрос", "timeout", "ÉCHEC",     "ёлка", "Ђак",    "žluť",   "ÿ",      "Ÿ",      "λόγος",
+            "ответ",    "Ответ",  "данные",  "журнал",    "лог",  "12:30",  "-",      "→",      "日本",   "—"};
+        std::mt19937_64 rng(83);
+        std::string text;
+        text.reserve(bytes + 64);
+        while (text.size() < bytes)
+        {
+            text += words[rng() % words.size()];
+            text += rng() % 12 == 0 ? '\n' : ' ';
+        }
+        return text;
+    }
+
+    /**
+     * @brief The first character boundary at or after @p at.
+     */
+    std::size_t boundary(std::string_view text, std::size_t at)
+    {
+        while (at < text.size() && (static_cast<unsigned char>(text[at]) & 0xc0) == 0x80)
+        {
+            ++at;
+        }
+        return at;
+    }
+
+    void utf8_text(std::size_t bytes)
+    {
+        std::string text = make_multilingual_text(bytes);
+        const double mb = static_cast<double>(text.size()) / (1 << 20);
+        {
+            constexpr std::string_view needle = "Ошибка Сервера";
+            for (std::size_t at = 0; at + 64 < text.size(); at += text.size() / 7)
+            {
+                text.insert(boundary(text, at), " ОШИБКА сервера ");
+            }
+            const std::string folded_needle = utf8_fold_copy(needle);
+            auto count_with = [](auto find) {
+                std::size_t count = 0;
+                for (std::size_t pos = find(0); pos != std::string_view::npos; pos = find(pos + 1))
+                {
+                    ++count;
+                }
+                return count;
+            };
+            const std::string reference = utf8_fold_copy(text);
+            const std::size_t expected =
+                count_with([&](std::size_t pos) { return std::string_view(reference).find(folded_needle, pos); });
+
+            measure("icase_utf8_count", "fold_copy_then_find", text.size(), mb, "ns_per_mb", expected, [&] {
+                const std::string folded = utf8_fold_copy(text);
+                const std::string folded_query = utf8_fold_copy(needle);
+                return count_with([&](std::size_t pos) { return std::string_view(folded).find(folded_query, pos); });
+            });
+            measure("icase_utf8_count", "find_icase_utf8", text.size(), mb, "ns_per_mb", expected, [&] {
+                return count_with([&](std::size_t pos) { return learnings::find_icase_utf8(text, needle, pos); });
+            });
+        }
+        {
+            // Near the end, so that a search without validation also reads nearly all of the text.
+            constexpr std::string_view needle = "Журнал Ответа";
+            text.insert(boundary(text, text.size() - 32), " журнал ОТВЕТА ");
+            const std::size_t expected = std::string_view(utf8_fold_copy(text)).find(utf8_fold_copy(needle));
+
+            measure("icase_utf8_validated", "fold_copy_then_find", text.size(), mb, "ns_per_mb", expected, [&] {
+                return std::string_view(utf8_fold_copy(text)).find(utf8_fold_copy(needle));
+            });
+            measure("icase_utf8_validated", "validate_then_find", text.size(), mb, "ns_per_mb", expected, [&] {
+                return learnings::validate_utf8(text) ? learnings::find_icase_utf8(text, needle) : 0;
+            });
+            measure("icase_utf8_validated", "fused", text.size(), mb, "ns_per_mb", expected, [&] {
+                return learnings::find_icase_utf8_validated(text, needle).value_or(0);
+            });
+            measure("utf8_validate", "scalar", text.size(), mb, "ns_per_mb", 1,
+                    [&] { return learnings::detail::validate_utf8_scalar(text) ? std::size_t{1} : 0; });
+            measure("utf8_validate",
+                    learnings::active_simd_level() >= learnings::simd_level::ssse3 ? "ssse3" : "dispatch_scalar",
+                    text.size(), mb, "ns_per_mb", 1,
+                    [&] { return learnings::validate_utf8(text) ? std::size_t{1} : 0; });
+
+            text[text.size() / 2] = '\xff'; // Never valid in UTF-8.
+            if (learnings::validate_utf8(text) || learnings::find_icase_utf8_validated(text, needle))
+            {
+                std::print(stderr, "malformed UTF-8 was accepted\n");
+                ok = false;
+            }
+        }
+    }
+} // namespace
+
+int main(int argc, char **argv)
+{
+    const std::size_t lines = bench::max_size_arg(argc, argv, 1'000'000);
+
+    bench::print_csv_header();
+    ascii_lines(lines);
+    utf8_text(std::size_t{64} << 20);
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,130 @@
+/**
+ * @file bench_common.hpp
+ * @brief Shared helpers for the benchmark executables in `bench/`.
+ *
+ * Provides a monotonic timer, an optimisation barrier, the size ladders used
+ * by every benchmark, a deterministic generator of realistic person names and
+ * a CSV row printer so that results from different runs can be diffed.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <print>
+#include <random>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace bench
+{
+    using clock = std::chrono::steady_clock;
+
+    /**
+     * @brief Prevents the compiler from optimising away a computed value.
+     * @param value The value that must be considered "used".
+     */
+    template <typename T>
+    inline void do_not_optimize(const T &value)
+    {
+#if defined(__GNUC__) || defined(__clang__)
+        asm volatile("" : : "r,m"(value) : "memory");
+#else
+        static volatile const T *sink;
+        sink = &value;
+#endif
+    }
+
+    /**
+     * @brief Runs @p fn once and returns the elapsed wall time in nanoseconds.
+     */
+    template <typename F>
+    double time_ns(F &&fn)
+    {
+        const auto start = clock::now();
+        fn();
+        const auto stop = clock::now();
+        return std::chrono::duration<double, std::nano>(stop - start).count();
+    }
+
+    /**
+     * @brief Builds the ladder `min, 10*min, ...` up to and including @p max.
+     */
+    inline std::vector<std::size_t> size_ladder(std::size_t min, std::size_t max)
+    {
+        std::vector<std::size_t> sizes;
+        for (std::size_t n = min; n <= max; n *= 10)
+        {
+            sizes.push_back(n);
+        }
+        return sizes;
+    }
+
+    /**
+     * @brief Reads the largest problem size from `argv[1]`, if given.
+     * @details Lets the big (memory-hungry) sizes be opted into explicitly so
+     *          that a default run finishes in seconds on a laptop.
+     */
+    inline std::size_t max_size_arg(int argc, char **argv, std::size_t fallback)
+    {
+        if (argc > 1)
+        {
+            return static_cast<std::size_t>(std::strtoull(argv[1], nullptr, 10));
+        }
+        return fallback;
+    }
+
+    /**
+     * @brief Generates @p n distinct, realistic person names in random order.
+     * @details Names look like "Alexandra Johnson 4711": many share long
+     *          prefixes and most exceed the small-string-optimisation limit,
+     *          which is what our production tables look like.
+     */
+    inline std::vector<std::string> make_names(std::size_t n, std::uint64_t seed = 42)
+    {
+        static constexpr std::array<std::string_view, 16> first{
+            "Alice", "Alexander", "Alexandra", "Bob", "Benjamin", "Charlie", "Charlotte", "Daniel",
+            "Eleanor", "Frederick", "Grace", "Henry", "Isabella", "Jonathan", "Margaret", "Sebastian"};
+        static constexpr std::array<std::string_view, 16> last{
+            "Anderson", "Brown", "Clarke", "Davies", "Evans", "Fitzgerald", "Garcia", "Harrison",
+            "Johnson", "Kowalski", "MacDonald", "Martinez", "Robertson", "Smith", "Thompson", "Williams"};
+
+        std::vector<std::string> names;
+        names.reserve(n);
+        for (std::size_t i = 0; i < n; ++i)
+        {
+            std::string name;
+            name.reserve(32);
+            name += first[i % first.size()];
+            name += ' ';
+            name += last[(i / first.size()) % last.size()];
+            name += ' ';
+            name += std::to_string(i / (first.size() * last.size()));
+            names.push_back(std::move(name));
+        }
+        std::shuffle(names.begin(), names.end(), std::mt19937_64{seed});
+        return names;
+    }
+
+    /**
+     * @brief Prints the CSV header shared by all benchmarks.
+     */
+    inline void print_csv_header()
+    {
+        std::print("benchmark,variant,size,metric,value\n");
+    }
+
+    /**
+     * @brief Prints one CSV result row.
+     */
+    inline void print_csv_row(std::string_view benchmark, std::string_view variant, std::size_t size,
+                              std::string_view metric, double value)
+    {
+        std::print("{},{},{},{},{:.3f}\n", benchmark, variant, size, metric, value);
+    }
+} // namespace bench
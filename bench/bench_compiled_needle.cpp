@@ -0,0 +1,252 @@
+/**
+ * @file bench_compiled_needle.cpp
+ * @brief Repeated searches with a `compiled_needle` against per-call setup.
+ *
+ * Two workloads:
+ *  - one needle tested against a million short log lines, where a searcher
+ *    rebuilt per call (`std::boyer_moore_horspool_searcher`) pays its setup a
+ *    million times;
+ *  - 80-byte needles in a large buffer of varied text and of DNA-like text,
+ *    where Horspool degrades. The Horspool and two-way paths, which the
+ *    compiled needle only chooses without SIMD, are also timed forced.
+ * All variants must count the same matches. Before timing, every forced
+ * algorithm is checked against `string_view::find` on random needles.
+ *
+ * Usage: `bench_compiled_needle [lines]` (default 1'000'000).
+ */
+
+#include "bench_common.hpp"
+#include "compiled_needle.hpp"
+#include "simd_search.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+#include <functional>
+#include <print>
+#include <random>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace
+{
+    // Constexpr needles are compiled during translation.
+    constexpr learnings::compiled_needle fox("fox");
+    static_assert(fox.algorithm() == learnings::needle_algorithm::simd);
+    static_assert(fox.find("The quick brown fox jumps over the lazy dog.") == 16);
+    static_assert(learnings::compiled_needle("x").algorithm() == learnings::needle_algorithm::single_byte);
+
+    bool ok = true;
+
+    /**
+     * @brief Compares every forced algorithm with `string_view::find` on random needles and haystacks.
+     */
+    void check_forced_algorithms()
+    {
+        std::mt19937_64 rng(61);
+        for (const std::string_view alphabet : {std::string_view("ab"), std::string_view("ACGT"),
+                                                std::string_view("abcdefghijklmnopqrstuvwxyz0123456789")})
+        {
+            for (int round = 0; round < 2'000; ++round)
+            {
+                std::string haystack(rng() % 300, ' ');
+                for (char &c : haystack)
+                {
+                    c = alphabet[rng() % alphabet.size()];
+                }
+                std::string needle(rng() % 100, ' ');
+                for (char &c : needle)
+                {
+                    c = alphabet[rng() % alphabet.size()];
+                }
+                if (!haystack.empty() && rng() % 2 == 0)
+                {
+                    const std::size_t at = rng() % haystack.size();
+                    haystack.replace(at, needle.size(), needle);
+                }
+
+                for (const auto algorithm : {learnings::needle_algorithm::simd, learnings::needle_algorithm::horspool,
+                                             learnings::needle_algorithm::two_way})
+                {
+                    const learnings::compiled_needle compiled(needle, algorithm);
+                    for (std::size_t pos = 0; pos <= haystack.size() + 1; pos += 1 + rng() % 8)
+                    {
+                        const std::size_t expected = std::string_view(haystack).find(needle, pos);
+                        const std::size_t found = compiled.find(haystack, pos);
+                        if (found != expected)
+                        {
+                            std::print(stderr, "{} finds \"{}\" in \"{}\" from {} at {}, expected {}\n",
+                                       learnings::to_string(compiled.algorithm()), needle, haystack, pos, found,
+                                       expected);
+                            ok = false;
+                            return;
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    /**
+     * @brief Times @p count_matches and checks its result against @p expected.
+     */
+    template <typename F>
+    void measure(const char *benchmark, const std::string &variant, std::size_t size, double units,
+                 const char *metric, std::size_t expected, F count_matches)
+    {
+        std::size_t found = 0;
+        const double ns = bench::time_ns([&] { found = count_matches(); });
+        bench::print_csv_row(benchmark, variant, size, metric, ns / units);
+        bench::do_not_optimize(found);
+        if (found != expected)
+        {
+            std::print(stderr, "{} {}: {} matches, expected {}\n", benchmark, variant, found, expected);
+            ok = false;
+        }
+    }
+
+    void many_haystacks(std::size_t lines)
+    {
+        const auto names = bench::make_names(lines);
+        std::vector<std::string> log(lines);
+        for (std::size_t i = 0; i < lines; ++i)
+        {
+            log[i] = "request from " + names[i] + " took " + std::to_string(i % 1000) + "ms status " +
+                     (i % 97 == 0 ? "timeout" : "ok");
+        }
+
+        for (const std::string_view needle : {std::string_view("k"), std::string_view("Smith"),
+                                              std::string_view("ms status timeout")})
+        {
+            std::size_t expected = 0;
+            for (const auto &line : log)
+            {
+                expected += std::string_view(line).contains(needle) ? 1 : 0;
+            }
+            const std::string suffix = "/needle_" + std::to_string(needle.size());
+            const double n = static_cast<double>(lines);
+
+            measure("compiled_needle_lines", "string_view::contains" + suffix, lines, n, "ns_per_line", expected,
+                    [&] {
+                        std::size_t count = 0;
+                        for (const auto &line : log)
+                        {
+                            count += std::string_view(line).contains(needle) ? 1 : 0;
+                        }
+                        return count;
+                    });
+            measure("compiled_needle_lines", "horspool_searcher_per_call" + suffix, lines, n, "ns_per_line",
+                    expected, [&] {
+                        std::size_t count = 0;
+                        for (const auto &line : log)
+                        {
+                            const std::boyer_moore_horspool_searcher searcher(needle.begin(), needle.end());
+                            count += std::search(line.begin(), line.end(), searcher) != line.end() ? 1 : 0;
+                        }
+                        return count;
+                    });
+            measure("compiled_needle_lines", "simd_contains" + suffix, lines, n, "ns_per_line", expected, [&] {
+                std::size_t count = 0;
+                for (const auto &line : log)
+                {
+                    count += learnings::simd_contains(line, needle) ? 1 : 0;
+                }
+                return count;
+            });
+            const learnings::compiled_needle compiled(needle);
+            measure("compiled_needle_lines",
+                    "compiled_needle_" + std::string(learnings::to_string(compiled.algorithm())) + suffix, lines, n,
+                    "ns_per_line", expected, [&] {
+                        std::size_t count = 0;
+                        for (const auto &line : log)
+                        {
+                            count += compiled.contains(line) ? 1 : 0;
+                        }
+                        return count;
+                    });
+        }
+    }
+
+    /**
+     * @brief Counts occurrences of a long needle in a large text, planted a few times.
+     */
+    void long_needle(const char *dataset, std::string text, std::string_view alphabet)
+    {
+        std::mt19937_64 rng(67);
+        std::string needle(80, ' ');
+        for (char &c : needle)
+        {
+            c = alphabet[rng() % alphabet.size()];
+        }
+        for (int i = 0; i < 4; ++i)
+        {
+            const std::size_t at = rng() % (text.size() - needle.size());
+            text.replace(at, needle.size(), needle);
+        }
+        const std::string_view view = text;
+        auto count_with = [&](auto find) {
+            std::size_t count = 0;
+            for (std::size_t pos = find(0); pos != std::string_view::npos; pos = find(pos + 1))
+            {
+                ++count;
+            }
+            return count;
+        };
+        const std::size_t expected = count_with([&](std::size_t pos) { return view.find(needle, pos); });
+        const double mb = static_cast<double>(text.size()) / (1 << 20);
+        const std::string suffix = std::string("/") + dataset;
+
+        measure("compiled_needle_long", "string_view::find" + suffix, text.size(), mb, "ns_per_mb", expected,
+                [&] { return count_with([&](std::size_t pos) { return view.find(needle, pos); }); });
+        measure("compiled_needle_long", "simd_find" + suffix, text.size(), mb, "ns_per_mb", expected,
+                [&] { return count_with([&](std::size_t pos) { return learnings::simd_find(view, needle, pos); }); });
+        const std::boyer_moore_horspool_searcher searcher(needle.begin(), needle.end());
+        measure("compiled_needle_long", "horspool_searcher" + suffix, text.size(), mb, "ns_per_mb", expected, [&] {
+            return count_with([&](std::size_t pos) {
+                const auto hit = std::search(view.begin() + pos, view.end(), searcher);
+                return hit == view.end() ? std::string_view::npos : static_cast<std::size_t>(hit - view.begin());
+            });
+        });
+        const learnings::compiled_needle compiled(needle);
+        measure("compiled_needle_long",
+                "compiled_needle_" + std::string(learnings::to_string(compiled.algorithm())) + suffix, text.size(),
+                mb, "ns_per_mb", expected,
+                [&] { return count_with([&](std::size_t pos) { return compiled.find(view, pos); }); });
+        for (const auto algorithm : {learnings::needle_algorithm::horspool, learnings::needle_algorithm::two_way})
+        {
+            const learnings::compiled_needle forced(needle, algorithm);
+            measure("compiled_needle_long", "forced_" + std::string(learnings::to_string(algorithm)) + suffix,
+                    text.size(), mb, "ns_per_mb", expected,
+                    [&] { return count_with([&](std::size_t pos) { return forced.find(view, pos); }); });
+        }
+    }
+} // namespace
+
+int main(int argc, char **argv)
+{
+    const std::size_t lines = bench::max_size_arg(argc, argv, 1'000'000);
+
+    check_forced_algorithms();
+    bench::print_csv_header();
+    many_haystacks(lines);
+
+    constexpr std::size_t text_bytes = 16 << 20;
+    std::mt19937_64 rng(71);
+    constexpr std::string_view letters = "abcdefghijklmnopqrstuvwxyz ABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789.,";
+    std::string prose(text_bytes, ' ');
+    for (char &c : prose)
+    {
+        c = letters[rng() % letters.size()];
+    }
+    long_needle("varied_alphabet", std::move(prose), letters);
+
+    constexpr std::string_view bases = "ACGT";
+    std::string dna(text_bytes, ' ');
+    for (char &c : dna)
+    {
+        c = bases[rng() % bases.size()];
+    }
+    long_needle("dna", std::move(dna), bases);
+
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,335 @@
+/**
+ * @file bench_containers.cpp
+ * @brief Benchmark matrix of associative containers: `std::flat_map`,
+ *        `std::map`, `std::unordered_map` and a sorted `std::vector`.
+ *
+ * For `int` and `std::string` keys at sizes from 10 up to `max_size` this
+ * measures random and sorted insertion, hit and miss lookups, full iteration,
+ * erasure and heap footprint. Results go to stdout as CSV, or as a JSON array
+ * with `--json`, so that runs from different releases can be diffed.
+ *
+ * Usage: `bench_containers [max_size] [--json]` (default 10'000'000).
+ * Operations that are O(n) per element on contiguous containers (random
+ * insert and erase) are skipped above 100'000 entries.
+ */
+
+#include "alloc_counter.hpp"
+#include "bench_common.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+#include <flat_map>
+#include <map>
+#include <numeric>
+#include <print>
+#include <random>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace
+{
+    constexpr std::size_t quadratic_limit = 100'000;
+    constexpr std::size_t ops_per_sample = 100'000;  ///< Small sizes are repeated up to this many operations.
+    constexpr std::size_t max_probes = 1'000'000;
+
+    struct row
+    {
+        std::string key_type;
+        std::string container;
+        std::string operation;
+        std::size_t size;
+        double value;
+    };
+
+    std::vector<row> rows;
+
+    // ---- Container adapters: a uniform insert/find/erase/iterate surface. ----
+
+    struct flat_map_adapter
+    {
+        static constexpr std::string_view name = "flat_map";
+        static constexpr bool contiguous = true;
+        template <typename K>
+        using type = std::flat_map<K, int>;
+
+        template <typename K>
+        static void insert(type<K> &c, const K &key, int value) { c.try_emplace(key, value); }
+        template <typename K>
+        static const int *find(const type<K> &c, const K &key)
+        {
+            const auto it = c.find(key);
+            return it == c.end() ? nullptr : &it->second;
+        }
+        template <typename K>
+        static void erase(type<K> &c, const K &key) { c.erase(key); }
+    };
+
+    struct map_adapter
+    {
+        static constexpr std::string_view name = "map";
+        static constexpr bool contiguous = false;
+        template <typename K>
+        using type = std::map<K, int>;
+
+        template <typename K>
+        static void insert(type<K> &c, const K &key, int value) { c.try_emplace(key, value); }
+        template <typename K>
+        static const int *find(const type<K> &c, const K &key)
+        {
+            const auto it = c.find(key);
+            return it == c.end() ? nullptr : &it->second;
+        }
+        template <typename K>
+        static void erase(type<K> &c, const K &key) { c.erase(key); }
+    };
+
+    struct unordered_map_adapter
+    {
+        static constexpr std::string_view name = "unordered_map";
+        static constexpr bool contiguous = false;
+        template <typename K>
+        using type = std::unordered_map<K, int>;
+
+        template <typename K>
+        static void insert(type<K> &c, const K &key, int value) { c.try_emplace(key, value); }
+        template <typename K>
+        static const int *find(const type<K> &c, const K &key)
+        {
+            const auto it = c.find(key);
+            return it == c.end() ? nullptr : &it->second;
+        }
+        template <typename K>
+        static void erase(type<K> &c, const K &key) { c.erase(key); }
+    };
+
+    struct sorted_vector_adapter
+    {
+        static constexpr std::string_view name = "sorted_vector";
+        static constexpr bool contiguous = true;
+        template <typename K>
+        using type = std::vector<std::pair<K, int>>;
+
+        template <typename K>
+        static auto position(const type<K> &c, const K &key)
+        {
+            return std::lower_bound(c.begin(), c.end(), key, [](const auto &entry, const K &k) { return entry.first < k; });
+        }
+        template <typename K>
+        static void insert(type<K> &c, const K &key, int value)
+        {
+            const auto it = position(c, key);
+            if (it == c.end() || it->first != key)
+            {
+                c.emplace(it, key, value);
+            }
+        }
+        template <typename K>
+        static const int *find(const type<K> &c, const K &key)
+        {
+            const auto it = position(c, key);
+            return it == c.end() || it->first != key ? nullptr : &it->second;
+        }
+        template <typename K>
+        static void erase(type<K> &c, const K &key)
+        {
+            const auto it = position(c, key);
+            if (it != c.end() && it->first == key)
+            {
+                c.erase(it);
+            }
+        }
+    };
+
+    // ---- Key generation. ----
+
+    /**
+     * @brief Distinct keys in random order plus an equal number of absent keys.
+     */
+    template <typename K>
+    std::pair<std::vector<K>, std::vector<K>> make_keys(std::size_t n)
+    {
+        std::vector<K> hits;
+        std::vector<K> misses;
+        if constexpr (std::is_same_v<K, int>)
+        {
+            hits.resize(n);
+            std::iota(hits.begin(), hits.end(), 0);
+            for (int &k : hits)
+            {
+                k *= 2; // Odd numbers are never inserted.
+            }
+            std::shuffle(hits.begin(), hits.end(), std::mt19937_64{n});
+            misses = hits;
+            for (int &k : misses)
+            {
+                k += 1;
+            }
+        }
+        else
+        {
+            hits = bench::make_names(n, n);
+            misses = hits;
+            for (auto &k : misses)
+            {
+                k += '#';
+            }
+        }
+        return {std::move(hits), std::move(misses)};
+    }
+
+    void record(std::string_view key_type, std::string_view container, std::string_view operation,
+                std::size_t size, double value)
+    {
+        rows.push_back({std::string(key_type), std::string(container), std::string(operation), size, value});
+    }
+
+    /**
+     * @brief Runs every operation for one container/key-type/size cell.
+     */
+    template <typename Adapter, typename K>
+    void run_cell(std::string_view key_type, std::size_t n, const std::vector<K> &hits, const std::vector<K> &misses)
+    {
+        using container = typename Adapter::template type<K>;
+        const std::size_t reps = std::max<std::size_t>(1, ops_per_sample / n);
+
+        std::vector<K> sorted = hits;
+        std::sort(sorted.begin(), sorted.end());
+
+        auto time_build = [&](const std::vector<K> &keys) {
+            double ns = 0;
+            for (std::size_t r = 0; r < reps; ++r)
+            {
+                container c;
+                ns += bench::time_ns([&] {
+                    for (std::size_t i = 0; i < keys.size(); ++i)
+                    {
+                        Adapter::insert(c, keys[i], static_cast<int>(i));
+                    }
+                });
+                bench::do_not_optimize(c);
+            }
+            return ns / static_cast<double>(reps * keys.size());
+        };
+
+        if (!Adapter::contiguous || n <= quadratic_limit)
+        {
+            record(key_type, Adapter::name, "insert_random", n, time_build(hits));
+        }
+        record(key_type, Adapter::name, "insert_sorted", n, time_build(sorted));
+
+        const std::size_t live_before = bench::alloc_stats::live_bytes.load();
+        container c;
+        for (std::size_t i = 0; i < sorted.size(); ++i)
+        {
+            Adapter::insert(c, sorted[i], static_cast<int>(i));
+        }
+        const std::size_t footprint = bench::alloc_stats::live_bytes.load() - live_before;
+        record(key_type, Adapter::name, "bytes_per_entry", n, static_cast<double>(footprint) / n);
+
+        auto time_lookups = [&](const std::vector<K> &keys) {
+            const std::size_t probes = std::min(keys.size(), max_probes);
+            const std::size_t lookup_reps = std::max<std::size_t>(1, ops_per_sample / probes);
+            long found = 0;
+            const double ns = bench::time_ns([&] {
+                for (std::size_t r = 0; r < lookup_reps; ++r)
+                {
+                    for (std::size_t i = 0; i < probes; ++i)
+                    {
+                        found += Adapter::find(c, keys[i]) != nullptr;
+                    }
+                }
+            });
+            bench::do_not_optimize(found);
+            return ns / static_cast<double>(lookup_reps * probes);
+        };
+        record(key_type, Adapter::name, "lookup_hit", n, time_lookups(hits));
+        record(key_type, Adapter::name, "lookup_miss", n, time_lookups(misses));
+
+        long sum = 0;
+        const double iterate_ns = bench::time_ns([&] {
+            for (std::size_t r = 0; r < reps; ++r)
+            {
+                for (const auto &[key, value] : c)
+                {
+                    sum += value;
+                }
+            }
+        });
+        bench::do_not_optimize(sum);
+        record(key_type, Adapter::name, "iterate", n, iterate_ns / static_cast<double>(reps * n));
+
+        if (!Adapter::contiguous || n <= quadratic_limit)
+        {
+            const double erase_ns = bench::time_ns([&] {
+                for (const K &key : hits)
+                {
+                    Adapter::erase(c, key);
+                }
+            });
+            record(key_type, Adapter::name, "erase_random", n, erase_ns / static_cast<double>(n));
+        }
+    }
+
+    template <typename K>
+    void run_key_type(std::string_view key_type, std::size_t max_size)
+    {
+        for (std::size_t n : bench::size_ladder(10, max_size))
+        {
+            const auto [hits, misses] = make_keys<K>(n);
+            run_cell<flat_map_adapter>(key_type, n, hits, misses);
+            run_cell<map_adapter>(key_type, n, hits, misses);
+            run_cell<unordered_map_adapter>(key_type, n, hits, misses);
+            run_cell<sorted_vector_adapter>(key_type, n, hits, misses);
+        }
+    }
+
+    void print_csv()
+    {
+        std::print("key_type,container,operation,size,value\n");
+        for (const auto &r : rows)
+        {
+            std::print("{},{},{},{},{:.3f}\n", r.key_type, r.container, r.operation, r.size, r.value);
+        }
+    }
+
+    void print_json()
+    {
+        std::print("[\n");
+        for (std::size_t i = 0; i < rows.size(); ++i)
+        {
+            const auto &r = rows[i];
+            std::print("  {{\"key_type\": \"{}\", \"container\": \"{}\", \"operation\": \"{}\", \"size\": {}, "
+                       "\"value\": {:.3f}}}{}\n",
+                       r.key_type, r.container, r.operation, r.size, r.value, i + 1 < rows.size() ? "," : "");
+        }
+        std::print("]\n");
+    }
+} // namespace
+
+int main(int argc, char **argv)
+{
+    std::size_t max_size = 10'000'000;
+    bool json = false;
+    for (int i = 1; i < argc; ++i)
+    {
+        const std::string_view arg = argv[i];
+        if (arg == "--json")
+        {
+            json = true;
+        }
+        else
+        {
+            max_size = static_cast<std::size_t>(std::strtoull(argv[i], nullptr, 10));
+        }
+    }
+
+    run_key_type<int>("int", max_size);
+    run_key_type<std::string>("string", max_size);
+
+    // Every value is ns per operation except bytes_per_entry.
+    json ? print_json() : print_csv();
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,260 @@
+/**
+ * @file bench_deduced_mixins.cpp
+ * @brief A heterogeneous loop dispatched through virtual calls, `std::variant` and `type_batches`.
+ *
+ * Four shape types share a `shape_algorithms` mixin whose `roundness()` is
+ * written once over the derived `area()` and `perimeter()`. The loop sums
+ * `roundness()` over shapes of random types:
+ *  - `virtual`: a base class with virtual `area` / `perimeter`, elements in
+ *    random order, and again sorted by type (predictable branches, same calls);
+ *  - `variant`: `std::vector<std::variant<...>>` with `std::visit`, so the
+ *    mixin is instantiated per alternative and inlined;
+ *  - `batches`: `type_batches`, one tight loop per type.
+ * All variants must produce the same sum.
+ *
+ * Usage: `bench_deduced_mixins [max_shapes]` (default 1'000'000).
+ */
+
+#include "bench_common.hpp"
+#include "deduced_mixins.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <memory>
+#include <numbers>
+#include <print>
+#include <random>
+#include <typeindex>
+#include <typeinfo>
+#include <variant>
+#include <vector>
+
+namespace
+{
+    /**
+     * @brief Shape algorithms written once against the derived type's primitives.
+     */
+    struct shape_algorithms
+    {
+        /// 4πA/P²: 1 for a circle, less for anything else.
+        constexpr double roundness(this const auto &self)
+        {
+            const double perimeter = self.perimeter();
+            return 4 * std::numbers::pi * self.area() / (perimeter * perimeter);
+        }
+
+        /// Shapes order by area.
+        constexpr double key(this const auto &self) { return self.area(); }
+    };
+
+    struct circle : shape_algorithms, learnings::clonable, learnings::ordered_by_key
+    {
+        double radius;
+
+        constexpr explicit circle(double r) : radius(r) {}
+
+        constexpr double area() const { return std::numbers::pi * radius * radius; }
+        constexpr double perimeter() const { return 2 * std::numbers::pi * radius; }
+    };
+
+    struct rectangle : shape_algorithms, learnings::clonable, learnings::ordered_by_key
+    {
+        double width;
+        double height;
+
+        constexpr rectangle(double w, double h) : width(w), height(h) {}
+
+        constexpr double area() const { return width * height; }
+        constexpr double perimeter() const { return 2 * (width + height); }
+    };
+
+    struct triangle : shape_algorithms, learnings::clonable, learnings::ordered_by_key
+    {
+        double base;
+        double height; ///< Isosceles: the apex is above the middle of the base.
+
+        triangle(double b, double h) : base(b), height(h) {}
+
+        double area() const { return base * height / 2; }
+        double perimeter() const { return base + 2 * std::hypot(base / 2, height); }
+    };
+
+    struct regular_hexagon : shape_algorithms, learnings::clonable, learnings::ordered_by_key
+    {
+        double side;
+
+        explicit regular_hexagon(double s) : side(s) {}
+
+        double area() const { return 1.5 * std::sqrt(3.0) * side * side; }
+        constexpr double perimeter() const { return 6 * side; }
+    };
+
+    static_assert(circle(1).roundness() == 1.0);
+    static_assert(rectangle(1, 1) < rectangle(2, 1));
+    static_assert(std::same_as<decltype(circle(1).clone()), circle>);
+
+    /**
+     * @brief The virtual-dispatch baseline: the same algorithm over virtual primitives.
+     */
+    class virtual_shape
+    {
+    public:
+        virtual ~virtual_shape() = default;
+
+        virtual double area() const = 0;
+        virtual double perimeter() const = 0;
+
+        double roundness() const
+        {
+            const double p = perimeter();
+            return 4 * std::numbers::pi * area() / (p * p);
+        }
+    };
+
+    template <typename Shape>
+    class virtual_adapter final : public virtual_shape
+    {
+        Shape shape_;
+
+    public:
+        explicit virtual_adapter(const Shape &shape) : shape_(shape) {}
+
+        double area() const override { return shape_.area(); }
+        double perimeter() const override { return shape_.perimeter(); }
+    };
+
+    using any_shape = std::variant<circle, rectangle, triangle, regular_hexagon>;
+
+    std::vector<any_shape> make_shapes(std::size_t n)
+    {
+        std::mt19937_64 rng(53);
+        std::uniform_real_distribution<double> length(0.5, 4.0);
+        std::vector<any_shape> shapes;
+        shapes.reserve(n);
+        for (std::size_t i = 0; i < n; ++i)
+        {
+            switch (rng() % 4)
+            {
+            case 0:
+                shapes.emplace_back(circle(length(rng)));
+                break;
+            case 1:
+                shapes.emplace_back(rectangle(length(rng), length(rng)));
+                break;
+            case 2:
+                shapes.emplace_back(triangle(length(rng), length(rng)));
+                break;
+            default:
+                shapes.emplace_back(regular_hexagon(length(rng)));
+                break;
+            }
+        }
+        return shapes;
+    }
+
+    /**
+     * @brief Runs @p sum enough times to cover about ten million shapes; returns ns per shape.
+     */
+    template <typename F>
+    double ns_per_shape(std::size_t n, double &total, F &&sum)
+    {
+        const std::size_t repeats = std::max<std::size_t>(1, 10'000'000 / n);
+        double last = 0;
+        const double ns = bench::time_ns([&] {
+            for (std::size_t r = 0; r < repeats; ++r)
+            {
+                last = sum();
+                bench::do_not_optimize(last);
+            }
+        });
+        total = last;
+        return ns / static_cast<double>(repeats * n);
+    }
+} // namespace
+
+int main(int argc, char **argv)
+{
+    const std::size_t max_shapes = bench::max_size_arg(argc, argv, 1'000'000);
+
+    bench::print_csv_header();
+    bool ok = true;
+    for (const std::size_t n : bench::size_ladder(1'000, max_shapes))
+    {
+        const std::vector<any_shape> shapes = make_shapes(n);
+
+        std::vector<std::unique_ptr<virtual_shape>> pointers;
+        learnings::type_batches<circle, rectangle, triangle, regular_hexagon> batches;
+        for (const auto &shape : shapes)
+        {
+            std::visit(
+                [&](const auto &s) {
+                    pointers.push_back(std::make_unique<virtual_adapter<std::remove_cvref_t<decltype(s)>>>(s));
+                    batches.push_back(s.clone());
+                },
+                shape);
+        }
+        std::vector<const virtual_shape *> sorted;
+        for (const auto &p : pointers)
+        {
+            sorted.push_back(p.get());
+        }
+        std::ranges::stable_sort(sorted, {}, [](const virtual_shape *p) { return std::type_index(typeid(*p)); });
+
+        double expected = 0;
+        double total = 0;
+        const auto report = [&](const char *variant, double ns) {
+            bench::print_csv_row("deduced_mixins", variant, n, "ns_per_shape", ns);
+            if (std::abs(total - expected) > 1e-9 * expected)
+            {
+                std::print(stderr, "{} summed {} shapes to {}, expected {}\n", variant, n, total, expected);
+                ok = false;
+            }
+        };
+
+        double ns = ns_per_shape(n, expected, [&] {
+            double sum = 0;
+            for (const auto &p : pointers)
+            {
+                sum += p->roundness();
+            }
+            return sum;
+        });
+        total = expected;
+        report("virtual", ns);
+
+        ns = ns_per_shape(n, total, [&] {
+            double sum = 0;
+            for (const virtual_shape *p : sorted)
+            {
+                sum += p->roundness();
+            }
+            return sum;
+        });
+        report("virtual/sorted", ns);
+
+        ns = ns_per_shape(n, total, [&] {
+            double sum = 0;
+            for (const auto &shape : shapes)
+            {
+                sum += std::visit([](const auto &s) { return s.roundness(); }, shape);
+            }
+            return sum;
+        });
+        report("variant", ns);
+
+        ns = ns_per_shape(n, total, [&] {
+            double sum = 0;
+            batches.for_each([&](const auto &s) { sum += s.roundness(); });
+            return sum;
+        });
+        report("batches", ns);
+
+        if (batches.size() != n)
+        {
+            std::print(stderr, "type_batches holds {} shapes, expected {}\n", batches.size(), n);
+            ok = false;
+        }
+    }
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,136 @@
+/**
+ * @file bench_flat_map_aggregate.cpp
+ * @brief Column aggregations over `ages.values()` against a structured-binding loop over the map.
+ *
+ * Each aggregation runs three ways: a `for (const auto &[name, age] : ages)`
+ * loop, the SIMD kernel on one thread, and the SIMD kernel on every hardware
+ * thread. Results must agree. Set `LEARNINGS_SIMD` to compare kernel tiers.
+ *
+ * Usage: `bench_flat_map_aggregate [max_size]` (default 10'000'000).
+ */
+
+#include "bench_common.hpp"
+#include "flat_map_aggregate.hpp"
+#include "flat_map_bulk.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <flat_map>
+#include <print>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace
+{
+    constexpr int repetitions = 10;
+
+    /**
+     * @brief Times @p fn over several repetitions and reports ns per value; returns its last result.
+     */
+    template <typename F>
+    auto measure(const char *benchmark, const char *variant, std::size_t n, F fn)
+    {
+        decltype(fn()) result{};
+        const double ns = bench::time_ns([&] {
+            for (int r = 0; r < repetitions; ++r)
+            {
+                result = fn();
+                bench::do_not_optimize(result);
+            }
+        });
+        bench::print_csv_row(benchmark, variant, n, "ns_per_value", ns / (static_cast<double>(n) * repetitions));
+        return result;
+    }
+} // namespace
+
+int main(int argc, char **argv)
+{
+    const std::size_t max_size = bench::max_size_arg(argc, argv, 10'000'000);
+    const unsigned threads = std::max(1u, std::thread::hardware_concurrency());
+
+    std::print(stderr, "simd level: {}, threads: {}\n", learnings::to_string(learnings::active_simd_level()), threads);
+    bench::print_csv_header();
+    bool ok = true;
+    for (const std::size_t n : bench::size_ladder(10'000, max_size))
+    {
+        const auto names = bench::make_names(n);
+        learnings::flat_map_bulk_loader<std::string, int> loader;
+        loader.reserve(n);
+        for (std::size_t i = 0; i < n; ++i)
+        {
+            loader.add(names[i], static_cast<int>((i * 2654435761u) % 100));
+        }
+        const auto ages = std::move(loader).build();
+        const auto &column = ages.values();
+
+        // Sum.
+        const auto loop_sum = measure("sum", "range_for", n, [&] {
+            std::int64_t sum = 0;
+            for (const auto &[name, age] : ages)
+            {
+                sum += age;
+            }
+            return sum;
+        });
+        ok &= measure("sum", "simd", n, [&] { return learnings::sum_values(column); }) == loop_sum;
+        ok &= measure("sum", "simd_mt", n, [&] { return learnings::sum_values(column, threads); }) == loop_sum;
+
+        // Min/max.
+        const auto loop_range = measure("min_max", "range_for", n, [&] {
+            std::pair<int, int> range{ages.begin()->second, ages.begin()->second};
+            for (const auto &[name, age] : ages)
+            {
+                range.first = std::min(range.first, age);
+                range.second = std::max(range.second, age);
+            }
+            return range;
+        });
+        auto as_pair = [](const auto &range) { return std::pair<int, int>{range->min, range->max}; };
+        ok &= measure("min_max", "simd", n, [&] { return as_pair(learnings::min_max_values(column)); }) == loop_range;
+        ok &= measure("min_max", "simd_mt", n,
+                      [&] { return as_pair(learnings::min_max_values(column, threads)); }) == loop_range;
+
+        // Count in range: "which people are between 25 and 35".
+        const auto loop_count = measure("count_between", "range_for", n, [&] {
+            std::size_t count = 0;
+            for (const auto &[name, age] : ages)
+            {
+                if (age >= 25 && age <= 35)
+                {
+                    ++count;
+                }
+            }
+            return count;
+        });
+        ok &= measure("count_between", "simd", n,
+                      [&] { return learnings::count_values_between(column, 25, 35); }) == loop_count;
+        ok &= measure("count_between", "simd_mt", n,
+                      [&] { return learnings::count_values_between(column, 25, 35, threads); }) == loop_count;
+        ok &= measure("count_if", "branch_free", n, [&] {
+                  return learnings::count_values_if(column, [](int age) { return age >= 25 && age <= 35; });
+              }) == loop_count;
+
+        // Histogram by decade.
+        const auto loop_histogram = measure("histogram", "range_for", n, [&] {
+            std::vector<std::size_t> counts(10, 0);
+            for (const auto &[name, age] : ages)
+            {
+                ++counts[static_cast<std::size_t>(age / 10)];
+            }
+            return counts;
+        });
+        ok &= measure("histogram", "sub_histograms", n,
+                      [&] { return learnings::histogram_values(column, 0, 100, 10); }) == loop_histogram;
+        ok &= measure("histogram", "sub_histograms_mt", n,
+                      [&] { return learnings::histogram_values(column, 0, 100, 10, threads); }) == loop_histogram;
+
+        if (!ok)
+        {
+            std::print(stderr, "aggregation disagrees with the range-for loop at {} entries\n", n);
+            return EXIT_FAILURE;
+        }
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,80 @@
+/**
+ * @file bench_flat_map_bulk.cpp
+ * @brief Benchmarks bulk loading of `std::flat_map<std::string, int>` against
+ *        repeated `operator[]` inserts.
+ *
+ * Usage: `bench_flat_map_bulk [max_size]` (default 10'000'000). The quadratic
+ * `operator[]` variant is only run up to 100'000 entries.
+ */
+
+#include "bench_common.hpp"
+#include "flat_map_bulk.hpp"
+
+#include <cstdlib>
+#include <flat_map>
+#include <print>
+#include <string>
+#include <vector>
+
+namespace
+{
+    constexpr std::size_t incremental_limit = 100'000;
+
+    std::flat_map<std::string, int> load_incremental(const std::vector<std::string> &names)
+    {
+        std::flat_map<std::string, int> ages;
+        for (std::size_t i = 0; i < names.size(); ++i)
+        {
+            ages[names[i]] = static_cast<int>(i % 100);
+        }
+        return ages;
+    }
+
+    std::flat_map<std::string, int> load_bulk(const std::vector<std::string> &names)
+    {
+        learnings::flat_map_bulk_loader<std::string, int> loader;
+        loader.reserve(names.size());
+        for (std::size_t i = 0; i < names.size(); ++i)
+        {
+            loader.add(names[i], static_cast<int>(i % 100));
+        }
+        return std::move(loader).build();
+    }
+} // namespace
+
+int main(int argc, char **argv)
+{
+    const std::size_t max_size = bench::max_size_arg(argc, argv, 10'000'000);
+
+    // Sanity check: both strategies must produce the same map, duplicates included.
+    {
+        auto names = bench::make_names(5'000);
+        const std::vector<std::string> duplicates(names.begin(), names.begin() + 1'000);
+        names.insert(names.end(), duplicates.begin(), duplicates.end());
+        if (load_incremental(names) != load_bulk(names))
+        {
+            std::print(stderr, "bulk loader disagrees with operator[]\n");
+            return EXIT_FAILURE;
+        }
+    }
+
+    bench::print_csv_header();
+    for (std::size_t n : bench::size_ladder(1'000, max_size))
+    {
+        const auto names = bench::make_names(n);
+
+        std::flat_map<std::string, int> bulk;
+        const double bulk_ns = bench::time_ns([&] { bulk = load_bulk(names); });
+        bench::do_not_optimize(bulk.size());
+        bench::print_csv_row("flat_map_load", "bulk_loader", n, "ms", bulk_ns / 1e6);
+
+        if (n <= incremental_limit)
+        {
+            std::flat_map<std::string, int> incremental;
+            const double incremental_ns = bench::time_ns([&] { incremental = load_incremental(names); });
+            bench::do_not_optimize(incremental.size());
+            bench::print_csv_row("flat_map_load", "operator[]", n, "ms", incremental_ns / 1e6);
+        }
+    }
+    return EXIT_SUCCESS;
+}
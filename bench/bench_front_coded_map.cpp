@@ -0,0 +1,161 @@
+/**
+ * @file bench_front_coded_map.cpp
+ * @brief Memory and lookup cost of `front_coded_map` against `std::flat_map<std::string, int>`.
+ *
+ * Keys are generated hostnames and file paths, which share long prefixes
+ * once sorted. The restart interval is swept to show the trade-off between
+ * compression and decode length. Every variant must find the same values and
+ * iterate in the same order as the uncompressed map.
+ *
+ * Usage: `bench_front_coded_map [size]` (default 1'000'000).
+ */
+
+#include "bench_common.hpp"
+#include "flat_map_bulk.hpp"
+#include "front_coded_map.hpp"
+
+#include <cstdlib>
+#include <flat_map>
+#include <print>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace
+{
+    using key_map = std::flat_map<std::string, int>;
+
+    /**
+     * @brief Generates hostnames such as `api-0042.eu-west-1.compute.example.com`.
+     */
+    std::vector<std::string> make_hostnames(std::size_t n)
+    {
+        constexpr std::string_view services[] = {"api", "auth", "cache", "db", "edge", "queue", "search", "web"};
+        constexpr std::string_view regions[] = {"eu-west-1", "eu-central-1", "us-east-1", "us-west-2", "ap-south-1"};
+        std::mt19937_64 rng(23);
+        std::vector<std::string> hosts(n);
+        for (std::size_t i = 0; i < n; ++i)
+        {
+            hosts[i] = std::string(services[rng() % std::size(services)]) + '-' + std::to_string(i) + '.' +
+                       std::string(regions[rng() % std::size(regions)]) + ".compute.example.com";
+        }
+        return hosts;
+    }
+
+    /**
+     * @brief Generates paths such as `/srv/data/users/Alice/Smith/reports/2024/file_17.csv`.
+     */
+    std::vector<std::string> make_paths(std::size_t n)
+    {
+        constexpr std::string_view folders[] = {"documents", "photos", "reports", "backups"};
+        const auto names = bench::make_names(n);
+        std::mt19937_64 rng(29);
+        std::vector<std::string> paths(n);
+        for (std::size_t i = 0; i < n; ++i)
+        {
+            std::string name = names[i];
+            std::ranges::replace(name, ' ', '/');
+            paths[i] = "/srv/data/users/" + name + '/' + std::string(folders[rng() % std::size(folders)]) + '/' +
+                       std::to_string(2015 + rng() % 10) + "/file_" + std::to_string(i) + ".csv";
+        }
+        return paths;
+    }
+
+    /**
+     * @brief Heap and inline bytes of a `std::flat_map<std::string, int>`.
+     */
+    std::size_t flat_map_bytes(const key_map &map)
+    {
+        std::size_t bytes = map.keys().capacity() * sizeof(std::string) + map.values().capacity() * sizeof(int);
+        for (const auto &key : map.keys())
+        {
+            if (key.capacity() > std::string().capacity())
+            {
+                bytes += key.capacity() + 1; // Heap block past the small-string buffer.
+            }
+        }
+        return bytes;
+    }
+
+    bool run(const char *dataset, const std::vector<std::string> &keys)
+    {
+        learnings::flat_map_bulk_loader<std::string, int> loader;
+        for (std::size_t i = 0; i < keys.size(); ++i)
+        {
+            loader.add(keys[i], static_cast<int>(i % 100));
+        }
+        const key_map map = std::move(loader).build();
+        const std::size_t n = map.size();
+
+        // Half hits, half misses that differ from a real key in the last byte.
+        constexpr std::size_t lookups = 1'000'000;
+        std::mt19937_64 rng(31);
+        std::vector<std::string> probes(lookups);
+        for (std::size_t i = 0; i < lookups; ++i)
+        {
+            probes[i] = keys[rng() % keys.size()];
+            if (i % 2 == 1)
+            {
+                probes[i].back() = '~';
+            }
+        }
+
+        long sum = 0;
+        double ns = bench::time_ns([&] {
+            for (const auto &probe : probes)
+            {
+                const auto it = map.find(probe);
+                sum += it == map.end() ? 0 : it->second;
+            }
+        });
+        const std::string base = std::string("flat_map/") + dataset;
+        bench::print_csv_row("front_coded_lookup", base, n, "ns_per_lookup", ns / lookups);
+        bench::print_csv_row("front_coded_memory", base, n, "bytes_per_key",
+                             static_cast<double>(flat_map_bytes(map)) / n);
+
+        for (const std::size_t interval : {4, 16, 64})
+        {
+            const learnings::front_coded_map<int> coded(map, interval);
+            auto it = coded.begin();
+            for (const auto &[key, value] : map)
+            {
+                if (it == coded.end() || (*it).first != key || (*it).second != value)
+                {
+                    std::print(stderr, "front_coded_map iterates differently at {}\n", key);
+                    return false;
+                }
+                ++it;
+            }
+
+            long coded_sum = 0;
+            ns = bench::time_ns([&] {
+                for (const auto &probe : probes)
+                {
+                    const int *value = coded.find(probe);
+                    coded_sum += value == nullptr ? 0 : *value;
+                }
+            });
+            if (coded_sum != sum)
+            {
+                std::print(stderr, "front_coded_map lookups disagree with flat_map\n");
+                return false;
+            }
+            const std::string variant =
+                "front_coded_map<" + std::to_string(interval) + ">/" + dataset;
+            bench::print_csv_row("front_coded_lookup", variant, n, "ns_per_lookup", ns / lookups);
+            bench::print_csv_row("front_coded_memory", variant, n, "bytes_per_key",
+                                 static_cast<double>(coded.memory_bytes()) / n);
+        }
+        bench::do_not_optimize(sum);
+        return true;
+    }
+} // namespace
+
+int main(int argc, char **argv)
+{
+    const std::size_t n = bench::max_size_arg(argc, argv, 1'000'000);
+
+    bench::print_csv_header();
+    const bool ok = run("hostnames", make_hostnames(n)) && run("paths", make_paths(n));
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,142 @@
+/**
+ * @file bench_heterogeneous_lookup.cpp
+ * @brief Cost of probing string-keyed maps with `std::string_view`s parsed from a text buffer.
+ *
+ * A request log is generated as one text buffer and split into
+ * `std::string_view` fields, the way a parser hands keys to the map. Each
+ * variant looks every field up; the non-transparent baselines must build a
+ * `std::string` per probe. Allocations are counted, and the run fails if a
+ * heterogeneous variant allocates or disagrees with the baseline.
+ *
+ * Usage: `bench_heterogeneous_lookup [size]` (default 1'000'000).
+ */
+
+#include "alloc_counter.hpp"
+#include "bench_common.hpp"
+#include "flat_map_bulk.hpp"
+#include "heterogeneous_lookup.hpp"
+#include "prefix_flat_map.hpp"
+
+#include <cstdlib>
+#include <flat_map>
+#include <functional>
+#include <print>
+#include <random>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace
+{
+    /**
+     * @brief Splits @p text into its newline-terminated lines without copying.
+     */
+    std::vector<std::string_view> split_lines(std::string_view text)
+    {
+        std::vector<std::string_view> lines;
+        while (!text.empty())
+        {
+            const std::size_t end = text.find('\n');
+            lines.push_back(text.substr(0, end));
+            text.remove_prefix(end == std::string_view::npos ? text.size() : end + 1);
+        }
+        return lines;
+    }
+
+    /**
+     * @brief Times one lookup variant over @p probes, reporting latency and allocations.
+     * @return The sum of the values found, so that variants can be checked against each other.
+     */
+    template <typename Lookup>
+    long run(const char *variant, std::size_t n, const std::vector<std::string_view> &probes, Lookup lookup,
+             std::size_t &allocations)
+    {
+        long sum = 0;
+        const std::size_t before = bench::alloc_stats::allocations.load();
+        const double ns = bench::time_ns([&] {
+            for (const auto probe : probes)
+            {
+                sum += lookup(probe);
+            }
+        });
+        allocations = bench::alloc_stats::allocations.load() - before;
+        bench::do_not_optimize(sum);
+        bench::print_csv_row("string_view_lookup", variant, n, "ns_per_lookup", ns / probes.size());
+        bench::print_csv_row("string_view_lookup", variant, n, "allocs_per_lookup",
+                             static_cast<double>(allocations) / probes.size());
+        return sum;
+    }
+} // namespace
+
+int main(int argc, char **argv)
+{
+    const std::size_t max_n = bench::max_size_arg(argc, argv, 1'000'000);
+    constexpr std::size_t lookups = 1'000'000;
+
+    bench::print_csv_header();
+    bool ok = true;
+    for (const std::size_t n : bench::size_ladder(1'000, max_n))
+    {
+        const auto names = bench::make_names(n);
+        learnings::flat_map_bulk_loader<std::string, int> loader;
+        for (std::size_t i = 0; i < n; ++i)
+        {
+            loader.add(names[i], static_cast<int>(i % 100));
+        }
+        const std::flat_map<std::string, int> plain = std::move(loader).build();
+        const std::flat_map<std::string, int, std::less<>> transparent(std::sorted_unique, plain.keys(),
+                                                                       plain.values());
+        const std::unordered_map<std::string, int> hashed(plain.begin(), plain.end());
+        const std::unordered_map<std::string, int, learnings::string_hash, std::equal_to<>> hashed_transparent(
+            plain.begin(), plain.end());
+        const learnings::prefix_flat_map<int> prefixed(plain);
+
+        // Half hits, half misses, one key per line of the buffer.
+        std::mt19937_64 rng(11);
+        std::uniform_int_distribution<std::size_t> pick(0, n - 1);
+        std::string text;
+        for (std::size_t i = 0; i < lookups; ++i)
+        {
+            text += names[pick(rng)];
+            text += i % 2 == 0 ? "\n" : "?\n";
+        }
+        const auto probes = split_lines(text);
+
+        std::size_t allocations = 0;
+        const long expected = run("flat_map<string>::find(string)", n, probes, [&](std::string_view key) {
+            const auto it = plain.find(std::string(key));
+            return it == plain.end() ? 0 : it->second;
+        }, allocations);
+
+        auto check = [&](const char *variant, auto lookup) {
+            const long sum = run(variant, n, probes, lookup, allocations);
+            if (sum != expected || allocations != 0)
+            {
+                std::print(stderr, "{}: sum {} (expected {}), {} allocations\n", variant, sum, expected, allocations);
+                ok = false;
+            }
+        };
+        check("learnings::find(flat_map<string>)", [&](std::string_view key) {
+            const auto it = learnings::find(plain, key);
+            return it == plain.end() ? 0 : it->second;
+        });
+        check("flat_map<string;less<>>::find(string_view)", [&](std::string_view key) {
+            const auto it = transparent.find(key);
+            return it == transparent.end() ? 0 : it->second;
+        });
+        check("prefix_flat_map::find(string_view)", [&](std::string_view key) {
+            const auto it = prefixed.find(key);
+            return it == prefixed.end() ? 0 : it->second;
+        });
+        run("unordered_map<string>::find(string)", n, probes, [&](std::string_view key) {
+            const auto it = hashed.find(std::string(key));
+            return it == hashed.end() ? 0 : it->second;
+        }, allocations);
+        check("unordered_map<string;string_hash>::find(string_view)", [&](std::string_view key) {
+            const auto it = hashed_transparent.find(key);
+            return it == hashed_transparent.end() ? 0 : it->second;
+        });
+    }
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
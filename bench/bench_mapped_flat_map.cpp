@@ -0,0 +1,77 @@
+/**
+ * @file bench_mapped_flat_map.cpp
+ * @brief Startup and first-lookup latency of `mapped_flat_map` against
+ *        rebuilding a `std::flat_map<std::string, int>` from scratch.
+ *
+ * Usage: `bench_mapped_flat_map [max_size]` (default 10'000'000). The file is
+ * written to the system temporary directory and is warm in the page cache;
+ * drop caches between runs to measure a cold start.
+ */
+
+#include "bench_common.hpp"
+#include "flat_map_bulk.hpp"
+#include "mapped_flat_map.hpp"
+
+#include <cstdlib>
+#include <filesystem>
+#include <flat_map>
+#include <print>
+#include <string>
+#include <vector>
+
+int main(int argc, char **argv)
+{
+    const std::size_t max_size = bench::max_size_arg(argc, argv, 10'000'000);
+    const auto path = std::filesystem::temp_directory_path() / "bench_mapped_flat_map.bin";
+
+    bench::print_csv_header();
+    for (std::size_t n : bench::size_ladder(1'000, max_size))
+    {
+        const auto names = bench::make_names(n);
+
+        std::flat_map<std::string, int> ages;
+        const double rebuild_ns = bench::time_ns([&] {
+            learnings::flat_map_bulk_loader<std::string, int> loader;
+            loader.reserve(n);
+            for (std::size_t i = 0; i < n; ++i)
+            {
+                loader.add(names[i], static_cast<int>(i % 100));
+            }
+            ages = std::move(loader).build();
+        });
+        const std::string &probe = names[n / 2];
+        int first = 0;
+        const double rebuilt_lookup_ns = bench::time_ns([&] { first = ages.find(probe)->second; });
+        bench::print_csv_row("startup", "rebuild_flat_map", n, "ms", rebuild_ns / 1e6);
+        bench::print_csv_row("startup", "rebuild_flat_map", n, "first_lookup_us", rebuilt_lookup_ns / 1e3);
+
+        if (auto written = learnings::write_mapped_flat_map(path, ages); !written)
+        {
+            std::print(stderr, "{}\n", written.error());
+            return EXIT_FAILURE;
+        }
+
+        for (auto verify : {learnings::mapped_verify::header, learnings::mapped_verify::full})
+        {
+            const std::string_view variant = verify == learnings::mapped_verify::header ? "mmap" : "mmap_verified";
+            std::expected<learnings::mapped_flat_map<int>, std::string> mapped;
+            const double open_ns = bench::time_ns([&] { mapped = learnings::mapped_flat_map<int>::open(path, verify); });
+            if (!mapped)
+            {
+                std::print(stderr, "{}\n", mapped.error());
+                return EXIT_FAILURE;
+            }
+            int value = 0;
+            const double lookup_ns = bench::time_ns([&] { value = (*mapped->find(probe)).second; });
+            if (value != first || mapped->size() != ages.size())
+            {
+                std::print(stderr, "mapped_flat_map disagrees with flat_map\n");
+                return EXIT_FAILURE;
+            }
+            bench::print_csv_row("startup", variant, n, "ms", open_ns / 1e6);
+            bench::print_csv_row("startup", variant, n, "first_lookup_us", lookup_ns / 1e3);
+        }
+    }
+    std::filesystem::remove(path);
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,132 @@
+/**
+ * @file bench_multi_pattern.cpp
+ * @brief One `multi_pattern_matcher` pass against one `contains` call per keyword.
+ *
+ * The document is generated prose-like text; keyword sets range from the two
+ * words of C++23.cpp ("fox", "cat") to thousands of entries, half of them
+ * words that occur in the text and half that do not. Both approaches answer
+ * "which keywords occur", and must agree; for small sets Teddy and
+ * Aho-Corasick must also report identical match lists.
+ *
+ * Usage: `bench_multi_pattern [kilobytes]` (default 1024).
+ */
+
+#include "bench_common.hpp"
+#include "multi_pattern.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+#include <print>
+#include <random>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace
+{
+    /**
+     * @brief Generates @p count lowercase words of 3 to 10 letters.
+     */
+    std::vector<std::string> make_words(std::size_t count, std::uint64_t seed)
+    {
+        std::mt19937_64 rng(seed);
+        std::vector<std::string> words(count);
+        for (auto &word : words)
+        {
+            word.resize(3 + rng() % 8);
+            for (char &c : word)
+            {
+                c = static_cast<char>('a' + rng() % 26);
+            }
+        }
+        return words;
+    }
+} // namespace
+
+int main(int argc, char **argv)
+{
+    const std::size_t kilobytes = bench::max_size_arg(argc, argv, 1024);
+
+    // Text drawn from a 20'000-word vocabulary plus the names used elsewhere.
+    const auto vocabulary = make_words(20'000, 53);
+    const auto names = bench::make_names(1'000);
+    std::mt19937_64 rng(59);
+    std::string text;
+    while (text.size() < kilobytes << 10)
+    {
+        text += rng() % 8 == 0 ? names[rng() % names.size()] : vocabulary[rng() % vocabulary.size()];
+        text += rng() % 12 == 0 ? ". " : " ";
+    }
+    text += "The quick brown fox jumps over the lazy dog.";
+
+    bench::print_csv_header();
+    bool ok = true;
+    for (const std::size_t count : {2, 8, 32, 256, 2'000})
+    {
+        std::vector<std::string> keywords;
+        if (count == 2)
+        {
+            keywords = {"fox", "cat"};
+        }
+        else
+        {
+            const auto absent = make_words(count / 2, 61); // Rarely in the vocabulary, so mostly absent.
+            for (std::size_t i = 0; i < count; ++i)
+            {
+                keywords.push_back(i % 2 == 0 ? vocabulary[rng() % vocabulary.size()] : absent[i / 2]);
+            }
+        }
+
+        std::vector<bool> sequential(count);
+        double ns = bench::time_ns([&] {
+            for (std::size_t i = 0; i < count; ++i)
+            {
+                sequential[i] = text.contains(keywords[i]);
+            }
+        });
+        const std::string variant = std::to_string(count) + "_keywords";
+        bench::print_csv_row("multi_pattern", "sequential_contains/" + variant, text.size(), "ns_per_byte",
+                             ns / text.size());
+
+        ns = bench::time_ns([&] { bench::do_not_optimize(learnings::multi_pattern_matcher(keywords)); });
+        const learnings::multi_pattern_matcher matcher(keywords);
+        bench::print_csv_row("multi_pattern_compile", std::string(matcher.engine()) + '/' + variant, count,
+                             "ns_total", ns);
+
+        std::vector<bool> single_pass;
+        ns = bench::time_ns([&] { single_pass = matcher.contains_each(text); });
+        bench::print_csv_row("multi_pattern", std::string(matcher.engine()) + '/' + variant, text.size(),
+                             "ns_per_byte", ns / text.size());
+        if (single_pass != sequential)
+        {
+            std::print(stderr, "{} disagrees with contains for {} keywords\n", matcher.engine(), count);
+            ok = false;
+        }
+
+        if (count <= learnings::multi_pattern_matcher::teddy_max_patterns)
+        {
+            auto by_position = [](const learnings::pattern_match &m) { return std::pair(m.position, m.pattern); };
+            // The engine not picked above, timed and cross-checked on every match.
+            const learnings::aho_corasick automaton(keywords);
+            std::vector<learnings::pattern_match> automaton_matches;
+            ns = bench::time_ns([&] {
+                automaton.for_each_match(text, [&](learnings::pattern_match m) { automaton_matches.push_back(m); });
+            });
+            bench::print_csv_row("multi_pattern", "aho_corasick_forced/" + variant, text.size(), "ns_per_byte",
+                                 ns / text.size());
+            std::ranges::sort(automaton_matches, {}, by_position);
+            std::vector<learnings::pattern_match> teddy_matches;
+            learnings::teddy_matcher(keywords).for_each_match(
+                text, [&](learnings::pattern_match m) { teddy_matches.push_back(m); });
+            std::ranges::sort(teddy_matches, {}, by_position);
+            if (teddy_matches != automaton_matches)
+            {
+                std::print(stderr, "teddy and aho_corasick report different matches for {} keywords\n", count);
+                ok = false;
+            }
+        }
+    }
+
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,135 @@
+/**
+ * @file bench_my_class_payload.cpp
+ * @brief Pulling a `std::vector<std::string>` out of expiring `basic_my_class` objects: copy vs move.
+ *
+ * Before `get_value` had an rvalue form, `make().get_value()` bound to the
+ * `const &` overload, and taking the result by value deep-copied every
+ * string. The `copy` variant measures that by reading through
+ * `std::as_const`; the `move` variant calls `get_value` on an rvalue, which
+ * now moves the payload out. Both destroy the extracted vector each time.
+ *
+ * Checks, on a payload that counts its copies and moves:
+ *  - an rvalue moves exactly once and never copies;
+ *  - a const or mutable lvalue hands out a reference;
+ *  - small trivially copyable payloads come back by value from const objects.
+ *
+ * Usage: `bench_my_class_payload [max_strings]` (default 100'000).
+ */
+
+#include "bench_common.hpp"
+#include "my_class.hpp"
+
+#include <algorithm>
+#include <concepts>
+#include <cstdlib>
+#include <memory>
+#include <print>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace
+{
+    template <typename T>
+    using holder = learnings::basic_my_class<T, learnings::trace_none>;
+
+    template <typename T>
+    using get_value_t = decltype(std::declval<T>().get_value());
+
+    static_assert(std::same_as<get_value_t<holder<int> &>, int &>);
+    static_assert(std::same_as<get_value_t<const holder<int> &>, int>);
+    static_assert(std::same_as<get_value_t<holder<int>>, int>);
+    static_assert(std::same_as<get_value_t<const holder<std::string> &>, const std::string &>);
+    static_assert(std::same_as<get_value_t<holder<std::string>>, std::string>);
+    static_assert(std::same_as<get_value_t<holder<std::unique_ptr<int>>>, std::unique_ptr<int>>);
+
+    /**
+     * @brief A payload that counts how often it is copied and moved.
+     */
+    struct counted
+    {
+        static inline std::size_t copies = 0;
+        static inline std::size_t moves = 0;
+
+        counted() = default;
+        counted(const counted &) { ++copies; }
+        counted(counted &&) noexcept { ++moves; }
+        counted &operator=(const counted &) = delete;
+        counted &operator=(counted &&) = delete;
+
+        static void reset() { copies = moves = 0; }
+    };
+
+    bool check_counts(const char *what, std::size_t copies, std::size_t moves)
+    {
+        if (counted::copies == copies && counted::moves == moves)
+        {
+            return true;
+        }
+        std::print(stderr, "{}: {} copies and {} moves, expected {} and {}\n", what, counted::copies, counted::moves,
+                   copies, moves);
+        return false;
+    }
+
+    bool check_value_categories()
+    {
+        bool ok = true;
+        holder<counted> object{counted{}};
+
+        counted::reset();
+        [[maybe_unused]] counted &mutable_ref = object.get_value();
+        [[maybe_unused]] const counted &const_ref = std::as_const(object).get_value();
+        ok = check_counts("lvalue get_value", 0, 0) && ok;
+        ok = &mutable_ref == &const_ref && ok;
+
+        counted::reset();
+        [[maybe_unused]] const counted copy = std::as_const(object).get_value();
+        ok = check_counts("copy from a const lvalue", 1, 0) && ok;
+
+        counted::reset();
+        [[maybe_unused]] const counted moved = std::move(object).get_value();
+        ok = check_counts("rvalue get_value", 0, 1) && ok;
+
+        counted::reset();
+        [[maybe_unused]] const counted from_temporary = holder<counted>{counted{}}.get_value();
+        ok = check_counts("get_value on a temporary", 0, 2) && ok; // One into the holder, one out of it.
+        return ok;
+    }
+} // namespace
+
+int main(int argc, char **argv)
+{
+    const std::size_t max_strings = bench::max_size_arg(argc, argv, 100'000);
+
+    bool ok = check_value_categories();
+    bench::print_csv_header();
+    for (const std::size_t n : bench::size_ladder(1, max_strings))
+    {
+        const std::vector<std::string> payload = bench::make_names(n);
+        const std::size_t objects = std::max<std::size_t>(1, 1'000'000 / n);
+
+        for (const bool move : {false, true})
+        {
+            std::vector<holder<std::vector<std::string>>> sources(objects, holder<std::vector<std::string>>(payload));
+            std::size_t extracted = 0;
+            const double ns = bench::time_ns([&] {
+                for (auto &source : sources)
+                {
+                    const auto value = move ? std::move(source).get_value() : std::as_const(source).get_value();
+                    extracted += value.size();
+                }
+            });
+            bench::do_not_optimize(extracted);
+            bench::print_csv_row("my_class_payload", move ? "move" : "copy", n, "ns_per_get",
+                                 ns / static_cast<double>(objects));
+
+            if (extracted != objects * n || (move && !sources.front().get_value().empty()))
+            {
+                std::print(stderr, "{} extracted {} strings from {} objects of {}\n", move ? "move" : "copy",
+                           extracted, objects, n);
+                ok = false;
+            }
+        }
+    }
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
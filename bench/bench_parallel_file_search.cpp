@@ -0,0 +1,192 @@
+/**
+ * @file bench_parallel_file_search.cpp
+ * @brief Throughput of `file_searcher` on a generated log file, by thread count and cache state.
+ *
+ * The file is written to the system temporary directory. Warm runs count a
+ * needle with 1, 2, 4, ... threads up to the hardware concurrency and report
+ * GB/s. Cold runs first drop the file from the page cache with
+ * `posix_fadvise(DONTNEED)` and compare searching with and without readahead
+ * advice. Every count, first offset and offset list must match a
+ * single-threaded `std::string_view::find` loop over the same bytes, and
+ * `parallel_find_first` must return the first match when every one-byte
+ * chunk holds one and sixteen threads race for them.
+ *
+ * Usage: `bench_parallel_file_search [megabytes]` (default 512).
+ */
+
+#include "bench_common.hpp"
+#include "parallel_file_search.hpp"
+
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <optional>
+#include <print>
+#include <random>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace
+{
+    /**
+     * @brief Writes about @p bytes of log lines to @p path, with `needle` in one line of 5'000.
+     */
+    void write_log(const std::filesystem::path &path, std::size_t bytes, std::string_view needle)
+    {
+        const auto names = bench::make_names(4096);
+        std::mt19937_64 rng(73);
+        std::ofstream out(path, std::ios::binary);
+        std::string line;
+        for (std::size_t written = 0; written < bytes; written += line.size())
+        {
+            line = "2024-05-" + std::to_string(10 + rng() % 20) + " worker-" + std::to_string(rng() % 64) +
+                   " GET /api/users/" + names[rng() % names.size()] + ' ' + std::to_string(rng() % 900) + "ms";
+            if (rng() % 5'000 == 0)
+            {
+                line += ' ';
+                line += needle;
+            }
+            line += '\n';
+            out << line;
+        }
+    }
+
+    /**
+     * @brief Asks the kernel to drop the file's clean pages from the page cache.
+     */
+    bool evict(const std::filesystem::path &path)
+    {
+        const int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0)
+        {
+            return false;
+        }
+        ::fdatasync(fd);
+        const bool ok = ::posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED) == 0;
+        ::close(fd);
+        return ok;
+    }
+
+    /**
+     * @brief Repeats `parallel_find_first` with one-byte chunks that all hold a match, on many threads.
+     * @details Workers race to stop each other; a claimed chunk that is
+     *          skipped shows up as a later offset than 0.
+     */
+    bool check_first_match_race()
+    {
+        const std::string text(4096, 'x');
+        learnings::parallel_search_options options;
+        options.threads = 16;
+        options.chunk_bytes = 1;
+        for (int round = 0; round < 200; ++round)
+        {
+            for (const std::string_view needle : {"x", "xx"})
+            {
+                if (const auto first = learnings::parallel_find_first(text, needle, options); first != 0)
+                {
+                    std::print(stderr, "parallel_find_first(\"{}\") returned {} instead of 0\n", needle,
+                               first.value_or(std::string_view::npos));
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
+} // namespace
+
+int main(int argc, char **argv)
+{
+    const std::size_t megabytes = bench::max_size_arg(argc, argv, 512);
+    constexpr std::string_view needle = "connection reset by peer";
+    const auto path = std::filesystem::temp_directory_path() / "bench_parallel_file_search.log";
+    write_log(path, megabytes << 20, needle);
+
+    bench::print_csv_header();
+    bool ok = check_first_match_race();
+    std::size_t expected_count = 0;
+    std::vector<std::size_t> expected_offsets;
+    std::optional<std::size_t> expected_first;
+    {
+        auto searcher = learnings::file_searcher::open(path.string());
+        if (!searcher)
+        {
+            std::print(stderr, "{}\n", searcher.error());
+            return EXIT_FAILURE;
+        }
+        const std::string_view text = searcher->text();
+        for (std::size_t pos = text.find(needle); pos != std::string_view::npos; pos = text.find(needle, pos + 1))
+        {
+            expected_offsets.push_back(pos);
+        }
+        expected_count = expected_offsets.size();
+        if (!expected_offsets.empty())
+        {
+            expected_first = expected_offsets.front();
+        }
+    }
+    const double gb = static_cast<double>(megabytes << 20) / 1e9;
+
+    const unsigned hardware = std::max(std::thread::hardware_concurrency(), 1u);
+    std::vector<unsigned> thread_counts;
+    for (unsigned t = 1; t < hardware; t *= 2)
+    {
+        thread_counts.push_back(t);
+    }
+    thread_counts.push_back(hardware);
+
+    for (const unsigned threads : thread_counts)
+    {
+        learnings::parallel_search_options options;
+        options.threads = threads;
+        auto searcher = learnings::file_searcher::open(path.string(), options);
+        if (!searcher)
+        {
+            std::print(stderr, "{}\n", searcher.error());
+            return EXIT_FAILURE;
+        }
+        std::size_t count = 0;
+        const double ns = bench::time_ns([&] { count = searcher->count(needle); });
+        bench::print_csv_row("parallel_file_search", "warm/threads_" + std::to_string(threads), megabytes << 20,
+                             "gb_per_s", gb / (ns * 1e-9));
+
+        const auto first = searcher->find_first(needle);
+        const auto offsets = searcher->find_all(needle);
+        if (count != expected_count || first != expected_first || offsets != expected_offsets)
+        {
+            std::print(stderr, "file_searcher with {} threads disagrees with string_view::find\n", threads);
+            ok = false;
+        }
+    }
+
+    for (const bool readahead : {false, true})
+    {
+        if (!evict(path))
+        {
+            std::print(stderr, "could not drop {} from the page cache; skipping cold runs\n", path.string());
+            break;
+        }
+        learnings::parallel_search_options options;
+        options.readahead = readahead;
+        auto searcher = learnings::file_searcher::open(path.string(), options);
+        if (!searcher)
+        {
+            std::print(stderr, "{}\n", searcher.error());
+            return EXIT_FAILURE;
+        }
+        std::size_t count = 0;
+        const double ns = bench::time_ns([&] { count = searcher->count(needle); });
+        bench::print_csv_row("parallel_file_search",
+                             std::string(readahead ? "cold/readahead" : "cold/no_advice") + "/threads_" +
+                                 std::to_string(hardware),
+                             megabytes << 20, "gb_per_s", gb / (ns * 1e-9));
+        ok = ok && count == expected_count;
+    }
+
+    std::filesystem::remove(path);
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,99 @@
+/**
+ * @file bench_prefix_flat_map.cpp
+ * @brief Lookup latency of `prefix_flat_map` against `std::flat_map<std::string, int>`.
+ *
+ * Keys are realistic person names, which share long prefixes ("Alexander ...",
+ * "Alexandra ..."), so the benchmark sweeps the number of 8-byte prefix words.
+ *
+ * Usage: `bench_prefix_flat_map [size]` (default 1'000'000).
+ */
+
+#include "bench_common.hpp"
+#include "flat_map_bulk.hpp"
+#include "prefix_flat_map.hpp"
+
+#include <cstdlib>
+#include <flat_map>
+#include <print>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace
+{
+    /**
+     * @brief Checks and times a `prefix_flat_map` with @p Words prefix words.
+     */
+    template <std::size_t Words>
+    bool run(const std::flat_map<std::string, int> &ages, const std::vector<std::string> &probes)
+    {
+        const learnings::prefix_flat_map<int, Words> prefixed(ages);
+        for (const auto &probe : probes)
+        {
+            const auto a = ages.find(probe);
+            const auto b = prefixed.find(probe);
+            if ((a == ages.end()) != (b == prefixed.end()) || (a != ages.end() && a->second != b->second))
+            {
+                std::print(stderr, "prefix_flat_map disagrees with flat_map for {}\n", probe);
+                return false;
+            }
+        }
+
+        long sum = 0;
+        const double ns = bench::time_ns([&] {
+            for (const auto &probe : probes)
+            {
+                const auto it = prefixed.find(probe);
+                sum += it == prefixed.end() ? 0 : it->second;
+            }
+        });
+        bench::do_not_optimize(sum);
+        const std::string variant = "prefix_flat_map<" + std::to_string(Words) + ">";
+        bench::print_csv_row("prefix_lookup", variant, ages.size(), "ns_per_lookup", ns / probes.size());
+        bench::print_csv_row("prefix_lookup", variant, ages.size(), "prefix_bytes_per_key",
+                             static_cast<double>(prefixed.prefix_bytes()) / ages.size());
+        return true;
+    }
+} // namespace
+
+int main(int argc, char **argv)
+{
+    const std::size_t n = bench::max_size_arg(argc, argv, 1'000'000);
+    constexpr std::size_t lookups = 1'000'000;
+
+    const auto names = bench::make_names(n);
+    learnings::flat_map_bulk_loader<std::string, int> loader;
+    for (std::size_t i = 0; i < n; ++i)
+    {
+        loader.add(names[i], static_cast<int>(i % 100));
+    }
+    const auto ages = std::move(loader).build();
+
+    // Half hits, half near-misses that share the whole prefix with a real key.
+    std::mt19937_64 rng(3);
+    std::uniform_int_distribution<std::size_t> pick(0, n - 1);
+    std::vector<std::string> probes(lookups);
+    for (std::size_t i = 0; i < lookups; ++i)
+    {
+        probes[i] = names[pick(rng)];
+        if (i % 2 == 1)
+        {
+            probes[i] += '~';
+        }
+    }
+
+    bench::print_csv_header();
+    long sum = 0;
+    const double ns = bench::time_ns([&] {
+        for (const auto &probe : probes)
+        {
+            const auto it = ages.find(probe);
+            sum += it == ages.end() ? 0 : it->second;
+        }
+    });
+    bench::print_csv_row("prefix_lookup", "flat_map<string>", n, "ns_per_lookup", ns / lookups);
+    bench::do_not_optimize(sum);
+
+    const bool ok = run<1>(ages, probes) && run<2>(ages, probes) && run<3>(ages, probes);
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,154 @@
+/**
+ * @file bench_simd_search.cpp
+ * @brief Substring search throughput of `simd_find` against the standard library and `memmem`.
+ *
+ * The haystack is a generated log buffer with a needle of up to 64 bytes
+ * planted a few times. For needle prefixes of 2 to 64 bytes every variant
+ * counts all occurrences, and separately answers `contains` for a variant of
+ * the needle that never occurs. Counts and answers must agree with
+ * `std::string_view::find`. Set `LEARNINGS_SIMD` to compare kernel tiers.
+ *
+ * Usage: `bench_simd_search [megabytes]` (default 64).
+ */
+
+#include "bench_common.hpp"
+#include "simd_search.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <print>
+#include <random>
+#include <string>
+#include <string_view>
+
+namespace
+{
+    /**
+     * @brief Generates about @p bytes of log lines such as
+     *        `2024-05-01T12:00:03 INFO worker-17 GET /api/users/Alice 200 12ms`.
+     */
+    std::string make_log(std::size_t bytes)
+    {
+        constexpr std::string_view levels[] = {"INFO", "INFO", "INFO", "DEBUG", "WARN"};
+        constexpr std::string_view methods[] = {"GET", "GET", "POST", "PUT", "DELETE"};
+        constexpr std::string_view resources[] = {"users", "orders", "sessions", "reports", "uploads"};
+        const auto names = bench::make_names(1024);
+        std::mt19937_64 rng(43);
+        std::string log;
+        log.reserve(bytes + 256);
+        while (log.size() < bytes)
+        {
+            log += "2024-05-" + std::to_string(10 + rng() % 20) + "T12:" + std::to_string(10 + rng() % 50) + ':' +
+                   std::to_string(10 + rng() % 50) + ' ';
+            log += levels[rng() % std::size(levels)];
+            log += " worker-" + std::to_string(rng() % 64) + ' ';
+            log += methods[rng() % std::size(methods)];
+            log += " /api/";
+            log += resources[rng() % std::size(resources)];
+            log += '/' + names[rng() % names.size()] + ' ' + std::to_string(200 + rng() % 4) + ' ' +
+                   std::to_string(rng() % 900) + "ms\n";
+        }
+        return log;
+    }
+
+    /**
+     * @brief Counts the (possibly overlapping) occurrences of a needle with @p find(pos).
+     */
+    template <typename Find>
+    std::size_t count_all(std::size_t size, Find find)
+    {
+        std::size_t count = 0;
+        for (std::size_t pos = find(0); pos != std::string_view::npos && pos < size; pos = find(pos + 1))
+        {
+            ++count;
+        }
+        return count;
+    }
+} // namespace
+
+int main(int argc, char **argv)
+{
+    const std::size_t megabytes = bench::max_size_arg(argc, argv, 64);
+    std::string log = make_log(megabytes << 20);
+
+    // A needle that looks like the text around it: most of its prefixes and
+    // its bytes occur everywhere, the whole of it only where planted.
+    constexpr std::string_view needle_source =
+        "ERROR worker-99 GET /api/users/Alexander Thompson 500 disk quota exceeded on /var/lib/data";
+    std::mt19937_64 rng(47);
+    for (int i = 0; i < 8; ++i)
+    {
+        const std::size_t at = rng() % (log.size() - needle_source.size());
+        log.replace(at, needle_source.size(), needle_source);
+    }
+    const std::string_view text = log;
+    const double mb = static_cast<double>(log.size()) / (1 << 20);
+    const std::string simd_name = "simd_find_" + std::string(learnings::to_string(learnings::active_simd_level()));
+
+    bench::print_csv_header();
+    bool ok = true;
+    for (const std::size_t length : {2, 4, 8, 16, 32, 64})
+    {
+        const std::string needle(needle_source.substr(0, length));
+        const std::string variant = "needle_" + std::to_string(length);
+        std::size_t expected = 0;
+
+        // Counting every occurrence: the work no longer depends on where the first match is.
+        auto count = [&](const char *name, auto find) {
+            std::size_t found = 0;
+            const double ns = bench::time_ns([&] { found = count_all(log.size(), find); });
+            bench::print_csv_row("substring_count", std::string(name) + '/' + variant, log.size(), "mb_per_s",
+                                 mb / (ns * 1e-9));
+            bench::do_not_optimize(found);
+            if (found != expected)
+            {
+                std::print(stderr, "{} found {} occurrences of '{}', expected {}\n", name, found, needle, expected);
+                ok = false;
+            }
+        };
+        expected = count_all(log.size(), [&](std::size_t pos) { return text.find(needle, pos); });
+        count("string_view::find", [&](std::size_t pos) { return text.find(needle, pos); });
+#if defined(__GLIBC__)
+        count("memmem", [&](std::size_t pos) {
+            const void *hit = ::memmem(text.data() + pos, text.size() - pos, needle.data(), needle.size());
+            return hit == nullptr ? std::string_view::npos
+                                  : static_cast<std::size_t>(static_cast<const char *>(hit) - text.data());
+        });
+#endif
+        const std::boyer_moore_horspool_searcher searcher(needle.begin(), needle.end());
+        count("boyer_moore_horspool", [&](std::size_t pos) {
+            const auto hit = std::search(text.begin() + pos, text.end(), searcher);
+            return hit == text.end() ? std::string_view::npos : static_cast<std::size_t>(hit - text.begin());
+        });
+        count(simd_name.c_str(), [&](std::size_t pos) { return learnings::simd_find(text, needle, pos); });
+
+        // An absent needle, as in `log.contains(...)` returning false: one full scan. Only a
+        // middle byte is changed, so the first and last bytes still produce candidates.
+        std::string absent = needle;
+        absent[length / 2] = '\x01';
+        auto scan = [&](const char *name, auto contains) {
+            bool found = true;
+            const double ns = bench::time_ns([&] { found = contains(); });
+            bench::print_csv_row("substring_absent", std::string(name) + '/' + variant, log.size(), "mb_per_s",
+                                 mb / (ns * 1e-9));
+            bench::do_not_optimize(found);
+            if (found)
+            {
+                std::print(stderr, "{} reports an absent needle as present\n", name);
+                ok = false;
+            }
+        };
+        scan("string::contains", [&] { return log.contains(absent); });
+#if defined(__GLIBC__)
+        scan("memmem", [&] { return ::memmem(log.data(), log.size(), absent.data(), absent.size()) != nullptr; });
+#endif
+        const std::boyer_moore_horspool_searcher absent_searcher(absent.begin(), absent.end());
+        scan("boyer_moore_horspool",
+             [&] { return std::search(log.begin(), log.end(), absent_searcher) != log.end(); });
+        scan(simd_name.c_str(), [&] { return learnings::simd_contains(text, absent); });
+    }
+
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
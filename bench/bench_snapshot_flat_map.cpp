@@ -0,0 +1,150 @@
+/**
+ * @file bench_snapshot_flat_map.cpp
+ * @brief Read throughput of `snapshot_flat_map` against a `std::flat_map`
+ *        behind a `std::shared_mutex`, as the number of reader threads grows.
+ *
+ * A writer thread publishes a batch of updates five times a second while the
+ * readers look up random names for a fixed wall-clock duration.
+ *
+ * Usage: `bench_snapshot_flat_map [max_threads]` (default 64).
+ */
+
+#include "bench_common.hpp"
+#include "flat_map_bulk.hpp"
+#include "snapshot_flat_map.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <flat_map>
+#include <mutex>
+#include <print>
+#include <random>
+#include <shared_mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace
+{
+    constexpr std::size_t map_size = 1'000'000;
+    constexpr std::size_t updates_per_batch = 1'000;
+    constexpr auto run_time = std::chrono::milliseconds(1'000);
+    constexpr auto publish_interval = std::chrono::milliseconds(200);
+
+    /**
+     * @brief The baseline: one map, readers share the lock, the writer takes it exclusively.
+     */
+    class locked_flat_map
+    {
+    public:
+        explicit locked_flat_map(std::flat_map<std::string, int> map) : map_(std::move(map)) {}
+
+        std::optional<int> find(const std::string &key) const
+        {
+            std::shared_lock lock(mutex_);
+            const auto it = map_.find(key);
+            return it == map_.end() ? std::nullopt : std::optional<int>(it->second);
+        }
+
+        void apply(std::vector<std::pair<std::string, std::optional<int>>> updates)
+        {
+            std::unique_lock lock(mutex_);
+            learnings::apply_updates(map_, std::move(updates));
+        }
+
+    private:
+        mutable std::shared_mutex mutex_;
+        std::flat_map<std::string, int> map_;
+    };
+
+    std::vector<std::pair<std::string, std::optional<int>>> make_batch(const std::vector<std::string> &names,
+                                                                       std::mt19937_64 &rng)
+    {
+        std::uniform_int_distribution<std::size_t> pick(0, names.size() - 1);
+        std::vector<std::pair<std::string, std::optional<int>>> batch;
+        for (std::size_t i = 0; i < updates_per_batch; ++i)
+        {
+            batch.emplace_back(names[pick(rng)], static_cast<int>(rng() % 100));
+        }
+        return batch;
+    }
+
+    /**
+     * @brief Runs @p readers lookup threads plus one writer; returns lookups per second.
+     */
+    template <typename Lookup, typename Update>
+    double measure(unsigned readers, const std::vector<std::string> &names, Lookup lookup, Update update)
+    {
+        std::atomic<bool> stop{false};
+        std::atomic<std::uint64_t> total{0};
+        {
+            std::vector<std::jthread> threads;
+            for (unsigned t = 0; t < readers; ++t)
+            {
+                threads.emplace_back([&, t] {
+                    std::mt19937_64 rng(t);
+                    std::uniform_int_distribution<std::size_t> pick(0, names.size() - 1);
+                    std::uint64_t count = 0;
+                    long sum = 0;
+                    while (!stop.load(std::memory_order_relaxed))
+                    {
+                        for (int i = 0; i < 64; ++i, ++count)
+                        {
+                            sum += lookup(names[pick(rng)]).value_or(0);
+                        }
+                    }
+                    bench::do_not_optimize(sum);
+                    total += count;
+                });
+            }
+            threads.emplace_back([&] {
+                std::mt19937_64 rng(12345);
+                while (!stop.load())
+                {
+                    std::this_thread::sleep_for(publish_interval);
+                    update(make_batch(names, rng));
+                }
+            });
+            std::this_thread::sleep_for(run_time);
+            stop = true;
+        }
+        return static_cast<double>(total.load()) / std::chrono::duration<double>(run_time).count();
+    }
+} // namespace
+
+int main(int argc, char **argv)
+{
+    const unsigned max_threads = static_cast<unsigned>(bench::max_size_arg(argc, argv, 64));
+    const auto names = bench::make_names(map_size);
+
+    learnings::flat_map_bulk_loader<std::string, int> loader;
+    for (std::size_t i = 0; i < names.size(); ++i)
+    {
+        loader.add(names[i], static_cast<int>(i % 100));
+    }
+    const auto ages = std::move(loader).build();
+
+    bench::print_csv_header();
+    for (unsigned readers = 1; readers <= max_threads; readers *= 2)
+    {
+        learnings::snapshot_flat_map<std::string, int> snapshot(ages);
+        const double snapshot_rate = measure(
+            readers, names, [&](const std::string &key) { return snapshot.find(key); },
+            [&](auto batch) {
+                for (auto &[key, value] : batch)
+                {
+                    snapshot.stage_assign(std::move(key), *value);
+                }
+                snapshot.publish();
+            });
+        bench::print_csv_row("concurrent_reads", "snapshot_flat_map", readers, "mlookups_per_s", snapshot_rate / 1e6);
+
+        locked_flat_map locked(ages);
+        const double locked_rate = measure(
+            readers, names, [&](const std::string &key) { return locked.find(key); },
+            [&](auto batch) { locked.apply(std::move(batch)); });
+        bench::print_csv_row("concurrent_reads", "shared_mutex", readers, "mlookups_per_s", locked_rate / 1e6);
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,188 @@
+/**
+ * @file bench_static_perfect_hash.cpp
+ * @brief Lookup latency of a compile-time `perfect_hash_map` against `std::flat_map` and `std::unordered_map`.
+ *
+ * The key set is fixed when the program is built: the `ages` names from
+ * C++23.cpp and a table of HTTP header names, a typical static vocabulary.
+ * Probes are half hits and half misses.
+ *
+ * Usage: `bench_static_perfect_hash [lookups]` (default 1'000'000).
+ */
+
+#include "bench_common.hpp"
+#include "static_perfect_hash.hpp"
+
+#include <cstdlib>
+#include <flat_map>
+#include <functional>
+#include <print>
+#include <random>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace
+{
+    constexpr auto ages = learnings::make_perfect_hash_map<int>({{"Alice", 30}, {"Bob", 25}, {"Charlie", 35}});
+    static_assert(*ages.find("Bob") == 25);
+    static_assert(!ages.contains("Dave"));
+
+    constexpr auto headers = learnings::make_perfect_hash_map<int>({
+        {"Accept", 0},
+        {"Accept-Charset", 1},
+        {"Accept-Encoding", 2},
+        {"Accept-Language", 3},
+        {"Access-Control-Allow-Origin", 4},
+        {"Age", 5},
+        {"Allow", 6},
+        {"Authorization", 7},
+        {"Cache-Control", 8},
+        {"Connection", 9},
+        {"Content-Disposition", 10},
+        {"Content-Encoding", 11},
+        {"Content-Language", 12},
+        {"Content-Length", 13},
+        {"Content-Location", 14},
+        {"Content-Range", 15},
+        {"Content-Security-Policy", 16},
+        {"Content-Type", 17},
+        {"Cookie", 18},
+        {"Date", 19},
+        {"ETag", 20},
+        {"Expect", 21},
+        {"Expires", 22},
+        {"Forwarded", 23},
+        {"From", 24},
+        {"Host", 25},
+        {"If-Match", 26},
+        {"If-Modified-Since", 27},
+        {"If-None-Match", 28},
+        {"If-Range", 29},
+        {"If-Unmodified-Since", 30},
+        {"Last-Modified", 31},
+        {"Link", 32},
+        {"Location", 33},
+        {"Max-Forwards", 34},
+        {"Origin", 35},
+        {"Pragma", 36},
+        {"Proxy-Authorization", 37},
+        {"Range", 38},
+        {"Referer", 39},
+        {"Retry-After", 40},
+        {"Server", 41},
+        {"Set-Cookie", 42},
+        {"Strict-Transport-Security", 43},
+        {"TE", 44},
+        {"Trailer", 45},
+        {"Transfer-Encoding", 46},
+        {"Upgrade", 47},
+        {"User-Agent", 48},
+        {"Vary", 49},
+        {"Via", 50},
+        {"WWW-Authenticate", 51},
+    });
+
+    /**
+     * @brief Times lookups of every probe in the three containers, after checking they agree.
+     */
+    template <typename Table>
+    bool run(const Table &table, const std::string &variant, const std::vector<std::string> &keys,
+             const std::vector<std::string> &probes)
+    {
+        std::flat_map<std::string, int, std::less<>> sorted;
+        std::unordered_map<std::string, int> hashed;
+        for (const auto &key : keys)
+        {
+            const int *value = table.find(key);
+            if (value == nullptr)
+            {
+                std::print(stderr, "perfect_hash_map lost key {}\n", key);
+                return false;
+            }
+            sorted.emplace(key, *value);
+            hashed.emplace(key, *value);
+        }
+        for (const auto &probe : probes)
+        {
+            const int *value = table.find(probe);
+            const auto it = sorted.find(probe);
+            if ((value == nullptr) != (it == sorted.end()) || (value != nullptr && *value != it->second))
+            {
+                std::print(stderr, "perfect_hash_map disagrees with flat_map for {}\n", probe);
+                return false;
+            }
+        }
+
+        const std::size_t n = Table::size();
+        long sum = 0;
+        double ns = bench::time_ns([&] {
+            for (const auto &probe : probes)
+            {
+                const int *value = table.find(probe);
+                sum += value == nullptr ? 0 : *value;
+            }
+        });
+        bench::print_csv_row("static_lookup", "perfect_hash_map/" + variant, n, "ns_per_lookup", ns / probes.size());
+
+        ns = bench::time_ns([&] {
+            for (const auto &probe : probes)
+            {
+                const auto it = sorted.find(probe);
+                sum += it == sorted.end() ? 0 : it->second;
+            }
+        });
+        bench::print_csv_row("static_lookup", "flat_map/" + variant, n, "ns_per_lookup", ns / probes.size());
+
+        ns = bench::time_ns([&] {
+            for (const auto &probe : probes)
+            {
+                const auto it = hashed.find(probe);
+                sum += it == hashed.end() ? 0 : it->second;
+            }
+        });
+        bench::print_csv_row("static_lookup", "unordered_map/" + variant, n, "ns_per_lookup", ns / probes.size());
+        bench::do_not_optimize(sum);
+        return true;
+    }
+
+    /**
+     * @brief Draws @p count probes from @p keys; every other probe is turned into a miss.
+     */
+    std::vector<std::string> make_probes(const std::vector<std::string> &keys, std::size_t count)
+    {
+        std::mt19937_64 rng(5);
+        std::uniform_int_distribution<std::size_t> pick(0, keys.size() - 1);
+        std::vector<std::string> probes(count);
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            probes[i] = keys[pick(rng)];
+            if (i % 2 == 1)
+            {
+                probes[i].back() = '~';
+            }
+        }
+        return probes;
+    }
+} // namespace
+
+int main(int argc, char **argv)
+{
+    const std::size_t lookups = bench::max_size_arg(argc, argv, 1'000'000);
+
+    const std::vector<std::string> names = {"Alice", "Bob", "Charlie"};
+    const std::vector<std::string> header_names = {
+        "Accept", "Accept-Charset", "Accept-Encoding", "Accept-Language", "Access-Control-Allow-Origin", "Age",
+        "Allow", "Authorization", "Cache-Control", "Connection", "Content-Disposition", "Content-Encoding",
+        "Content-Language", "Content-Length", "Content-Location", "Content-Range", "Content-Security-Policy",
+        "Content-Type", "Cookie", "Date", "ETag", "Expect", "Expires", "Forwarded", "From", "Host", "If-Match",
+        "If-Modified-Since", "If-None-Match", "If-Range", "If-Unmodified-Since", "Last-Modified", "Link",
+        "Location", "Max-Forwards", "Origin", "Pragma", "Proxy-Authorization", "Range", "Referer", "Retry-After",
+        "Server", "Set-Cookie", "Strict-Transport-Security", "TE", "Trailer", "Transfer-Encoding", "Upgrade",
+        "User-Agent", "Vary", "Via", "WWW-Authenticate"};
+
+    bench::print_csv_header();
+    const bool ok = run(ages, "ages", names, make_probes(names, lookups)) &&
+                    run(headers, "http_headers", header_names, make_probes(header_names, lookups));
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,133 @@
+/**
+ * @file bench_static_search_map.cpp
+ * @brief Lookup throughput of `eytzinger_map` and `static_btree_map` against
+ *        `std::flat_map`, `std::map` and `std::unordered_map`.
+ *
+ * Usage: `bench_static_search_map [max_size]` (default 10'000'000; pass
+ * 100000000 for the full ladder, which needs roughly 16 GiB for `std::map`).
+ */
+
+#include "bench_common.hpp"
+#include "flat_map_bulk.hpp"
+#include "static_search_map.hpp"
+
+#include <cstdint>
+#include <cstdlib>
+#include <flat_map>
+#include <map>
+#include <print>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace
+{
+    constexpr std::size_t lookups = 2'000'000;
+
+    /**
+     * @brief Times @p lookups probes of @p find and prints million lookups per second.
+     */
+    template <typename Find>
+    void run(std::string_view variant, std::size_t n, const std::vector<std::int32_t> &probes, Find find)
+    {
+        long sum = 0;
+        const double ns = bench::time_ns([&] {
+            for (std::int32_t key : probes)
+            {
+                sum += find(key);
+            }
+        });
+        bench::do_not_optimize(sum);
+        bench::print_csv_row("static_lookup", variant, n, "mlookups_per_s", probes.size() / ns * 1e3);
+    }
+
+    /**
+     * @brief Verifies the static maps against the flat_map they were built from.
+     */
+    bool check_names()
+    {
+        std::flat_map<std::string, int> ages;
+        ages["Alice"] = 30;
+        ages["Bob"] = 25;
+        ages["Charlie"] = 35;
+        const learnings::eytzinger_map<std::string, int> fast(ages);
+        return *fast.find(std::string("Alice")) == 30 && *fast.find(std::string("Charlie")) == 35 &&
+               !fast.contains(std::string("Dave")) && !fast.contains(std::string("Aaron"));
+    }
+} // namespace
+
+int main(int argc, char **argv)
+{
+    const std::size_t max_size = bench::max_size_arg(argc, argv, 10'000'000);
+    if (!check_names())
+    {
+        std::print(stderr, "eytzinger_map failed on string keys\n");
+        return EXIT_FAILURE;
+    }
+
+    bench::print_csv_header();
+    for (std::size_t n : bench::size_ladder(1'000, max_size))
+    {
+        // Even keys are hits, odd keys are misses.
+        learnings::flat_map_bulk_loader<std::int32_t, int> loader;
+        std::mt19937_64 rng(n);
+        std::uniform_int_distribution<std::int32_t> key_dist(-(1 << 30), (1 << 30) - 1);
+        for (std::size_t i = 0; i < n; ++i)
+        {
+            loader.add(key_dist(rng) & ~1, static_cast<int>(i));
+        }
+        const auto flat = std::move(loader).build();
+
+        std::vector<std::int32_t> probes(lookups);
+        std::uniform_int_distribution<std::size_t> pick(0, flat.size() - 1);
+        for (std::size_t i = 0; i < probes.size(); ++i)
+        {
+            probes[i] = flat.keys()[pick(rng)] | static_cast<std::int32_t>(i % 4 == 0); // 25% misses.
+        }
+
+        const learnings::eytzinger_map<std::int32_t, int> eytzinger(flat);
+        const learnings::static_btree_map<std::int32_t, int> btree(flat);
+        for (std::int32_t key : probes)
+        {
+            const auto it = flat.find(key);
+            const int *expected = it == flat.end() ? nullptr : &it->second;
+            const int *a = eytzinger.find(key);
+            const int *b = btree.find(key);
+            if ((expected == nullptr) != (a == nullptr) || (expected == nullptr) != (b == nullptr) ||
+                (expected && (*a != *expected || *b != *expected)))
+            {
+                std::print(stderr, "static maps disagree with flat_map for key {}\n", key);
+                return EXIT_FAILURE;
+            }
+        }
+
+        run("flat_map", flat.size(), probes, [&](std::int32_t k) {
+            const auto it = flat.find(k);
+            return it == flat.end() ? 0 : it->second;
+        });
+        run("eytzinger_map", flat.size(), probes, [&](std::int32_t k) {
+            const int *v = eytzinger.find(k);
+            return v ? *v : 0;
+        });
+        run("static_btree_map", flat.size(), probes, [&](std::int32_t k) {
+            const int *v = btree.find(k);
+            return v ? *v : 0;
+        });
+        {
+            const std::map<std::int32_t, int> tree(flat.begin(), flat.end());
+            run("map", flat.size(), probes, [&](std::int32_t k) {
+                const auto it = tree.find(k);
+                return it == tree.end() ? 0 : it->second;
+            });
+        }
+        {
+            const std::unordered_map<std::int32_t, int> hash(flat.begin(), flat.end());
+            run("unordered_map", flat.size(), probes, [&](std::int32_t k) {
+                const auto it = hash.find(k);
+                return it == hash.end() ? 0 : it->second;
+            });
+        }
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,123 @@
+/**
+ * @file bench_streaming_matcher.cpp
+ * @brief `streaming_matcher` fed in chunks against one in-memory search of the same bytes.
+ *
+ * A generated log buffer is searched once whole with `compiled_needle`, then
+ * fed to a `streaming_matcher` in chunks of 4 KiB to 1 MiB, and finally sent
+ * through a pipe by a writer thread and fed from 64 KiB `read` calls, as a
+ * socket or `stdin` consumer would. Match counts and the first offset must
+ * agree with the in-memory search.
+ *
+ * Usage: `bench_streaming_matcher [megabytes]` (default 256).
+ */
+
+#include "bench_common.hpp"
+#include "streaming_matcher.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+#include <print>
+#include <random>
+#include <span>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include <unistd.h>
+
+namespace
+{
+    std::string make_log(std::size_t bytes, std::string_view needle)
+    {
+        const auto names = bench::make_names(4096);
+        std::mt19937_64 rng(79);
+        std::string log;
+        log.reserve(bytes + 256);
+        while (log.size() < bytes)
+        {
+            log += "2024-05-" + std::to_string(10 + rng() % 20) + " worker-" + std::to_string(rng() % 64) +
+                   " GET /api/users/" + names[rng() % names.size()] + ' ' + std::to_string(rng() % 900) + "ms";
+            if (rng() % 2'000 == 0)
+            {
+                log += ' ';
+                log += needle;
+            }
+            log += '\n';
+        }
+        return log;
+    }
+} // namespace
+
+int main(int argc, char **argv)
+{
+    const std::size_t megabytes = bench::max_size_arg(argc, argv, 256);
+    constexpr std::string_view needle = "upstream connect error";
+    const std::string log = make_log(megabytes << 20, needle);
+    const double gb = static_cast<double>(log.size()) / 1e9;
+
+    bench::print_csv_header();
+    const learnings::compiled_needle compiled(needle);
+    std::size_t expected = 0;
+    std::size_t expected_first = std::string_view::npos;
+    double ns = bench::time_ns([&] {
+        for (std::size_t pos = compiled.find(log); pos != std::string_view::npos; pos = compiled.find(log, pos + 1))
+        {
+            expected_first = std::min(expected_first, pos);
+            ++expected;
+        }
+    });
+    bench::print_csv_row("streaming_matcher", "in_memory", log.size(), "gb_per_s", gb / (ns * 1e-9));
+
+    bool ok = true;
+    for (const std::size_t chunk : {std::size_t{4} << 10, std::size_t{64} << 10, std::size_t{1} << 20})
+    {
+        learnings::streaming_matcher matcher(needle);
+        ns = bench::time_ns([&] {
+            for (std::size_t at = 0; at < log.size(); at += chunk)
+            {
+                matcher.feed(std::span<const char>(log.data() + at, std::min(chunk, log.size() - at)));
+            }
+        });
+        bench::print_csv_row("streaming_matcher", "chunks_" + std::to_string(chunk >> 10) + "k", log.size(),
+                             "gb_per_s", gb / (ns * 1e-9));
+        ok = ok && matcher.match_count() == expected && matcher.first_match() == expected_first;
+    }
+
+    int fds[2];
+    if (::pipe(fds) != 0)
+    {
+        std::print(stderr, "pipe failed\n");
+        return EXIT_FAILURE;
+    }
+    learnings::streaming_matcher matcher(needle);
+    ns = bench::time_ns([&] {
+        std::jthread writer([&] {
+            for (std::size_t at = 0; at < log.size();)
+            {
+                const ssize_t n = ::write(fds[1], log.data() + at, log.size() - at);
+                if (n <= 0)
+                {
+                    break;
+                }
+                at += static_cast<std::size_t>(n);
+            }
+            ::close(fds[1]);
+        });
+        std::vector<char> buffer(std::size_t{64} << 10);
+        for (ssize_t n; (n = ::read(fds[0], buffer.data(), buffer.size())) > 0;)
+        {
+            matcher.feed(std::span<const char>(buffer.data(), static_cast<std::size_t>(n)));
+        }
+    });
+    ::close(fds[0]);
+    bench::print_csv_row("streaming_matcher", "pipe_64k", log.size(), "gb_per_s", gb / (ns * 1e-9));
+    ok = ok && matcher.match_count() == expected && matcher.bytes_consumed() == log.size();
+
+    if (!ok)
+    {
+        std::print(stderr, "streaming_matcher disagrees with the in-memory search\n");
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,110 @@
+/**
+ * @file bench_string_arena.cpp
+ * @brief Compares `std::flat_map<std::string, int>` with `interned_flat_map<int>`
+ *        for memory footprint and lookup speed.
+ *
+ * Usage: `bench_string_arena [max_size]` (default 10'000'000).
+ */
+
+#include "bench_common.hpp"
+#include "flat_map_bulk.hpp"
+#include "string_arena.hpp"
+
+#include <cstdlib>
+#include <flat_map>
+#include <print>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace
+{
+    constexpr std::size_t lookups = 1'000'000;
+
+    /**
+     * @brief Heap bytes held by a string-keyed flat_map, counting SSO-spilled keys.
+     */
+    std::size_t memory_bytes(const std::flat_map<std::string, int> &map)
+    {
+        const std::size_t sso_capacity = std::string().capacity();
+        std::size_t bytes = map.keys().capacity() * sizeof(std::string) + map.values().capacity() * sizeof(int);
+        for (const auto &key : map.keys())
+        {
+            if (key.capacity() > sso_capacity)
+            {
+                bytes += key.capacity() + 1;
+            }
+        }
+        return bytes;
+    }
+} // namespace
+
+int main(int argc, char **argv)
+{
+    const std::size_t max_size = bench::max_size_arg(argc, argv, 10'000'000);
+
+    bench::print_csv_header();
+    for (std::size_t n : bench::size_ladder(10'000, max_size))
+    {
+        const auto names = bench::make_names(n);
+
+        learnings::flat_map_bulk_loader<std::string, int> loader;
+        for (std::size_t i = 0; i < n; ++i)
+        {
+            loader.add(names[i], static_cast<int>(i % 100));
+        }
+        const auto ages = std::move(loader).build();
+        const learnings::interned_flat_map<int> interned(ages);
+
+        // Both maps must agree before their timings mean anything.
+        for (std::size_t i = 0; i < n; i += 997)
+        {
+            if (interned.find(names[i])->second != ages.find(names[i])->second)
+            {
+                std::print(stderr, "interned_flat_map disagrees at {}\n", names[i]);
+                return EXIT_FAILURE;
+            }
+        }
+
+        std::mt19937_64 rng(7);
+        std::uniform_int_distribution<std::size_t> pick(0, n - 1);
+        std::vector<std::size_t> probes(lookups);
+        for (auto &p : probes)
+        {
+            p = pick(rng);
+        }
+
+        bench::print_csv_row("string_keys", "flat_map<string>", n, "bytes_per_key",
+                             static_cast<double>(memory_bytes(ages)) / n);
+        bench::print_csv_row("string_keys", "interned_flat_map", n, "bytes_per_key",
+                             static_cast<double>(interned.memory_bytes()) / n);
+
+        long sum = 0;
+        double ns = bench::time_ns([&] {
+            for (std::size_t p : probes)
+            {
+                sum += ages.find(names[p])->second;
+            }
+        });
+        bench::print_csv_row("string_keys", "flat_map<string>", n, "ns_per_lookup", ns / lookups);
+
+        ns = bench::time_ns([&] {
+            for (std::size_t p : probes)
+            {
+                sum += interned.find(names[p])->second;
+            }
+        });
+        bench::print_csv_row("string_keys", "interned_flat_map", n, "ns_per_lookup", ns / lookups);
+
+        // Callers that already hold handles skip the string search entirely.
+        ns = bench::time_ns([&] {
+            for (std::size_t p : probes)
+            {
+                sum += interned.find(learnings::string_id{static_cast<std::uint32_t>(p)})->second;
+            }
+        });
+        bench::print_csv_row("string_keys", "interned_flat_map_by_id", n, "ns_per_lookup", ns / lookups);
+        bench::do_not_optimize(sum);
+    }
+    return EXIT_SUCCESS;
+}
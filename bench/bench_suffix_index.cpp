@@ -0,0 +1,156 @@
+/**
+ * @file bench_suffix_index.cpp
+ * @brief `suffix_index` build cost, size and query latency against repeated SIMD scans of the corpus.
+ *
+ * A generated log corpus is indexed as a suffix array and as an FM-index.
+ * For each kind the benchmark reports build time, index bytes per corpus
+ * byte, and the latency of `count` and `locate` for patterns cut from the
+ * corpus and for absent ones, both on the built index and after a
+ * `save` / `open` round trip through a mapped file. The baseline counts
+ * each pattern with a `simd_find` scan of the whole corpus. All answers must
+ * agree with the scans.
+ *
+ * Usage: `bench_suffix_index [megabytes]` (default 16).
+ */
+
+#include "bench_common.hpp"
+#include "simd_search.hpp"
+#include "suffix_index.hpp"
+
+#include <cstdlib>
+#include <filesystem>
+#include <optional>
+#include <print>
+#include <random>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace
+{
+    std::string make_corpus(std::size_t bytes)
+    {
+        const auto names = bench::make_names(4096);
+        std::mt19937_64 rng(89);
+        std::string text;
+        text.reserve(bytes + 256);
+        while (text.size() < bytes)
+        {
+            text += "2024-05-" + std::to_string(10 + rng() % 20) + " worker-" + std::to_string(rng() % 64) +
+                    " GET /api/users/" + names[rng() % names.size()] + ' ' + std::to_string(rng() % 900) + "ms\n";
+        }
+        return text;
+    }
+
+    std::vector<std::size_t> scan_all(std::string_view text, std::string_view pattern)
+    {
+        std::vector<std::size_t> positions;
+        for (std::size_t pos = learnings::simd_find(text, pattern); pos != std::string_view::npos;
+             pos = learnings::simd_find(text, pattern, pos + 1))
+        {
+            positions.push_back(pos);
+        }
+        return positions;
+    }
+} // namespace
+
+int main(int argc, char **argv)
+{
+    const std::size_t megabytes = bench::max_size_arg(argc, argv, 16);
+    const std::string corpus = make_corpus(megabytes << 20);
+
+    // Patterns cut from the corpus, plus every fifth one that does not occur.
+    std::mt19937_64 rng(97);
+    std::vector<std::string> patterns;
+    for (std::size_t i = 0; i < 1'000; ++i)
+    {
+        std::string pattern = corpus.substr(rng() % (corpus.size() - 32), 4 + rng() % 20);
+        if (i % 5 == 0)
+        {
+            pattern += "#absent";
+        }
+        patterns.push_back(std::move(pattern));
+    }
+    constexpr std::size_t scanned_patterns = 20; // A full scan per query is slow; the baseline uses a prefix.
+    std::vector<std::vector<std::size_t>> expected;
+    for (std::size_t i = 0; i < scanned_patterns; ++i)
+    {
+        expected.push_back(scan_all(corpus, patterns[i]));
+    }
+
+    bench::print_csv_header();
+    bool ok = true;
+    const double queries = static_cast<double>(patterns.size());
+    {
+        std::size_t total = 0;
+        const double ns = bench::time_ns([&] {
+            for (std::size_t i = 0; i < scanned_patterns; ++i)
+            {
+                total += scan_all(corpus, patterns[i]).size();
+            }
+        });
+        bench::do_not_optimize(total);
+        bench::print_csv_row("suffix_index_query", "simd_scan/count", corpus.size(), "ns_per_query",
+                             ns / scanned_patterns);
+    }
+
+    const auto path = std::filesystem::temp_directory_path() / "bench_suffix_index.idx";
+    for (const auto kind : {learnings::suffix_index_kind::suffix_array, learnings::suffix_index_kind::fm_index})
+    {
+        const std::string name = kind == learnings::suffix_index_kind::suffix_array ? "suffix_array" : "fm_index";
+        learnings::suffix_index_options options;
+        options.kind = kind;
+        std::optional<learnings::suffix_index> built;
+        const double build_ns = bench::time_ns([&] { built.emplace(learnings::suffix_index::build(corpus, options)); });
+        bench::print_csv_row("suffix_index_build", name, corpus.size(), "ns_per_byte",
+                             build_ns / static_cast<double>(corpus.size()));
+        bench::print_csv_row("suffix_index_size", name, corpus.size(), "bytes_per_byte",
+                             static_cast<double>(built->size_bytes()) / static_cast<double>(corpus.size()));
+
+        if (auto saved = built->save(path); !saved)
+        {
+            std::print(stderr, "{}\n", saved.error());
+            return EXIT_FAILURE;
+        }
+        auto mapped = learnings::suffix_index::open(path);
+        if (!mapped)
+        {
+            std::print(stderr, "{}\n", mapped.error());
+            return EXIT_FAILURE;
+        }
+
+        for (const auto &[variant, index] : {std::pair<std::string, const learnings::suffix_index *>{name, &*built},
+                                            {name + "_mapped", &*mapped}})
+        {
+            std::size_t total = 0;
+            double ns = bench::time_ns([&] {
+                for (const auto &pattern : patterns)
+                {
+                    total += index->count(pattern);
+                }
+            });
+            bench::print_csv_row("suffix_index_query", variant + "/count", corpus.size(), "ns_per_query",
+                                 ns / queries);
+            ns = bench::time_ns([&] {
+                for (const auto &pattern : patterns)
+                {
+                    total += index->locate(pattern).size();
+                }
+            });
+            bench::print_csv_row("suffix_index_query", variant + "/locate", corpus.size(), "ns_per_query",
+                                 ns / queries);
+            bench::do_not_optimize(total);
+
+            for (std::size_t i = 0; i < scanned_patterns; ++i)
+            {
+                if (index->count(patterns[i]) != expected[i].size() || index->locate(patterns[i]) != expected[i])
+                {
+                    std::print(stderr, "{} disagrees with a scan for \"{}\"\n", variant, patterns[i]);
+                    ok = false;
+                }
+            }
+        }
+    }
+    std::filesystem::remove(path);
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,188 @@
+/**
+ * @file bench_value_indexed_flat_map.cpp
+ * @brief Value-range and top-k queries through `value_indexed_flat_map` against linear scans.
+ *
+ * The map holds person ids and birth days spread over a century. Range
+ * queries of one day, one month and one year are answered from the index and
+ * by scanning, both as a structured-binding loop over the map and as a loop
+ * over the value column alone. The cost of keeping the index in step with
+ * inserts and erases is measured too. Results must agree.
+ *
+ * Usage: `bench_value_indexed_flat_map [size]` (default 10'000'000).
+ */
+
+#include "bench_common.hpp"
+#include "flat_map_bulk.hpp"
+#include "value_indexed_flat_map.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <flat_map>
+#include <functional>
+#include <print>
+#include <queue>
+#include <random>
+#include <vector>
+
+namespace
+{
+    using id_map = std::flat_map<std::uint64_t, int>;
+
+    constexpr int days_per_century = 36'525;
+    constexpr int queries = 100;
+    constexpr std::size_t top_k = 10;
+    constexpr int updates = 100;
+} // namespace
+
+int main(int argc, char **argv)
+{
+    const std::size_t n = bench::max_size_arg(argc, argv, 10'000'000);
+
+    std::mt19937_64 rng(17);
+    std::uniform_int_distribution<int> birth_day(0, days_per_century - 1);
+    learnings::flat_map_bulk_loader<std::uint64_t, int> loader;
+    loader.reserve(n);
+    for (std::size_t i = 0; i < n; ++i)
+    {
+        loader.add(rng(), birth_day(rng));
+    }
+    learnings::value_indexed_flat_map<std::uint64_t, int> people(std::move(loader).build());
+    const id_map &map = people.map();
+
+    bench::print_csv_header();
+    bool ok = true;
+    for (const int width : {1, 30, 365})
+    {
+        std::vector<int> starts(queries);
+        for (int &start : starts)
+        {
+            start = birth_day(rng);
+        }
+        const std::string variant = "width_" + std::to_string(width);
+
+        std::vector<long> expected;
+        double ns = bench::time_ns([&] {
+            for (const int lo : starts)
+            {
+                long sum = 0;
+                for (const auto &[id, day] : map)
+                {
+                    if (day >= lo && day <= lo + width - 1)
+                    {
+                        sum += static_cast<long>(id & 0xff);
+                    }
+                }
+                expected.push_back(sum);
+            }
+        });
+        bench::print_csv_row("range_query/scan_map", variant, n, "us_per_query", ns / 1e3 / queries);
+
+        std::vector<long> column_sums;
+        ns = bench::time_ns([&] {
+            const auto &ids = map.keys();
+            const auto &days = map.values();
+            for (const int lo : starts)
+            {
+                long sum = 0;
+                for (std::size_t i = 0; i < days.size(); ++i)
+                {
+                    sum += days[i] >= lo && days[i] <= lo + width - 1 ? static_cast<long>(ids[i] & 0xff) : 0;
+                }
+                column_sums.push_back(sum);
+            }
+        });
+        bench::print_csv_row("range_query/scan_column", variant, n, "us_per_query", ns / 1e3 / queries);
+
+        std::vector<long> index_sums;
+        ns = bench::time_ns([&] {
+            for (const int lo : starts)
+            {
+                long sum = 0;
+                for (const auto it : people.values_between(lo, lo + width - 1))
+                {
+                    sum += static_cast<long>(it->first & 0xff);
+                }
+                index_sums.push_back(sum);
+            }
+        });
+        bench::print_csv_row("range_query/index", variant, n, "us_per_query", ns / 1e3 / queries);
+        ok = ok && column_sums == expected && index_sums == expected;
+    }
+
+    // Top-k oldest: a bounded heap over a scan against the head of the index.
+    std::vector<int> scan_top;
+    double ns = bench::time_ns([&] {
+        std::priority_queue<int, std::vector<int>, std::greater<>> heap;
+        for (const auto &[id, day] : map)
+        {
+            if (heap.size() < top_k)
+            {
+                heap.push(day);
+            }
+            else if (day > heap.top())
+            {
+                heap.pop();
+                heap.push(day);
+            }
+        }
+        for (; !heap.empty(); heap.pop())
+        {
+            scan_top.push_back(heap.top());
+        }
+        std::ranges::reverse(scan_top);
+    });
+    bench::print_csv_row("top_k/scan_map", "k_10", n, "us_per_query", ns / 1e3);
+
+    std::vector<int> index_top;
+    ns = bench::time_ns([&] {
+        for (const auto it : people.largest(top_k))
+        {
+            index_top.push_back(it->second);
+        }
+    });
+    bench::print_csv_row("top_k/index", "k_10", n, "us_per_query", ns / 1e3);
+    ok = ok && index_top == scan_top;
+
+    // Maintenance: the index shifts its positions on every insert and erase.
+    std::vector<std::uint64_t> new_ids(updates);
+    for (auto &id : new_ids)
+    {
+        id = rng();
+    }
+    id_map plain = map;
+    ns = bench::time_ns([&] {
+        for (const auto id : new_ids)
+        {
+            plain.insert_or_assign(id, birth_day(rng));
+        }
+        for (const auto id : new_ids)
+        {
+            plain.erase(id);
+        }
+    });
+    bench::print_csv_row("update/flat_map", "insert_erase", n, "us_per_update", ns / 1e3 / (2 * updates));
+
+    ns = bench::time_ns([&] {
+        for (const auto id : new_ids)
+        {
+            people.insert_or_assign(id, birth_day(rng));
+        }
+        for (const auto id : new_ids)
+        {
+            people.erase(id);
+        }
+    });
+    bench::print_csv_row("update/value_indexed_flat_map", "insert_erase", n, "us_per_update",
+                         ns / 1e3 / (2 * updates));
+    bench::print_csv_row("memory/value_indexed_flat_map", "index", n, "bytes_per_entry",
+                         static_cast<double>(people.index_bytes()) / n);
+    ok = ok && people.map() == plain && people.count_between(0, days_per_century) == n;
+
+    if (!ok)
+    {
+        std::print(stderr, "value index disagrees with a linear scan\n");
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,427 @@
+/**
+ * @file access_trace.hpp
+ * @brief Compile-time selected tracing of accessor calls, from nothing at all to a per-thread flight recorder.
+ *
+ * `MyClass::get_value` used to write to `std::cout` on every call, which puts
+ * a locked stream write on what is otherwise an inlined load. Accessors now
+ * call `Trace::record(object, kind)` for a policy chosen at compile time:
+ *  - `trace_none` records nothing and compiles away entirely;
+ *  - `trace_ring_buffer` appends to a ring owned by the calling thread, with
+ *    no locks and no shared cache lines: a timestamp and five stores. Each
+ *    ring keeps the last `trace_ring::capacity` events, and
+ *    `trace_ring_buffer::dump` writes all rings to a file that the
+ *    `trace_dump` tool prints. A thread's ring goes back to the registry
+ *    when the thread exits and is reused by the next new thread, so memory
+ *    grows with the number of threads alive at once, not with thread churn;
+ *  - `trace_iostream` keeps the old behaviour.
+ *
+ * The default policy comes from the `LEARNINGS_ACCESS_TRACE` macro, which
+ * CMake sets from the option of the same name (`none`, `ring_buffer` or
+ * `iostream`, the default).
+ *
+ * A dump may run while other threads keep recording. Every slot carries a
+ * sequence number that is written before and after its payload, as in a
+ * seqlock, so the reader drops any event that was overwritten while it was
+ * being copied instead of reporting a torn one.
+ */
+
+#pragma once
+
+#include "simd_dispatch.hpp"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <expected>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+// Nonzero, so that a misspelt value, which `#if` reads as 0, reaches the `#error` below.
+#define LEARNINGS_ACCESS_TRACE_NONE 1
+#define LEARNINGS_ACCESS_TRACE_RING_BUFFER 2
+#define LEARNINGS_ACCESS_TRACE_IOSTREAM 3
+
+#ifndef LEARNINGS_ACCESS_TRACE
+#define LEARNINGS_ACCESS_TRACE LEARNINGS_ACCESS_TRACE_IOSTREAM
+#endif
+
+namespace learnings
+{
+    /**
+     * @brief Which accessor overload was called.
+     */
+    enum class access_kind : std::uint32_t
+    {
+        const_ref,   ///< `get_value` on a const object.
+        mutable_ref, ///< `get_value` on a non-const lvalue.
+        rvalue,      ///< `get_value` on a non-const rvalue, which moves the payload out.
+    };
+
+    constexpr std::string_view to_string(access_kind kind) noexcept
+    {
+        switch (kind)
+        {
+        case access_kind::const_ref:
+            return "const ref";
+        case access_kind::mutable_ref:
+            return "non-const ref";
+        case access_kind::rvalue:
+            return "rvalue";
+        }
+        return "unknown";
+    }
+
+    /**
+     * @brief What an accessor needs from a tracing policy.
+     */
+    template <typename T>
+    concept access_trace_policy = requires(const void *object, access_kind kind) { T::record(object, kind); };
+
+    /**
+     * @brief One recorded access, as stored in dump files.
+     */
+    struct trace_event
+    {
+        std::uint64_t tick;   ///< `trace_clock::now()` at the access.
+        std::uint64_t object; ///< Address of the accessed object.
+        std::uint32_t thread; ///< Index of the recording thread's ring; rings of exited threads are reused.
+        access_kind kind;
+    };
+    static_assert(sizeof(trace_event) == 24);
+
+    /**
+     * @brief The timestamp source: the time-stamp counter on x86, `steady_clock` elsewhere.
+     */
+    struct trace_clock
+    {
+        static std::uint64_t now() noexcept
+        {
+#if LEARNINGS_SIMD_X86
+            return __rdtsc();
+#else
+            return static_cast<std::uint64_t>(std::chrono::steady_clock::now().time_since_epoch().count());
+#endif
+        }
+    };
+
+    /**
+     * @brief Fixed-size header of a trace dump file, followed by `count` `trace_event`s in tick order.
+     */
+    struct trace_file_header
+    {
+        static constexpr std::array<char, 8> expected_magic{'L', 'T', 'R', 'A', 'C', 'E', '\0', '\1'};
+        static constexpr std::uint32_t current_version = 1;
+
+        std::array<char, 8> magic;
+        std::uint32_t version;
+        std::uint32_t event_size; ///< `sizeof(trace_event)`.
+        std::uint64_t count;
+        double ticks_per_second; ///< Measured between the first ring's creation and the dump.
+    };
+    static_assert(sizeof(trace_file_header) == 32);
+
+    /**
+     * @brief The ring one thread records into; any thread may copy it out.
+     */
+    class trace_ring
+    {
+    public:
+        static constexpr std::size_t capacity = std::size_t{1} << 14; ///< Events kept per thread (512 KiB).
+
+        explicit trace_ring(std::uint32_t thread) : thread_(thread) {}
+
+        /**
+         * @brief Appends an event, overwriting the oldest once full. Owning thread only.
+         */
+        void push(const void *object, access_kind kind) noexcept
+        {
+            const std::uint64_t index = next_;
+            slot &s = slots_[index % capacity];
+            s.sequence.store(2 * index + 1, std::memory_order_relaxed); // Odd: being written.
+            std::atomic_thread_fence(std::memory_order_release);
+            s.tick.store(trace_clock::now(), std::memory_order_relaxed);
+            s.object.store(reinterpret_cast<std::uintptr_t>(object), std::memory_order_relaxed);
+            s.kind.store(static_cast<std::uint32_t>(kind), std::memory_order_relaxed);
+            s.sequence.store(2 * index + 2, std::memory_order_release);
+            next_ = index + 1;
+            published_.store(index + 1, std::memory_order_release);
+        }
+
+        /**
+         * @brief Appends the retained events that are intact, oldest first, to @p out.
+         */
+        void copy_to(std::vector<trace_event> &out) const
+        {
+            const std::uint64_t end = published_.load(std::memory_order_acquire);
+            for (std::uint64_t index = end - std::min<std::uint64_t>(end, capacity); index < end; ++index)
+            {
+                const slot &s = slots_[index % capacity];
+                const std::uint64_t before = s.sequence.load(std::memory_order_acquire);
+                if (before != 2 * index + 2)
+                {
+                    continue; // Already overwritten by a newer event.
+                }
+                const trace_event event{s.tick.load(std::memory_order_relaxed),
+                                        s.object.load(std::memory_order_relaxed), thread_,
+                                        static_cast<access_kind>(s.kind.load(std::memory_order_relaxed))};
+                std::atomic_thread_fence(std::memory_order_acquire);
+                if (s.sequence.load(std::memory_order_relaxed) == before)
+                {
+                    out.push_back(event);
+                }
+            }
+        }
+
+    private:
+        struct slot
+        {
+            std::atomic<std::uint64_t> sequence{0}; ///< `2 * index + 2` once event `index` is complete.
+            std::atomic<std::uint64_t> tick{0};
+            std::atomic<std::uintptr_t> object{0};
+            std::atomic<std::uint32_t> kind{0};
+        };
+
+        std::uint64_t next_ = 0; ///< Written and read by the owning thread only.
+        alignas(64) std::atomic<std::uint64_t> published_{0};
+        std::uint32_t thread_;
+        std::array<slot, capacity> slots_;
+    };
+
+    namespace detail
+    {
+        /**
+         * @brief Owns every ring, so that dumps keep the last events of exited threads until their ring is reused.
+         */
+        class trace_registry
+        {
+        public:
+            static trace_registry &instance()
+            {
+                static trace_registry registry;
+                return registry;
+            }
+
+            /**
+             * @brief Hands a ring to a new thread: one released by an exited thread, or a new one.
+             * @throws std::bad_alloc if a new ring cannot be allocated.
+             */
+            trace_ring *acquire_ring()
+            {
+                const std::lock_guard lock(mutex_); // Once per thread, never on the recording path.
+                if (!free_.empty())
+                {
+                    trace_ring *const ring = free_.back();
+                    free_.pop_back();
+                    return ring; // Its events stay in dumps until the new owner overwrites them.
+                }
+                free_.reserve(rings_.size() + 1); // So that release_ring cannot fail.
+                rings_.push_back(std::make_unique<trace_ring>(static_cast<std::uint32_t>(rings_.size())));
+                return rings_.back().get();
+            }
+
+            void release_ring(trace_ring *ring) noexcept
+            {
+                const std::lock_guard lock(mutex_);
+                free_.push_back(ring);
+            }
+
+            std::vector<trace_event> snapshot() const
+            {
+                std::vector<trace_event> events;
+                {
+                    const std::lock_guard lock(mutex_);
+                    for (const auto &ring : rings_)
+                    {
+                        ring->copy_to(events);
+                    }
+                }
+                std::ranges::stable_sort(events, {}, &trace_event::tick);
+                return events;
+            }
+
+            double ticks_per_second() const
+            {
+                const auto elapsed = std::chrono::steady_clock::now() - start_time_;
+                const double seconds = std::chrono::duration<double>(elapsed).count();
+                return seconds > 0 ? static_cast<double>(trace_clock::now() - start_tick_) / seconds : 0.0;
+            }
+
+        private:
+            trace_registry() = default;
+
+            mutable std::mutex mutex_;
+            std::vector<std::unique_ptr<trace_ring>> rings_; ///< As many as threads have recorded at once.
+            std::vector<trace_ring *> free_;
+            std::chrono::steady_clock::time_point start_time_ = std::chrono::steady_clock::now();
+            std::uint64_t start_tick_ = trace_clock::now();
+        };
+
+        // Constant-initialised, so the recording path reads them without a TLS initialiser guard.
+        inline thread_local constinit trace_ring *thread_ring = nullptr;
+        inline thread_local constinit bool thread_ring_released = false;
+
+        /**
+         * @brief Owns the calling thread's ring and returns it to the registry when the thread exits.
+         */
+        struct trace_ring_lease
+        {
+            trace_ring *ring = trace_registry::instance().acquire_ring();
+
+            trace_ring_lease() = default;
+            trace_ring_lease(const trace_ring_lease &) = delete;
+            trace_ring_lease &operator=(const trace_ring_lease &) = delete;
+
+            ~trace_ring_lease()
+            {
+                thread_ring = nullptr;
+                thread_ring_released = true; // Accesses from later thread_local destructors are not recorded.
+                trace_registry::instance().release_ring(ring);
+            }
+        };
+
+        /**
+         * @brief The calling thread's ring, or null if it could not be allocated or was already released.
+         */
+        inline trace_ring *this_thread_ring() noexcept
+        {
+            if (thread_ring == nullptr && !thread_ring_released) [[unlikely]]
+            {
+                try
+                {
+                    static thread_local const trace_ring_lease lease;
+                    thread_ring = lease.ring;
+                }
+                catch (const std::bad_alloc &)
+                {
+                    return nullptr; // Accessors must not fail; this access goes unrecorded.
+                }
+            }
+            return thread_ring;
+        }
+    } // namespace detail
+
+    /**
+     * @brief Records nothing; accessors compile to a plain load.
+     */
+    struct trace_none
+    {
+        static constexpr void record(const void *, access_kind) noexcept {}
+    };
+
+    /**
+     * @brief Records into the calling thread's `trace_ring`.
+     */
+    struct trace_ring_buffer
+    {
+        /**
+         * @brief Appends to the calling thread's ring. Drops the event if the ring cannot be allocated.
+         */
+        static void record(const void *object, access_kind kind) noexcept
+        {
+            if (trace_ring *const ring = detail::this_thread_ring()) [[likely]]
+            {
+                ring->push(object, kind);
+            }
+        }
+
+        /**
+         * @brief The events currently retained by all rings, in tick order.
+         */
+        static std::vector<trace_event> snapshot() { return detail::trace_registry::instance().snapshot(); }
+
+        /**
+         * @brief Writes `snapshot()` to @p path for `trace_dump`.
+         * @return The number of events written, or an error message.
+         */
+        static std::expected<std::size_t, std::string> dump(const std::filesystem::path &path)
+        {
+            const std::vector<trace_event> events = snapshot();
+            trace_file_header header{};
+            header.magic = trace_file_header::expected_magic;
+            header.version = trace_file_header::current_version;
+            header.event_size = sizeof(trace_event);
+            header.count = events.size();
+            header.ticks_per_second = detail::trace_registry::instance().ticks_per_second();
+
+            std::ofstream out(path, std::ios::binary | std::ios::trunc);
+            if (!out)
+            {
+                return std::unexpected("cannot create " + path.string());
+            }
+            out.write(reinterpret_cast<const char *>(&header), sizeof(header));
+            out.write(reinterpret_cast<const char *>(events.data()),
+                      static_cast<std::streamsize>(events.size() * sizeof(trace_event)));
+            out.close();
+            if (!out)
+            {
+                return std::unexpected("write failed for " + path.string());
+            }
+            return events.size();
+        }
+    };
+
+    /**
+     * @brief Writes the access kind to `std::cout`, as `MyClass` always used to.
+     */
+    struct trace_iostream
+    {
+        static void record(const void *, access_kind kind) { std::cout << '(' << to_string(kind) << ") "; }
+    };
+
+    /**
+     * @brief Reads a file written by `trace_ring_buffer::dump`.
+     * @return The header and the events, or a description of why the file was rejected.
+     */
+    inline std::expected<std::pair<trace_file_header, std::vector<trace_event>>, std::string> read_trace_file(
+        const std::filesystem::path &path)
+    {
+        std::ifstream in(path, std::ios::binary);
+        if (!in)
+        {
+            return std::unexpected("cannot open " + path.string());
+        }
+        trace_file_header header{};
+        if (!in.read(reinterpret_cast<char *>(&header), sizeof(header)) ||
+            header.magic != trace_file_header::expected_magic)
+        {
+            return std::unexpected(path.string() + ": not a trace file");
+        }
+        if (header.version != trace_file_header::current_version || header.event_size != sizeof(trace_event))
+        {
+            return std::unexpected(path.string() + ": unsupported version " + std::to_string(header.version));
+        }
+        std::error_code ec;
+        const auto size = std::filesystem::file_size(path, ec);
+        if (ec || (size - sizeof(header)) / sizeof(trace_event) < header.count)
+        {
+            return std::unexpected(path.string() + ": truncated");
+        }
+        std::vector<trace_event> events(header.count);
+        in.read(reinterpret_cast<char *>(events.data()),
+                static_cast<std::streamsize>(events.size() * sizeof(trace_event)));
+        return std::pair{header, std::move(events)};
+    }
+
+#if LEARNINGS_ACCESS_TRACE == LEARNINGS_ACCESS_TRACE_NONE
+    using default_access_trace = trace_none;
+#elif LEARNINGS_ACCESS_TRACE == LEARNINGS_ACCESS_TRACE_RING_BUFFER
+    using default_access_trace = trace_ring_buffer;
+#elif LEARNINGS_ACCESS_TRACE == LEARNINGS_ACCESS_TRACE_IOSTREAM
+    using default_access_trace = trace_iostream;
+#else
+#error "LEARNINGS_ACCESS_TRACE must be LEARNINGS_ACCESS_TRACE_NONE, _RING_BUFFER or _IOSTREAM"
+#endif
+    static_assert(access_trace_policy<default_access_trace>);
+} // namespace learnings
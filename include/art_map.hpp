@@ -0,0 +1,658 @@
+/**
+ * @file art_map.hpp
+ * @brief Adaptive radix tree (ART) keyed by strings, with prefix queries.
+ *
+ * A radix tree walks a key one byte per level, so a lookup costs the key
+ * length rather than log2 n string comparisons, and "all names starting with
+ * 'Al'" is a descent to one subtree followed by an in-order walk of it. The
+ * adaptive variant sizes each inner node to its fan-out: Node4 and Node16 keep
+ * sorted key bytes (Node16 is searched with one SSE2 compare), Node48 maps
+ * bytes to 48 child slots, and Node256 indexes children directly. Chains of
+ * single-child nodes are collapsed into a per-node prefix.
+ *
+ * Reference: Leis, Kemper, Neumann, "The Adaptive Radix Tree: ARTful Indexing
+ * for Main-Memory Databases", ICDE 2013.
+ */
+
+#pragma once
+
+#include "heterogeneous_lookup.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <flat_map>
+#include <string>
+#include <string_view>
+#include <utility>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#endif
+
+namespace learnings
+{
+    /**
+     * @brief Ordered map from strings to @p T stored as an adaptive radix tree.
+     * @tparam T The mapped type.
+     * @details Iteration and prefix queries visit keys in the same order as
+     *          `std::flat_map<std::string, T>`. Keys that are prefixes of other
+     *          keys are stored as the inner node's terminal leaf.
+     */
+    template <typename T>
+    class art_map
+    {
+    public:
+        art_map() = default;
+
+        /**
+         * @brief Bulk-loads the entries of a finished map. O(total key bytes).
+         * @details Sorted input lets every node be built once at its final
+         *          size: a range's common prefix is that of its first and last
+         *          key, and its children are the runs of equal next bytes.
+         */
+        template <typename Compare>
+            requires lexicographic_string_order<Compare>
+        explicit art_map(const std::flat_map<std::string, T, Compare> &source)
+        {
+            size_ = source.size();
+            if (size_ != 0)
+            {
+                root_ = build(source.keys(), source.values(), 0, source.size(), 0);
+            }
+        }
+
+        art_map(art_map &&other) noexcept
+            : root_(std::exchange(other.root_, nullptr)), size_(std::exchange(other.size_, 0))
+        {
+        }
+
+        art_map &operator=(art_map &&other) noexcept
+        {
+            std::swap(root_, other.root_);
+            std::swap(size_, other.size_);
+            return *this;
+        }
+
+        art_map(const art_map &) = delete;
+        art_map &operator=(const art_map &) = delete;
+
+        ~art_map() { destroy(root_); }
+
+        std::size_t size() const noexcept { return size_; }
+
+        /**
+         * @brief Returns a pointer to the value for @p key, or nullptr. O(key length).
+         */
+        const T *find(std::string_view key) const noexcept
+        {
+            const node *n = root_;
+            std::size_t depth = 0;
+            while (n != nullptr)
+            {
+                if (n->type == kind::leaf)
+                {
+                    const auto *l = static_cast<const leaf *>(n);
+                    return l->key == key ? &l->value : nullptr;
+                }
+                const auto *in = static_cast<const inner *>(n);
+                const std::string_view prefix = in->prefix;
+                if (key.substr(depth, prefix.size()) != prefix)
+                {
+                    return nullptr;
+                }
+                depth += prefix.size();
+                if (depth == key.size())
+                {
+                    return in->terminal != nullptr ? &in->terminal->value : nullptr;
+                }
+                node *const *slot = find_child(in, static_cast<std::uint8_t>(key[depth]));
+                n = slot != nullptr ? *slot : nullptr;
+                ++depth;
+            }
+            return nullptr;
+        }
+
+        bool contains(std::string_view key) const noexcept { return find(key) != nullptr; }
+
+        /**
+         * @brief Inserts @p key or overwrites its value. O(key length) plus node growth.
+         */
+        void insert_or_assign(std::string_view key, T value)
+        {
+            node **slot = &root_;
+            std::size_t depth = 0;
+            while (true)
+            {
+                node *n = *slot;
+                if (n == nullptr)
+                {
+                    *slot = new leaf(std::string(key), std::move(value));
+                    ++size_;
+                    return;
+                }
+                if (n->type == kind::leaf)
+                {
+                    auto *l = static_cast<leaf *>(n);
+                    if (l->key == key)
+                    {
+                        l->value = std::move(value);
+                        return;
+                    }
+                    // Two leaves: split at their common prefix below `depth`.
+                    const std::string_view existing = l->key;
+                    std::size_t common = 0;
+                    while (depth + common < key.size() && depth + common < existing.size() &&
+                           key[depth + common] == existing[depth + common])
+                    {
+                        ++common;
+                    }
+                    auto *split = new node4(std::string(key.substr(depth, common)));
+                    attach(split, existing, depth + common, l);
+                    attach(split, key, depth + common, new leaf(std::string(key), std::move(value)));
+                    *slot = split;
+                    ++size_;
+                    return;
+                }
+
+                auto *in = static_cast<inner *>(n);
+                const std::string_view prefix = in->prefix;
+                std::size_t common = 0;
+                while (common < prefix.size() && depth + common < key.size() && key[depth + common] == prefix[common])
+                {
+                    ++common;
+                }
+                if (common < prefix.size())
+                {
+                    // The key leaves the compressed path: split the path at `common`.
+                    auto *split = new node4(std::string(prefix.substr(0, common)));
+                    const auto byte = static_cast<std::uint8_t>(prefix[common]);
+                    in->prefix.erase(0, common + 1);
+                    add_child(split, byte, in);
+                    attach(split, key, depth + common, new leaf(std::string(key), std::move(value)));
+                    *slot = split;
+                    ++size_;
+                    return;
+                }
+                depth += prefix.size();
+                if (depth == key.size())
+                {
+                    if (in->terminal != nullptr)
+                    {
+                        in->terminal->value = std::move(value);
+                    }
+                    else
+                    {
+                        in->terminal = new leaf(std::string(key), std::move(value));
+                        ++size_;
+                    }
+                    return;
+                }
+                const auto byte = static_cast<std::uint8_t>(key[depth]);
+                node **child = find_child(in, byte);
+                if (child == nullptr)
+                {
+                    add_child(slot, byte, new leaf(std::string(key), std::move(value)));
+                    ++size_;
+                    return;
+                }
+                slot = child;
+                ++depth;
+            }
+        }
+
+        /**
+         * @brief Calls @p fn(key, value) for every entry, in key order.
+         */
+        template <typename F>
+        void for_each(F &&fn) const
+        {
+            visit(root_, fn);
+        }
+
+        /**
+         * @brief Calls @p fn(key, value) for every key starting with @p prefix, in key order.
+         * @details Descends to the subtree covering @p prefix in O(prefix
+         *          length), then walks it; no string comparisons are made
+         *          inside the subtree.
+         */
+        template <typename F>
+        void for_each_with_prefix(std::string_view prefix, F &&fn) const
+        {
+            const node *n = root_;
+            std::size_t depth = 0;
+            while (n != nullptr)
+            {
+                if (n->type == kind::leaf)
+                {
+                    const auto *l = static_cast<const leaf *>(n);
+                    if (std::string_view(l->key).starts_with(prefix))
+                    {
+                        fn(std::string_view(l->key), std::as_const(l->value));
+                    }
+                    return;
+                }
+                const auto *in = static_cast<const inner *>(n);
+                const std::string_view rest = prefix.substr(depth);
+                const std::string_view path = in->prefix;
+                if (rest.size() <= path.size())
+                {
+                    if (path.starts_with(rest))
+                    {
+                        visit(n, fn); // Every key below extends the query.
+                    }
+                    return;
+                }
+                if (!rest.starts_with(path))
+                {
+                    return;
+                }
+                depth += path.size();
+                node *const *slot = find_child(in, static_cast<std::uint8_t>(prefix[depth]));
+                n = slot != nullptr ? *slot : nullptr;
+                ++depth;
+            }
+        }
+
+    private:
+        enum class kind : std::uint8_t
+        {
+            leaf,
+            node4,
+            node16,
+            node48,
+            node256
+        };
+
+        struct node
+        {
+            kind type;
+            explicit node(kind k) : type(k) {}
+        };
+
+        struct leaf : node
+        {
+            std::string key; ///< The whole key, so leaves can be verified and reported without a path.
+            T value;
+            leaf(std::string k, T v) : node(kind::leaf), key(std::move(k)), value(std::move(v)) {}
+        };
+
+        struct inner : node
+        {
+            std::uint16_t count = 0;
+            std::string prefix;       ///< Bytes shared by every key below, after the parent's edge byte.
+            leaf *terminal = nullptr; ///< The key that ends exactly at this node, if any.
+            inner(kind k, std::string p) : node(k), prefix(std::move(p)) {}
+        };
+
+        struct node4 : inner
+        {
+            std::uint8_t keys[4] = {};
+            node *children[4] = {};
+            explicit node4(std::string p) : inner(kind::node4, std::move(p)) {}
+        };
+
+        struct node16 : inner
+        {
+            alignas(16) std::uint8_t keys[16] = {};
+            node *children[16] = {};
+            explicit node16(std::string p) : inner(kind::node16, std::move(p)) {}
+        };
+
+        struct node48 : inner
+        {
+            std::uint8_t index[256] = {}; ///< Child slot + 1 per byte; 0 means no child.
+            node *children[48] = {};
+            explicit node48(std::string p) : inner(kind::node48, std::move(p)) {}
+        };
+
+        struct node256 : inner
+        {
+            node *children[256] = {};
+            explicit node256(std::string p) : inner(kind::node256, std::move(p)) {}
+        };
+
+        /**
+         * @brief Returns the slot holding the child for @p byte, or nullptr.
+         */
+        static node **find_child(inner *in, std::uint8_t byte) noexcept
+        {
+            switch (in->type)
+            {
+            case kind::node4:
+            {
+                auto *n = static_cast<node4 *>(in);
+                for (unsigned i = 0; i < n->count; ++i)
+                {
+                    if (n->keys[i] == byte)
+                    {
+                        return &n->children[i];
+                    }
+                }
+                return nullptr;
+            }
+            case kind::node16:
+            {
+                auto *n = static_cast<node16 *>(in);
+#if defined(__SSE2__) || defined(_M_X64)
+                const __m128i keys = _mm_load_si128(reinterpret_cast<const __m128i *>(n->keys));
+                const __m128i hits = _mm_cmpeq_epi8(keys, _mm_set1_epi8(static_cast<char>(byte)));
+                const unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(hits)) & ((1u << n->count) - 1);
+                return mask != 0 ? &n->children[std::countr_zero(mask)] : nullptr;
+#else
+                for (unsigned i = 0; i < n->count; ++i)
+                {
+                    if (n->keys[i] == byte)
+                    {
+                        return &n->children[i];
+                    }
+                }
+                return nullptr;
+#endif
+            }
+            case kind::node48:
+            {
+                auto *n = static_cast<node48 *>(in);
+                return n->index[byte] != 0 ? &n->children[n->index[byte] - 1] : nullptr;
+            }
+            case kind::node256:
+            {
+                auto *n = static_cast<node256 *>(in);
+                return n->children[byte] != nullptr ? &n->children[byte] : nullptr;
+            }
+            default:
+                return nullptr;
+            }
+        }
+
+        static node *const *find_child(const inner *in, std::uint8_t byte) noexcept
+        {
+            return find_child(const_cast<inner *>(in), byte);
+        }
+
+        /**
+         * @brief Adds a child to a node that has room for it, keeping Node4/Node16 keys sorted.
+         */
+        static void add_child(inner *in, std::uint8_t byte, node *child) noexcept
+        {
+            auto insert_sorted = [&](std::uint8_t *keys, node **children) {
+                unsigned i = in->count;
+                for (; i > 0 && keys[i - 1] > byte; --i)
+                {
+                    keys[i] = keys[i - 1];
+                    children[i] = children[i - 1];
+                }
+                keys[i] = byte;
+                children[i] = child;
+            };
+            switch (in->type)
+            {
+            case kind::node4:
+                insert_sorted(static_cast<node4 *>(in)->keys, static_cast<node4 *>(in)->children);
+                break;
+            case kind::node16:
+                insert_sorted(static_cast<node16 *>(in)->keys, static_cast<node16 *>(in)->children);
+                break;
+            case kind::node48:
+            {
+                auto *n = static_cast<node48 *>(in);
+                n->children[n->count] = child;
+                n->index[byte] = static_cast<std::uint8_t>(n->count + 1);
+                break;
+            }
+            case kind::node256:
+                static_cast<node256 *>(in)->children[byte] = child;
+                break;
+            default:
+                break;
+            }
+            ++in->count;
+        }
+
+        static constexpr unsigned capacity(kind k) noexcept
+        {
+            return k == kind::node4 ? 4 : k == kind::node16 ? 16 : k == kind::node48 ? 48 : 256;
+        }
+
+        /**
+         * @brief Adds a child to the node in @p slot, first replacing it with the next larger kind if it is full.
+         */
+        static void add_child(node **slot, std::uint8_t byte, node *child)
+        {
+            auto *in = static_cast<inner *>(*slot);
+            if (in->count == capacity(in->type))
+            {
+                inner *grown = grow(in);
+                *slot = grown;
+                in = grown;
+            }
+            add_child(in, byte, child);
+        }
+
+        /**
+         * @brief Moves the children of a full node into a node of the next kind and frees the old one.
+         */
+        static inner *grow(inner *in)
+        {
+            inner *grown = nullptr;
+            switch (in->type)
+            {
+            case kind::node4:
+                grown = new node16(std::move(in->prefix));
+                break;
+            case kind::node16:
+                grown = new node48(std::move(in->prefix));
+                break;
+            default:
+                grown = new node256(std::move(in->prefix));
+                break;
+            }
+            grown->terminal = in->terminal;
+            for_each_child(in, [grown](std::uint8_t byte, node *child) { add_child(grown, byte, child); });
+            delete_shallow(in);
+            return grown;
+        }
+
+        /**
+         * @brief Calls @p fn(byte, child) for every child in byte order.
+         */
+        template <typename F>
+        static void for_each_child(const inner *in, F &&fn)
+        {
+            switch (in->type)
+            {
+            case kind::node4:
+            {
+                const auto *n = static_cast<const node4 *>(in);
+                for (unsigned i = 0; i < n->count; ++i)
+                {
+                    fn(n->keys[i], n->children[i]);
+                }
+                break;
+            }
+            case kind::node16:
+            {
+                const auto *n = static_cast<const node16 *>(in);
+                for (unsigned i = 0; i < n->count; ++i)
+                {
+                    fn(n->keys[i], n->children[i]);
+                }
+                break;
+            }
+            case kind::node48:
+            {
+                const auto *n = static_cast<const node48 *>(in);
+                for (unsigned byte = 0; byte < 256; ++byte)
+                {
+                    if (n->index[byte] != 0)
+                    {
+                        fn(static_cast<std::uint8_t>(byte), n->children[n->index[byte] - 1]);
+                    }
+                }
+                break;
+            }
+            case kind::node256:
+            {
+                const auto *n = static_cast<const node256 *>(in);
+                for (unsigned byte = 0; byte < 256; ++byte)
+                {
+                    if (n->children[byte] != nullptr)
+                    {
+                        fn(static_cast<std::uint8_t>(byte), n->children[byte]);
+                    }
+                }
+                break;
+            }
+            default:
+                break;
+            }
+        }
+
+        /**
+         * @brief Hangs @p child under @p parent for @p key at @p depth: as an edge, or as the terminal if the key ends.
+         */
+        static void attach(inner *parent, std::string_view key, std::size_t depth, node *child)
+        {
+            if (depth == key.size())
+            {
+                parent->terminal = static_cast<leaf *>(child);
+            }
+            else
+            {
+                add_child(parent, static_cast<std::uint8_t>(key[depth]), child);
+            }
+        }
+
+        /**
+         * @brief Builds the subtree for sorted keys [@p lo, @p hi), all sharing their first @p depth bytes.
+         */
+        template <typename Keys, typename Values>
+        static node *build(const Keys &keys, const Values &values, std::size_t lo, std::size_t hi, std::size_t depth)
+        {
+            if (hi - lo == 1)
+            {
+                return new leaf(keys[lo], values[lo]);
+            }
+            const std::string_view first = keys[lo];
+            const std::string_view last = keys[hi - 1];
+            std::size_t common = 0;
+            while (depth + common < first.size() && depth + common < last.size() &&
+                   first[depth + common] == last[depth + common])
+            {
+                ++common;
+            }
+            const std::size_t next = depth + common;
+
+            // Count the runs of equal next bytes to pick the node size up front.
+            std::size_t begin = lo;
+            leaf *terminal = nullptr;
+            if (first.size() == next)
+            {
+                terminal = new leaf(keys[lo], values[lo]); // Sorts first: it is a prefix of the rest.
+                ++begin;
+            }
+            unsigned runs = 0;
+            for (std::size_t i = begin; i < hi; ++i)
+            {
+                runs += i == begin || keys[i][next] != keys[i - 1][next];
+            }
+            inner *in = nullptr;
+            std::string prefix(first.substr(depth, common));
+            if (runs <= 4)
+            {
+                in = new node4(std::move(prefix));
+            }
+            else if (runs <= 16)
+            {
+                in = new node16(std::move(prefix));
+            }
+            else if (runs <= 48)
+            {
+                in = new node48(std::move(prefix));
+            }
+            else
+            {
+                in = new node256(std::move(prefix));
+            }
+            in->terminal = terminal;
+
+            for (std::size_t i = begin; i < hi;)
+            {
+                const char byte = keys[i][next];
+                std::size_t j = i + 1;
+                while (j < hi && keys[j][next] == byte)
+                {
+                    ++j;
+                }
+                add_child(in, static_cast<std::uint8_t>(byte), build(keys, values, i, j, next + 1));
+                i = j;
+            }
+            return in;
+        }
+
+        template <typename F>
+        static void visit(const node *n, F &fn)
+        {
+            if (n == nullptr)
+            {
+                return;
+            }
+            if (n->type == kind::leaf)
+            {
+                const auto *l = static_cast<const leaf *>(n);
+                fn(std::string_view(l->key), std::as_const(l->value));
+                return;
+            }
+            const auto *in = static_cast<const inner *>(n);
+            if (in->terminal != nullptr)
+            {
+                fn(std::string_view(in->terminal->key), std::as_const(in->terminal->value));
+            }
+            for_each_child(in, [&fn](std::uint8_t, const node *child) { visit(child, fn); });
+        }
+
+        /**
+         * @brief Frees an inner node without its children or terminal.
+         */
+        static void delete_shallow(inner *in) noexcept
+        {
+            switch (in->type)
+            {
+            case kind::node4:
+                delete static_cast<node4 *>(in);
+                break;
+            case kind::node16:
+                delete static_cast<node16 *>(in);
+                break;
+            case kind::node48:
+                delete static_cast<node48 *>(in);
+                break;
+            default:
+                delete static_cast<node256 *>(in);
+                break;
+            }
+        }
+
+        static void destroy(node *n) noexcept
+        {
+            if (n == nullptr)
+            {
+                return;
+            }
+            if (n->type == kind::leaf)
+            {
+                delete static_cast<leaf *>(n);
+                return;
+            }
+            auto *in = static_cast<inner *>(n);
+            delete in->terminal;
+            for_each_child(in, [](std::uint8_t, node *child) { destroy(child); });
+            delete_shallow(in);
+        }
+
+        node *root_ = nullptr;
+        std::size_t size_ = 0;
+    };
+} // namespace learnings
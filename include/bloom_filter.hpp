@@ -0,0 +1,205 @@
+/**
+ * @file bloom_filter.hpp
+ * @brief Cache-blocked Bloom filter and a flat_map fronted by one.
+ *
+ * When most lookups are misses, a `std::flat_map` spends a full binary search
+ * (about log2 n cache misses) to say "no". A Bloom filter answers "definitely
+ * absent" for most of those keys after touching memory once. In this blocked
+ * variant all bits of a key live in one 64-byte block, so a probe is a single
+ * cache line; the price is a slightly higher false-positive rate for the same
+ * memory, which the sizing below compensates for.
+ */
+
+#pragma once
+
+#include "heterogeneous_lookup.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <flat_map>
+#include <functional>
+#include <numbers>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace learnings
+{
+    /**
+     * @brief Bloom filter whose bits for one key share a 512-bit block.
+     * @tparam Hash Hash for the inserted keys; its output is remixed, so an
+     *              identity hash such as `std::hash<int>` is fine.
+     */
+    template <typename Hash>
+    class blocked_bloom_filter
+    {
+    public:
+        static constexpr std::size_t block_bits = 512;
+
+        blocked_bloom_filter() = default;
+
+        /**
+         * @brief Sizes the filter for @p expected_keys at a false-positive rate of about @p false_positive_rate.
+         * @details An unblocked filter needs `-log2(p) / ln 2` bits per key.
+         *          Blocking skews the load across blocks, so a third more bits
+         *          is budgeted, which keeps the blocked rate close to target for
+         *          the 0.1%-5% range this is meant for.
+         */
+        explicit blocked_bloom_filter(std::size_t expected_keys, double false_positive_rate = 0.01,
+                                      Hash hash = Hash())
+            : hash_(std::move(hash))
+        {
+            const double p = std::clamp(false_positive_rate, 1e-6, 0.5);
+            const double bits_per_key = -std::log2(p) / std::numbers::ln2 * 4.0 / 3.0;
+            hashes_ = static_cast<unsigned>(std::clamp(std::lround(-std::log2(p)), 1L, 16L));
+            const double keys = static_cast<double>(std::max<std::size_t>(expected_keys, 1));
+            const auto bits = static_cast<std::size_t>(bits_per_key * keys);
+            blocks_.resize(std::max<std::size_t>((bits + block_bits - 1) / block_bits, 1));
+        }
+
+        /**
+         * @brief Adds @p key.
+         */
+        template <typename K>
+        void insert(const K &key) noexcept
+        {
+            const std::uint64_t h = mix(hash_(key));
+            block &b = blocks_[block_of(h)];
+            for_each_bit(h, [&b](unsigned bit) { b.words[bit / 64] |= std::uint64_t{1} << (bit % 64); });
+        }
+
+        /**
+         * @brief Returns false only if @p key was never inserted.
+         */
+        template <typename K>
+        bool may_contain(const K &key) const noexcept
+        {
+            const std::uint64_t h = mix(hash_(key));
+            const block &b = blocks_[block_of(h)];
+            std::uint64_t missing = 0;
+            for_each_bit(h, [&](unsigned bit) { missing |= ~b.words[bit / 64] & (std::uint64_t{1} << (bit % 64)); });
+            return missing == 0;
+        }
+
+        /**
+         * @brief Returns the heap bytes owned by the filter.
+         */
+        std::size_t memory_bytes() const noexcept { return blocks_.capacity() * sizeof(block); }
+
+        unsigned hash_count() const noexcept { return hashes_; }
+
+    private:
+        struct alignas(64) block
+        {
+            std::array<std::uint64_t, block_bits / 64> words{};
+        };
+
+        /// Spreads weak hashes (such as identity) over all 64 bits.
+        static std::uint64_t mix(std::uint64_t h) noexcept
+        {
+            h ^= h >> 33;
+            h *= 0xff51afd7ed558ccdull;
+            h ^= h >> 33;
+            h *= 0xc4ceb9fe1a85ec53ull;
+            h ^= h >> 33;
+            return h;
+        }
+
+        /// Maps the high 32 bits onto [0, blocks) with a multiply instead of a modulo.
+        std::size_t block_of(std::uint64_t h) const noexcept
+        {
+            return static_cast<std::size_t>(((h >> 32) * blocks_.size()) >> 32);
+        }
+
+        /**
+         * @brief Calls @p fn with the @p hashes_ bit positions of a key, derived by double hashing the low half.
+         */
+        template <typename F>
+        void for_each_bit(std::uint64_t h, F fn) const noexcept
+        {
+            const auto low = static_cast<std::uint32_t>(h);
+            const std::uint32_t step = (low >> 16) | 1;
+            std::uint32_t bit = low;
+            for (unsigned i = 0; i < hashes_; ++i)
+            {
+                fn(bit % block_bits);
+                bit += step;
+            }
+        }
+
+        std::vector<block> blocks_;
+        unsigned hashes_ = 1;
+        [[no_unique_address]] Hash hash_;
+    };
+
+    /**
+     * @brief A read-only `std::flat_map` that rejects most absent keys with a Bloom filter.
+     *
+     * @tparam Key     The key type.
+     * @tparam T       The mapped type.
+     * @tparam Compare The key ordering.
+     * @tparam Hash    Hash used by the filter; for string keys use
+     *                 `string_hash`, which also accepts `std::string_view`.
+     */
+    template <typename Key, typename T, typename Compare = std::less<Key>,
+              typename Hash = std::conditional_t<std::is_same_v<Key, std::string>, string_hash, std::hash<Key>>>
+    class bloom_filtered_map
+    {
+    public:
+        using map_type = std::flat_map<Key, T, Compare>;
+        using const_iterator = typename map_type::const_iterator;
+
+        /**
+         * @brief Adopts @p map and builds a filter for its keys. O(n).
+         */
+        explicit bloom_filtered_map(map_type map, double false_positive_rate = 0.01)
+            : map_(std::move(map)), filter_(map_.size(), false_positive_rate)
+        {
+            for (const auto &key : map_.keys())
+            {
+                filter_.insert(key);
+            }
+        }
+
+        const map_type &map() const noexcept { return map_; }
+        const blocked_bloom_filter<Hash> &filter() const noexcept { return filter_; }
+        std::size_t size() const noexcept { return map_.size(); }
+        const_iterator begin() const noexcept { return map_.begin(); }
+        const_iterator end() const noexcept { return map_.end(); }
+
+        /**
+         * @brief Finds @p key; a filtered-out key costs one cache line instead of a binary search.
+         */
+        template <typename K>
+        const_iterator find(const K &key) const
+        {
+            if (!filter_.may_contain(key))
+            {
+                return map_.end();
+            }
+            if constexpr (std::is_same_v<Key, std::string> && lexicographic_string_order<Compare>)
+            { // Probe with a string_view so that a miss never allocates.
+                return learnings::find(map_, std::string_view(key));
+            }
+            else
+            {
+                return map_.find(key);
+            }
+        }
+
+        template <typename K>
+        bool contains(const K &key) const
+        {
+            return find(key) != map_.end();
+        }
+
+    private:
+        map_type map_;
+        blocked_bloom_filter<Hash> filter_;
+    };
+} // namespace learnings
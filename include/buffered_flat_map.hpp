@@ -0,0 +1,231 @@
+/**
+ * @file buffered_flat_map.hpp
+ * @brief Insert-friendly `std::flat_map` with an LSM-style write buffer.
+ *
+ * A single insert into a `std::flat_map` shifts on average half of both
+ * containers, so a stream of inserts is quadratic. `buffered_flat_map` sends
+ * writes to a small hash-table buffer instead (erasures become tombstones)
+ * and folds the buffer into the sorted map with one linear `apply_updates`
+ * merge whenever it grows past a fixed fraction of the map. Every element is
+ * therefore copied O(ratio) times in total, keeping inserts amortised O(1)
+ * plus the sort of the batch, while the map itself stays contiguous for
+ * iteration. Merges build a new map and install it only on success, so an
+ * exception during a merge (`bad_alloc`, a throwing copy) loses no entries.
+ */
+
+#pragma once
+
+#include "flat_map_bulk.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <flat_map>
+#include <functional>
+#include <future>
+#include <optional>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace learnings
+{
+    /**
+     * @brief Where `buffered_flat_map` runs its merges.
+     */
+    enum class merge_mode
+    {
+        inline_merge, ///< The write that fills the buffer performs the merge.
+        background    ///< The full buffer is frozen and merged into a copy of the map on another thread.
+    };
+
+    /**
+     * @brief A `std::flat_map` fronted by a hash-table write buffer.
+     *
+     * @tparam Key      The key type.
+     * @tparam T        The mapped type.
+     * @tparam Compare  The ordering of the main map.
+     * @tparam Hash     The buffer's hash; must agree with `Compare` on key equivalence.
+     * @tparam KeyEqual The buffer's key equality.
+     * @details Not thread-safe: one thread owns the container. In background
+     *          mode the helper thread only reads the main map and the frozen
+     *          buffer, and its result is installed by the owning thread.
+     */
+    template <typename Key, typename T, typename Compare = std::less<Key>, typename Hash = std::hash<Key>,
+              typename KeyEqual = std::equal_to<Key>>
+    class buffered_flat_map
+    {
+    public:
+        using map_type = std::flat_map<Key, T, Compare>;
+        using const_iterator = typename map_type::const_iterator;
+
+        /// Smallest buffer worth merging; below it the merge overhead dominates.
+        static constexpr std::size_t min_buffer_size = 1024;
+
+        /**
+         * @brief Wraps @p initial.
+         * @param initial      The starting contents.
+         * @param mode         Whether merges run inline or in the background.
+         * @param buffer_ratio The buffer is merged once it holds more than
+         *                     `size / buffer_ratio` updates.
+         */
+        explicit buffered_flat_map(map_type initial = map_type(), merge_mode mode = merge_mode::inline_merge,
+                                   std::size_t buffer_ratio = 8)
+            : main_(std::move(initial)), mode_(mode), buffer_ratio_(std::max<std::size_t>(buffer_ratio, 1))
+        {
+        }
+
+        buffered_flat_map(const buffered_flat_map &) = delete;
+        buffered_flat_map &operator=(const buffered_flat_map &) = delete;
+
+        /**
+         * @brief Inserts @p key or overwrites its value. Amortised O(1) plus batch sorting.
+         */
+        void insert_or_assign(Key key, T value)
+        {
+            buffer_.insert_or_assign(std::move(key), std::optional<T>(std::move(value)));
+            maybe_merge();
+        }
+
+        /**
+         * @brief Erases @p key by recording a tombstone.
+         */
+        void erase(Key key)
+        {
+            buffer_.insert_or_assign(std::move(key), std::nullopt);
+            maybe_merge();
+        }
+
+        /**
+         * @brief Returns a pointer to the value for @p key, or nullptr.
+         * @details Checks the buffer, then a frozen buffer being merged, then
+         *          the main map; the first level that knows the key decides.
+         *          The pointer is invalidated by the next write.
+         */
+        const T *find(const Key &key) const
+        {
+            for (const buffer_type *level : {&buffer_, &frozen_})
+            {
+                if (const auto it = level->find(key); it != level->end())
+                {
+                    return it->second ? &*it->second : nullptr;
+                }
+            }
+            const auto it = main_.find(key);
+            return it == main_.end() ? nullptr : &it->second;
+        }
+
+        bool contains(const Key &key) const { return find(key) != nullptr; }
+
+        /**
+         * @brief Returns the number of updates not yet merged into the main map.
+         */
+        std::size_t pending() const noexcept { return buffer_.size() + frozen_.size(); }
+
+        /**
+         * @brief Merges every pending update, waiting for a background merge if one runs.
+         */
+        void flush()
+        {
+            finish_background_merge();
+            if (!buffer_.empty())
+            {
+                merge_buffer();
+            }
+        }
+
+        /**
+         * @brief Flushes and returns the main map, which then holds every entry.
+         */
+        const map_type &map()
+        {
+            flush();
+            return main_;
+        }
+
+        /**
+         * @brief Flushes and returns the number of entries.
+         */
+        std::size_t size() { return map().size(); }
+
+        /**
+         * @brief Flushes, then iterates the contiguous main map in key order.
+         */
+        const_iterator begin() { return map().begin(); }
+        const_iterator end() { return map().end(); }
+
+    private:
+        using buffer_type = std::unordered_map<Key, std::optional<T>, Hash, KeyEqual>;
+        using update_list = std::vector<std::pair<Key, std::optional<T>>>;
+
+        std::size_t buffer_limit() const noexcept
+        {
+            return std::max(min_buffer_size, main_.size() / buffer_ratio_);
+        }
+
+        static update_list copy_updates(const buffer_type &buffer)
+        {
+            update_list updates;
+            updates.reserve(buffer.size());
+            for (const auto &[key, value] : buffer)
+            {
+                updates.emplace_back(key, value);
+            }
+            return updates;
+        }
+
+        /**
+         * @brief Merges the buffer into a copy of the main map, then installs the copy.
+         * @details Strong guarantee: `apply_updates` empties its map if it
+         *          throws, so it never runs on `main_` or consumes the buffer.
+         */
+        void merge_buffer()
+        {
+            map_type next = main_;
+            apply_updates(next, copy_updates(buffer_));
+            main_ = std::move(next);
+            buffer_.clear();
+        }
+
+        void maybe_merge()
+        {
+            if (merging_.valid() && merging_.wait_for(std::chrono::seconds(0)) == std::future_status::ready)
+            {
+                finish_background_merge();
+            }
+            if (buffer_.size() <= buffer_limit())
+            {
+                return;
+            }
+            if (mode_ == merge_mode::inline_merge)
+            {
+                merge_buffer();
+                return;
+            }
+
+            finish_background_merge(); // Back-pressure: at most one merge in flight.
+            frozen_ = std::exchange(buffer_, {});
+            merging_ = std::async(std::launch::async, [this] {
+                map_type next = main_;
+                apply_updates(next, copy_updates(frozen_));
+                return next;
+            });
+        }
+
+        void finish_background_merge()
+        {
+            if (merging_.valid())
+            {
+                main_ = merging_.get();
+                frozen_.clear();
+            }
+        }
+
+        map_type main_;
+        buffer_type buffer_;
+        buffer_type frozen_;            ///< Being merged in the background; read-only until installed.
+        std::future<map_type> merging_; ///< In-flight merge; destroyed first, so it is joined before the maps go.
+        merge_mode mode_;
+        std::size_t buffer_ratio_;
+    };
+} // namespace learnings
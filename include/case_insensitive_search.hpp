@@ -0,0 +1,519 @@
+/**
+ * @file case_insensitive_search.hpp
+ * @brief Case-insensitive substring search without a lower-cased copy.
+ *
+ * Lower-casing a copy of the text before calling `contains` costs an
+ * allocation and a second pass over the text. These searches fold the text
+ * inside the SIMD registers instead, using the same first-and-last-byte filter
+ * as `simd_search.hpp`. For ASCII the fold is a single OR: when a needle byte
+ * is a letter, `x | 0x20` equals its lower-case form exactly when `x` is that
+ * letter in either case, so a fold costs one instruction per register.
+ *
+ * For UTF-8 the anchor bytes of a needle character are the bytes of all its
+ * case variants (`É` starts with the same lead byte as `é`; `Р` and `р` do
+ * not), at most three per anchor, and candidates are verified with the simple
+ * case folding of `utf8.hpp`. An all-ASCII needle takes the ASCII kernels even
+ * on UTF-8 text: no byte of a multi-byte sequence is ASCII, so a match can
+ * never start or end inside one. The UTF-8 kernel can also validate the text
+ * in the same pass, reusing each loaded register, so rejecting malformed
+ * input does not cost a second read of it.
+ */
+
+#pragma once
+
+#include "simd_dispatch.hpp"
+#include "simd_search.hpp"
+#include "utf8.hpp"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <expected>
+#include <string>
+#include <string_view>
+
+namespace learnings
+{
+    namespace detail
+    {
+        constexpr bool is_ascii_letter(char c) noexcept
+        {
+            return (c >= 'A' && c <= 'Z') || (c >= 'a' && c <= 'z');
+        }
+
+        constexpr char ascii_fold(char c) noexcept
+        {
+            return c >= 'A' && c <= 'Z' ? static_cast<char>(c + 0x20) : c;
+        }
+
+        constexpr bool ascii_iequal(const char *a, const char *b, std::size_t n) noexcept
+        {
+            for (std::size_t i = 0; i < n; ++i)
+            {
+                if (ascii_fold(a[i]) != ascii_fold(b[i]))
+                {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        /**
+         * @brief The ASCII filter: a text byte `x` matches an anchor when `(x | mask) == value`.
+         */
+        struct ascii_anchor
+        {
+            char value;
+            char mask;
+
+            explicit constexpr ascii_anchor(char c) noexcept
+                : value(ascii_fold(c)), mask(is_ascii_letter(c) ? char{0x20} : char{0})
+            {
+            }
+
+            constexpr bool matches(char x) const noexcept { return static_cast<char>(x | mask) == value; }
+        };
+
+        constexpr std::size_t find_icase_scalar(std::string_view haystack, std::string_view needle,
+                                                std::size_t from) noexcept
+        {
+            const ascii_anchor first(needle.front());
+            for (std::size_t i = from; i + needle.size() <= haystack.size(); ++i)
+            {
+                if (first.matches(haystack[i]) && ascii_iequal(haystack.data() + i + 1, needle.data() + 1,
+                                                               needle.size() - 1))
+                {
+                    return i;
+                }
+            }
+            return std::string_view::npos;
+        }
+
+#if LEARNINGS_SIMD_X86
+        /**
+         * @brief Like `verify_candidates` in simd_search.hpp, with an ASCII-folded middle.
+         */
+        template <typename Mask>
+        inline std::size_t verify_icase_candidates(const char *p, Mask mask, std::string_view needle) noexcept
+        {
+            const std::size_t middle = needle.size() < 2 ? 0 : needle.size() - 2;
+            while (mask != 0)
+            {
+                const int bit = std::countr_zero(mask);
+                if (ascii_iequal(p + bit + 1, needle.data() + 1, middle))
+                {
+                    return static_cast<std::size_t>(bit);
+                }
+                mask &= mask - 1;
+            }
+            return std::string_view::npos;
+        }
+
+        /**
+         * @brief The ASCII kernels need `haystack.size() >= needle.size() - 1 + register width` and scan
+         *        every start position: the last block is loaded overlapping the one before it, with the
+         *        positions already scanned masked off, so short lines need no scalar tail.
+         */
+        inline search_step find_icase_sse2(std::string_view haystack, std::string_view needle) noexcept
+        {
+            const std::size_t last = needle.size() - 1;
+            const ascii_anchor front(needle.front());
+            const ascii_anchor back(needle.back());
+            const __m128i first_value = _mm_set1_epi8(front.value);
+            const __m128i first_mask = _mm_set1_epi8(front.mask);
+            const __m128i last_value = _mm_set1_epi8(back.value);
+            const __m128i last_mask = _mm_set1_epi8(back.mask);
+            const std::size_t end = haystack.size() - last; // One past the last start position.
+            for (std::size_t i = 0; i < end; i += 16)
+            {
+                const std::size_t at = std::min(i, end - 16);
+                const char *p = haystack.data() + at;
+                const __m128i head = _mm_or_si128(_mm_loadu_si128(reinterpret_cast<const __m128i *>(p)), first_mask);
+                const __m128i tail =
+                    _mm_or_si128(_mm_loadu_si128(reinterpret_cast<const __m128i *>(p + last)), last_mask);
+                const __m128i both = _mm_and_si128(_mm_cmpeq_epi8(head, first_value), _mm_cmpeq_epi8(tail, last_value));
+                const std::uint32_t mask =
+                    static_cast<std::uint32_t>(_mm_movemask_epi8(both)) & (~std::uint32_t{0} << (i - at));
+                if (mask != 0)
+                {
+                    const std::size_t hit = verify_icase_candidates(p, mask, needle);
+                    if (hit != std::string_view::npos)
+                    {
+                        return {at + hit, at};
+                    }
+                }
+            }
+            return {std::string_view::npos, end};
+        }
+
+        LEARNINGS_TARGET("avx2")
+        inline search_step find_icase_avx2(std::string_view haystack, std::string_view needle) noexcept
+        {
+            const std::size_t last = needle.size() - 1;
+            const ascii_anchor front(needle.front());
+            const ascii_anchor back(needle.back());
+            const __m256i first_value = _mm256_set1_epi8(front.value);
+            const __m256i first_mask = _mm256_set1_epi8(front.mask);
+            const __m256i last_value = _mm256_set1_epi8(back.value);
+            const __m256i last_mask = _mm256_set1_epi8(back.mask);
+            const std::size_t end = haystack.size() - last;
+            for (std::size_t i = 0; i < end; i += 32)
+            {
+                const std::size_t at = std::min(i, end - 32);
+                const char *p = haystack.data() + at;
+                const __m256i head =
+                    _mm256_or_si256(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(p)), first_mask);
+                const __m256i tail =
+                    _mm256_or_si256(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(p + last)), last_mask);
+                const __m256i both =
+                    _mm256_and_si256(_mm256_cmpeq_epi8(head, first_value), _mm256_cmpeq_epi8(tail, last_value));
+                const std::uint32_t mask =
+                    static_cast<std::uint32_t>(_mm256_movemask_epi8(both)) & (~std::uint32_t{0} << (i - at));
+                if (mask != 0)
+                {
+                    const std::size_t hit = verify_icase_candidates(p, mask, needle);
+                    if (hit != std::string_view::npos)
+                    {
+                        return {at + hit, at};
+                    }
+                }
+            }
+            return {std::string_view::npos, end};
+        }
+
+        LEARNINGS_TARGET("avx512f,avx512bw")
+        inline search_step find_icase_avx512(std::string_view haystack, std::string_view needle) noexcept
+        {
+            const std::size_t last = needle.size() - 1;
+            const ascii_anchor front(needle.front());
+            const ascii_anchor back(needle.back());
+            const __m512i first_value = _mm512_set1_epi8(front.value);
+            const __m512i first_mask = _mm512_set1_epi8(front.mask);
+            const __m512i last_value = _mm512_set1_epi8(back.value);
+            const __m512i last_mask = _mm512_set1_epi8(back.mask);
+            const std::size_t end = haystack.size() - last;
+            for (std::size_t i = 0; i < end; i += 64)
+            {
+                const std::size_t at = std::min(i, end - 64);
+                const char *p = haystack.data() + at;
+                const __m512i head = _mm512_or_si512(_mm512_loadu_si512(p), first_mask);
+                const __m512i tail = _mm512_or_si512(_mm512_loadu_si512(p + last), last_mask);
+                const std::uint64_t mask = _mm512_cmpeq_epi8_mask(head, first_value) &
+                                           _mm512_cmpeq_epi8_mask(tail, last_value) & (~std::uint64_t{0} << (i - at));
+                if (mask != 0)
+                {
+                    const std::size_t hit = verify_icase_candidates(p, mask, needle);
+                    if (hit != std::string_view::npos)
+                    {
+                        return {at + hit, at};
+                    }
+                }
+            }
+            return {std::string_view::npos, end};
+        }
+#endif
+
+        /**
+         * @brief The UTF-8 filter: the bytes that may stand at the needle's first and last byte.
+         * @details Each set holds the bytes of all case variants of the first
+         *          (last) character at that position, repeated to fill.
+         */
+        struct utf8_anchors
+        {
+            std::array<char, 3> first;
+            std::array<char, 3> last;
+
+            explicit utf8_anchors(std::string_view needle) noexcept
+            {
+                first = variants(needle, 0, false);
+                std::size_t start = needle.size() - 1;
+                while (start > 0 && needle.size() - start < 4 &&
+                       (static_cast<unsigned char>(needle[start]) & 0xc0) == 0x80)
+                {
+                    --start;
+                }
+                last = variants(needle, start, true);
+            }
+
+            static bool contains(const std::array<char, 3> &set, char c) noexcept
+            {
+                return c == set[0] || c == set[1] || c == set[2];
+            }
+
+        private:
+            static std::array<char, 3> variants(std::string_view needle, std::size_t start, bool last_byte) noexcept
+            {
+                const char own = last_byte ? needle.back() : needle[start];
+                std::array<char, 3> out{own, own, own};
+                const utf8_char c = decode_utf8(needle.substr(start));
+                if (c.code_point >= 0x800 || (last_byte && start + c.length != needle.size()))
+                {
+                    return out; // Malformed, or beyond the scripts that fold: only the byte itself.
+                }
+                std::size_t count = 1;
+                for_each_case_variant(fold_case(c.code_point), [&](char32_t variant) {
+                    char bytes[2];
+                    const std::size_t length = encode_utf8_short(variant, bytes);
+                    const char b = last_byte ? bytes[length - 1] : bytes[0];
+                    if (!contains(out, b) && count < out.size())
+                    {
+                        out[count++] = b;
+                    }
+                });
+                return out;
+            }
+        };
+
+        inline std::size_t find_icase_utf8_scalar(std::string_view haystack, std::string_view needle,
+                                                  const utf8_anchors &anchors, std::size_t from) noexcept
+        {
+            const std::size_t last = needle.size() - 1;
+            for (std::size_t i = from; i + needle.size() <= haystack.size(); ++i)
+            {
+                if (utf8_anchors::contains(anchors.first, haystack[i]) &&
+                    utf8_anchors::contains(anchors.last, haystack[i + last]) &&
+                    utf8_iequal_prefix(haystack.substr(i), needle))
+                {
+                    return i;
+                }
+            }
+            return std::string_view::npos;
+        }
+
+#if LEARNINGS_SIMD_X86
+        /**
+         * @brief Result of the UTF-8 kernel: a `search_step` plus the validation verdict.
+         */
+        struct utf8_search_step
+        {
+            std::size_t found;
+            std::size_t scanned;
+            bool valid;
+        };
+
+        inline __m128i any_of(__m128i x, const std::array<char, 3> &set) noexcept
+        {
+            const __m128i two =
+                _mm_or_si128(_mm_cmpeq_epi8(x, _mm_set1_epi8(set[0])), _mm_cmpeq_epi8(x, _mm_set1_epi8(set[1])));
+            return _mm_or_si128(two, _mm_cmpeq_epi8(x, _mm_set1_epi8(set[2])));
+        }
+
+        /**
+         * @brief UTF-8 search over 16-byte blocks; with @p Validate, also validates all of @p haystack.
+         * @details The block loaded for the first-byte filter is the block the
+         *          validator consumes. Once a match is found only validation
+         *          continues.
+         */
+        template <bool Validate>
+        LEARNINGS_TARGET("ssse3")
+        utf8_search_step find_icase_utf8_ssse3(std::string_view haystack, std::string_view needle,
+                                               const utf8_anchors &anchors) noexcept
+        {
+            const std::size_t last = needle.size() - 1;
+            utf8_validator_ssse3 validator;
+            std::size_t found = std::string_view::npos;
+            std::size_t scanned = 0;
+            std::size_t i = 0;
+            for (; i + 16 <= haystack.size(); i += 16)
+            {
+                const char *p = haystack.data() + i;
+                const __m128i head = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p));
+                if constexpr (Validate)
+                {
+                    validator.update(head);
+                }
+                if (found != std::string_view::npos || i + last + 16 > haystack.size())
+                {
+                    if constexpr (!Validate)
+                    {
+                        break;
+                    }
+                    continue;
+                }
+                const __m128i tail = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p + last));
+                auto mask = static_cast<std::uint32_t>(
+                    _mm_movemask_epi8(_mm_and_si128(any_of(head, anchors.first), any_of(tail, anchors.last))));
+                while (mask != 0)
+                {
+                    const int bit = std::countr_zero(mask);
+                    if (utf8_iequal_prefix(haystack.substr(i + bit), needle))
+                    {
+                        found = i + bit;
+                        break;
+                    }
+                    mask &= mask - 1;
+                }
+                scanned = i + 16;
+                if (!Validate && found != std::string_view::npos)
+                {
+                    break;
+                }
+            }
+            if constexpr (Validate)
+            {
+                validate_utf8_rest(validator, haystack, i);
+                return {found, scanned, validator.finish()};
+            }
+            return {found, scanned, true};
+        }
+#endif
+
+        /**
+         * @brief Offset of the first malformed sequence in @p s; for error messages only.
+         */
+        inline std::size_t first_invalid_utf8(std::string_view s) noexcept
+        {
+            std::size_t i = 0;
+            while (i < s.size())
+            {
+                const utf8_char c = decode_utf8(s.substr(i));
+                if (c.code_point >= 0x110000)
+                {
+                    break;
+                }
+                i += c.length;
+            }
+            return i;
+        }
+    } // namespace detail
+
+    /**
+     * @brief Returns the first position at or after @p pos where @p needle occurs, ignoring ASCII case.
+     * @details Bytes outside ASCII compare exactly, so the result is also
+     *          correct on UTF-8 text for ASCII needles.
+     */
+    inline std::size_t find_icase(std::string_view haystack, std::string_view needle, std::size_t pos = 0) noexcept
+    {
+        if (pos > haystack.size() || needle.size() > haystack.size() - pos)
+        {
+            return std::string_view::npos;
+        }
+        if (needle.empty())
+        {
+            return pos;
+        }
+        const std::string_view rest = haystack.substr(pos);
+        detail::search_step step{std::string_view::npos, 0};
+#if LEARNINGS_SIMD_X86
+        // The widest kernel whose register fits the start positions; short lines take SSE2.
+        const std::size_t positions = rest.size() - needle.size() + 1;
+        const simd_level level = std::min(active_simd_level(), positions >= 64   ? simd_level::avx512
+                                                               : positions >= 32 ? simd_level::avx2
+                                                               : positions >= 16 ? simd_level::sse2
+                                                                                 : simd_level::scalar);
+        if (level >= simd_level::avx512)
+        {
+            step = detail::find_icase_avx512(rest, needle);
+        }
+        else if (level >= simd_level::avx2)
+        {
+            step = detail::find_icase_avx2(rest, needle);
+        }
+        else if (level >= simd_level::sse2)
+        {
+            step = detail::find_icase_sse2(rest, needle);
+        }
+        if (step.found != std::string_view::npos)
+        {
+            return pos + step.found;
+        }
+#endif
+        const std::size_t tail = detail::find_icase_scalar(rest, needle, step.scanned);
+        return tail == std::string_view::npos ? tail : pos + tail;
+    }
+
+    inline bool contains_icase(std::string_view haystack, std::string_view needle) noexcept
+    {
+        return find_icase(haystack, needle) != std::string_view::npos;
+    }
+
+    /**
+     * @brief Like `find_icase`, folding the scripts covered by `fold_case` (Latin, Greek, Cyrillic).
+     * @details @p pos should be a character boundary. Malformed bytes compare
+     *          exactly; use `find_icase_utf8_validated` to reject them instead.
+     */
+    inline std::size_t find_icase_utf8(std::string_view haystack, std::string_view needle, std::size_t pos = 0) noexcept
+    {
+        if (pos > haystack.size() || needle.size() > haystack.size() - pos)
+        {
+            return std::string_view::npos;
+        }
+        if (needle.empty())
+        {
+            return pos;
+        }
+        bool ascii = true;
+        for (const char c : needle)
+        {
+            ascii = ascii && static_cast<unsigned char>(c) < 0x80;
+        }
+        if (ascii)
+        {
+            return find_icase(haystack, needle, pos);
+        }
+        const std::string_view rest = haystack.substr(pos);
+        const detail::utf8_anchors anchors(needle);
+        std::size_t from = 0;
+#if LEARNINGS_SIMD_X86
+        if (active_simd_level() >= simd_level::ssse3)
+        {
+            const detail::utf8_search_step step = detail::find_icase_utf8_ssse3<false>(rest, needle, anchors);
+            if (step.found != std::string_view::npos)
+            {
+                return pos + step.found;
+            }
+            from = step.scanned;
+        }
+#endif
+        const std::size_t tail = detail::find_icase_utf8_scalar(rest, needle, anchors, from);
+        return tail == std::string_view::npos ? tail : pos + tail;
+    }
+
+    inline bool contains_icase_utf8(std::string_view haystack, std::string_view needle) noexcept
+    {
+        return find_icase_utf8(haystack, needle) != std::string_view::npos;
+    }
+
+    /**
+     * @brief `find_icase_utf8` over the whole of @p haystack, which must be valid UTF-8.
+     * @details Validation runs in the same pass as the search and covers the
+     *          whole text even when a match is found early.
+     * @return The position of the first match or npos, or an error naming the first malformed byte.
+     */
+    inline std::expected<std::size_t, std::string> find_icase_utf8_validated(std::string_view haystack,
+                                                                             std::string_view needle)
+    {
+        auto invalid = [&] {
+            return std::unexpected("invalid UTF-8 at byte " + std::to_string(detail::first_invalid_utf8(haystack)));
+        };
+        if (needle.empty() || needle.size() > haystack.size())
+        {
+            if (!validate_utf8(haystack))
+            {
+                return invalid();
+            }
+            return needle.empty() ? std::size_t{0} : std::string_view::npos;
+        }
+        const detail::utf8_anchors anchors(needle);
+#if LEARNINGS_SIMD_X86
+        if (active_simd_level() >= simd_level::ssse3)
+        {
+            const detail::utf8_search_step step = detail::find_icase_utf8_ssse3<true>(haystack, needle, anchors);
+            if (!step.valid)
+            {
+                return invalid();
+            }
+            return step.found != std::string_view::npos
+                       ? step.found
+                       : detail::find_icase_utf8_scalar(haystack, needle, anchors, step.scanned);
+        }
+#endif
+        if (!detail::validate_utf8_scalar(haystack))
+        {
+            return invalid();
+        }
+        return detail::find_icase_utf8_scalar(haystack, needle, anchors, 0);
+    }
+} // namespace learnings
@@ -0,0 +1,237 @@
+/**
+ * @file compiled_needle.hpp
+ * @brief A needle whose search strategy and tables are prepared once.
+ *
+ * `std::boyer_moore_horspool_searcher` has to be rebuilt for every needle and
+ * `contains` prepares nothing at all, so code that tests one keyword against
+ * millions of log lines either pays the setup per call or uses a poor
+ * algorithm. `compiled_needle` analyses the needle once:
+ *
+ *  - one byte: `memchr`;
+ *  - otherwise, on any CPU with SSE2: the first/last-byte SIMD filter of
+ *    `simd_search.hpp`. Measured on log text, random text and DNA with needles
+ *    up to 1 KiB, it outran Horspool and two-way at every length;
+ *  - without SIMD, long needles over a varied alphabet use
+ *    Boyer-Moore-Horspool, whose shift table skips close to a needle length
+ *    per step, and long needles over a small alphabet (DNA, digits), where
+ *    Horspool's shifts collapse, use two-way via glibc `memmem`.
+ *
+ * Construction is `constexpr`, so `constexpr compiled_needle fox("fox");`
+ * costs nothing at run time. At run time on a SIMD CPU the constructor skips
+ * the Horspool table, which `find` would never read. The two-argument
+ * constructor forces an algorithm, for tests and measurements.
+ */
+
+#pragma once
+
+#include "simd_search.hpp"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+
+namespace learnings
+{
+    /**
+     * @brief The search strategies `compiled_needle` chooses between.
+     */
+    enum class needle_algorithm
+    {
+        empty,       ///< Matches at every position.
+        single_byte, ///< `memchr`.
+        simd,        ///< First/last-byte SIMD filter, see `simd_find`; the library search without SIMD.
+        horspool,    ///< Boyer-Moore-Horspool with a 256-entry shift table.
+        two_way      ///< Two-way (Crochemore-Perrin) through glibc `memmem`; `simd_find` elsewhere.
+    };
+
+    constexpr std::string_view to_string(needle_algorithm algorithm) noexcept
+    {
+        constexpr std::string_view names[] = {"empty", "single_byte", "simd", "horspool", "two_way"};
+        return names[static_cast<int>(algorithm)];
+    }
+
+    /**
+     * @brief A search needle plus the tables for its chosen algorithm.
+     * @details The object refers to the needle's bytes and does not copy them;
+     *          they must outlive it, as string literals do.
+     */
+    class compiled_needle
+    {
+    public:
+        /// Without SIMD, needles at least this long use Horspool or two-way.
+        static constexpr std::size_t long_needle = 64;
+
+        /// A long needle with fewer distinct bytes than this is searched with two-way.
+        static constexpr std::size_t small_alphabet = 16;
+
+        /**
+         * @brief Analyses @p needle and builds its tables. O(needle length + 256).
+         */
+        constexpr explicit compiled_needle(std::string_view needle) noexcept
+            : needle_(needle), algorithm_(choose(needle))
+        {
+            if !consteval
+            {
+                if (algorithm_ > needle_algorithm::simd && active_simd_level() >= simd_level::sse2)
+                {
+                    algorithm_ = needle_algorithm::simd;
+                    return;
+                }
+            }
+            build_tables();
+        }
+
+        /**
+         * @brief Searches @p needle with @p algorithm whatever the CPU.
+         * @details `simd`, `horspool` and `two_way` are honoured for needles of
+         *          two bytes or more; shorter needles and the other values get
+         *          the analysed choice.
+         */
+        constexpr compiled_needle(std::string_view needle, needle_algorithm algorithm) noexcept
+            : needle_(needle),
+              algorithm_(needle.size() < 2 || algorithm < needle_algorithm::simd ? choose(needle) : algorithm),
+              prefer_simd_(false)
+        {
+            build_tables();
+        }
+
+        constexpr std::string_view needle() const noexcept { return needle_; }
+
+        /**
+         * @brief Returns the algorithm `find` uses on this CPU.
+         * @details A forced algorithm is returned as is. Otherwise, in
+         *          constant evaluation, the one for a CPU without SIMD.
+         */
+        constexpr needle_algorithm algorithm() const noexcept
+        {
+            if !consteval
+            {
+                if (prefer_simd_ && algorithm_ > needle_algorithm::simd && active_simd_level() >= simd_level::sse2)
+                {
+                    return needle_algorithm::simd;
+                }
+            }
+            return algorithm_;
+        }
+
+        /**
+         * @brief Returns the position of the first occurrence at or after @p pos, or npos.
+         * @details Same contract as `std::string_view::find(needle(), pos)`.
+         */
+        constexpr std::size_t find(std::string_view haystack, std::size_t pos = 0) const noexcept
+        {
+            if consteval
+            {
+                return haystack.find(needle_, pos);
+            }
+            else
+            {
+                switch (algorithm())
+                {
+                case needle_algorithm::empty:
+                    return pos <= haystack.size() ? pos : std::string_view::npos;
+                case needle_algorithm::single_byte:
+                    return haystack.find(needle_.front(), pos);
+                case needle_algorithm::horspool:
+                    return find_horspool(haystack, pos);
+                case needle_algorithm::two_way:
+#if defined(__GLIBC__)
+                    return find_two_way(haystack, pos);
+#else
+                    [[fallthrough]];
+#endif
+                case needle_algorithm::simd:
+                default:
+                    return simd_find(haystack, needle_, pos);
+                }
+            }
+        }
+
+        constexpr bool contains(std::string_view haystack) const noexcept
+        {
+            return find(haystack) != std::string_view::npos;
+        }
+
+    private:
+        /**
+         * @brief The algorithm for @p needle on a CPU without SIMD.
+         */
+        static constexpr needle_algorithm choose(std::string_view needle) noexcept
+        {
+            if (needle.empty())
+            {
+                return needle_algorithm::empty;
+            }
+            if (needle.size() == 1)
+            {
+                return needle_algorithm::single_byte;
+            }
+            if (needle.size() < long_needle)
+            {
+                return needle_algorithm::simd;
+            }
+
+            std::array<bool, 256> seen{};
+            std::size_t distinct = 0;
+            for (const char c : needle)
+            {
+                distinct += seen[static_cast<unsigned char>(c)] ? 0 : 1;
+                seen[static_cast<unsigned char>(c)] = true;
+            }
+            return distinct < small_alphabet ? needle_algorithm::two_way : needle_algorithm::horspool;
+        }
+
+        constexpr void build_tables() noexcept
+        {
+            if (algorithm_ != needle_algorithm::horspool)
+            {
+                return;
+            }
+            shift_.fill(static_cast<std::uint32_t>(needle_.size()));
+            for (std::size_t i = 0; i + 1 < needle_.size(); ++i)
+            {
+                shift_[static_cast<unsigned char>(needle_[i])] = static_cast<std::uint32_t>(needle_.size() - 1 - i);
+            }
+        }
+
+        std::size_t find_horspool(std::string_view haystack, std::size_t pos) const noexcept
+        {
+            const std::size_t m = needle_.size();
+            if (pos > haystack.size() || m > haystack.size() - pos)
+            {
+                return std::string_view::npos;
+            }
+            const char last = needle_.back();
+            for (std::size_t i = pos; i + m <= haystack.size();)
+            {
+                const char c = haystack[i + m - 1];
+                if (c == last && std::memcmp(haystack.data() + i, needle_.data(), m - 1) == 0)
+                {
+                    return i;
+                }
+                i += shift_[static_cast<unsigned char>(c)];
+            }
+            return std::string_view::npos;
+        }
+
+#if defined(__GLIBC__)
+        std::size_t find_two_way(std::string_view haystack, std::size_t pos) const noexcept
+        {
+            if (pos > haystack.size())
+            {
+                return std::string_view::npos;
+            }
+            const void *hit = ::memmem(haystack.data() + pos, haystack.size() - pos, needle_.data(), needle_.size());
+            return hit == nullptr ? std::string_view::npos
+                                  : static_cast<std::size_t>(static_cast<const char *>(hit) - haystack.data());
+        }
+#endif
+
+        std::string_view needle_;
+        needle_algorithm algorithm_ = needle_algorithm::empty; ///< The choice for a CPU without SIMD.
+        bool prefer_simd_ = true; ///< False when the algorithm was forced.
+        std::array<std::uint32_t, 256> shift_{}; ///< Horspool: distance from a byte's last needle position to the end.
+    };
+} // namespace learnings
@@ -0,0 +1,174 @@
+/**
+ * @file deduced_mixins.hpp
+ * @brief Mixin bases whose algorithms dispatch statically on the derived type through deduced `this`.
+ *
+ * A virtual base implements shared algorithms ("roundness is 4πA/P²") on top
+ * of virtual primitives, paying an indirect call per primitive and a vptr per
+ * object. CRTP removes the indirection but makes every base a template over
+ * its derived class. With an explicit object parameter (`this auto &&self`)
+ * the base is an ordinary class: `self` is deduced as the type at the call
+ * site, so `self.area()` binds to the derived member and inlines.
+ *
+ * The catch is that dispatch follows the static type. A call through a
+ * `base &` deduces `base` and fails to compile, so heterogeneous collections
+ * need the set of types spelled out: a `std::variant` per element, or a
+ * `type_batches` that keeps one vector per type and runs each loop with the
+ * type known.
+ *
+ * - `clonable`: `clone()` returns a copy of the most-derived type.
+ * - `ordered_by_key`: `==` and `<=>` from `self.key()`.
+ * - `range_interface`: `empty`, `size`, `front`, `back`, `operator[]` and
+ *   `operator bool` from `begin()` / `end()`, like `std::ranges::view_interface`
+ *   without the template parameter.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <compare>
+#include <concepts>
+#include <cstddef>
+#include <functional>
+#include <iterator>
+#include <span>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace learnings
+{
+    namespace detail
+    {
+        template <typename T, typename... Ts>
+        concept one_of = (std::same_as<T, Ts> || ...);
+    } // namespace detail
+
+    /**
+     * @brief Adds `clone()`, which copies the object as its most-derived type.
+     * @details Replaces the `virtual std::unique_ptr<base> clone() const`
+     *          idiom where the type is known statically: no allocation, no slicing.
+     */
+    struct clonable
+    {
+        template <typename Self>
+        [[nodiscard]] constexpr auto clone(this const Self &self) -> Self
+        {
+            return self;
+        }
+    };
+
+    /**
+     * @brief Adds `==` and `<=>` that compare `self.key()`.
+     * @details Both operands must have the same derived type, so objects of
+     *          unrelated types that share the mixin do not compare.
+     */
+    struct ordered_by_key
+    {
+        template <typename Self>
+        constexpr bool operator==(this const Self &self, const Self &other)
+        {
+            return self.key() == other.key();
+        }
+
+        template <typename Self>
+        constexpr auto operator<=>(this const Self &self, const Self &other)
+        {
+            return self.key() <=> other.key();
+        }
+    };
+
+    /**
+     * @brief Adds the derived members of a container on top of `begin()` and `end()`.
+     * @details The `this auto &&` overloads keep the constness of the object,
+     *          so `front()` of a const range yields a const reference.
+     */
+    struct range_interface
+    {
+        constexpr bool empty(this const auto &self) { return self.begin() == self.end(); }
+
+        constexpr explicit operator bool(this const auto &self) { return !self.empty(); }
+
+        constexpr std::size_t size(this const auto &self)
+            requires std::sized_sentinel_for<decltype(self.end()), decltype(self.begin())>
+        {
+            return static_cast<std::size_t>(self.end() - self.begin());
+        }
+
+        constexpr decltype(auto) front(this auto &&self) { return *self.begin(); }
+
+        constexpr decltype(auto) back(this auto &&self)
+            requires std::bidirectional_iterator<decltype(self.end())>
+        {
+            return *std::ranges::prev(self.end());
+        }
+
+        constexpr decltype(auto) operator[](this auto &&self, std::size_t index)
+            requires std::random_access_iterator<decltype(self.begin())>
+        {
+            return self.begin()[static_cast<std::iter_difference_t<decltype(self.begin())>>(index)];
+        }
+    };
+
+    /**
+     * @brief A heterogeneous collection stored as one vector per type.
+     * @details `for_each` runs one loop per type, so every call inside it is
+     *          resolved at compile time and the loops vectorise where the
+     *          body allows. Insertion order is kept within a type only.
+     */
+    template <typename... Ts>
+        requires(sizeof...(Ts) > 0)
+    class type_batches
+    {
+        std::tuple<std::vector<Ts>...> batches_;
+
+    public:
+        /**
+         * @brief Constructs a `T` at the end of its batch.
+         */
+        template <detail::one_of<Ts...> T, typename... Args>
+        T &emplace(Args &&...args)
+        {
+            return std::get<std::vector<T>>(batches_).emplace_back(std::forward<Args>(args)...);
+        }
+
+        template <typename T>
+            requires detail::one_of<std::remove_cvref_t<T>, Ts...>
+        void push_back(T &&value)
+        {
+            std::get<std::vector<std::remove_cvref_t<T>>>(batches_).push_back(std::forward<T>(value));
+        }
+
+        /**
+         * @brief The elements of type `T`, const if the collection is.
+         */
+        template <detail::one_of<Ts...> T>
+        auto batch(this auto &&self)
+        {
+            return std::span(std::get<std::vector<T>>(self.batches_));
+        }
+
+        /**
+         * @brief Calls @p fn on every element, one type at a time in the order of `Ts`.
+         * @details @p fn itself is invoked, never a copy, so a stateful or
+         *          move-only function object sees every element.
+         */
+        template <typename F>
+        void for_each(this auto &&self, F &&fn)
+        {
+            std::apply([&](auto &...batch) { (std::ranges::for_each(batch, std::ref(fn)), ...); }, self.batches_);
+        }
+
+        std::size_t size() const
+        {
+            return std::apply([](const auto &...batch) { return (batch.size() + ...); }, batches_);
+        }
+
+        bool empty() const { return size() == 0; }
+
+        void clear()
+        {
+            std::apply([](auto &...batch) { (batch.clear(), ...); }, batches_);
+        }
+    };
+} // namespace learnings
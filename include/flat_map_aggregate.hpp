@@ -0,0 +1,505 @@
+/**
+ * @file flat_map_aggregate.hpp
+ * @brief Vectorised aggregations over the value column of a `std::flat_map`.
+ *
+ * `std::flat_map` keeps its mapped values in their own contiguous container,
+ * so `ages.values()` is a plain array of `int`: a column that SIMD kernels can
+ * stream through without touching the keys. The functions here take any
+ * contiguous range of arithmetic values; `int32_t` columns use hand-written
+ * SSE2/AVX2 kernels chosen at run time, other types a scalar loop the
+ * compiler can vectorise. Every function accepts `max_threads` and splits
+ * large columns across threads.
+ *
+ * @code
+ * const auto total = learnings::sum_values(ages.values());
+ * const auto adults = learnings::count_values_between(ages.values(), 18, 64, 8);
+ * @endcode
+ */
+
+#pragma once
+
+#include "simd_dispatch.hpp"
+
+#include <algorithm>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <ranges>
+#include <span>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace learnings
+{
+    /// Accumulator type for summing values of type `T` without overflow in practice.
+    template <typename T>
+    using value_sum_t = std::conditional_t<std::is_floating_point_v<T>, double,
+                                           std::conditional_t<std::is_signed_v<T>, std::int64_t, std::uint64_t>>;
+
+    /**
+     * @brief Smallest and largest value of a column.
+     */
+    template <typename T>
+    struct value_range
+    {
+        T min;
+        T max;
+    };
+
+    namespace detail
+    {
+        /// Below this many values a second thread costs more than it saves.
+        inline constexpr std::size_t parallel_aggregate_threshold = std::size_t{1} << 18;
+
+        /**
+         * @brief Runs @p kernel on up to @p max_threads chunks of @p values and folds the results with @p combine.
+         */
+        template <typename T, typename Kernel, typename Combine>
+        auto parallel_reduce(std::span<const T> values, unsigned max_threads, Kernel kernel, Combine combine)
+        {
+            const std::size_t chunks =
+                std::clamp<std::size_t>(values.size() / parallel_aggregate_threshold, 1, std::max(max_threads, 1u));
+            if (chunks == 1)
+            {
+                return kernel(values);
+            }
+
+            using result_type = decltype(kernel(values));
+            std::vector<std::optional<result_type>> partial(chunks);
+            {
+                std::vector<std::jthread> workers;
+                for (std::size_t i = 1; i < chunks; ++i)
+                {
+                    const std::size_t begin = values.size() * i / chunks;
+                    const std::size_t end = values.size() * (i + 1) / chunks;
+                    workers.emplace_back([&, i, begin, end] { partial[i] = kernel(values.subspan(begin, end - begin)); });
+                }
+                partial[0] = kernel(values.first(values.size() / chunks)); // The calling thread takes a chunk too.
+            } // jthreads join here.
+
+            result_type result = std::move(*partial[0]);
+            for (std::size_t i = 1; i < chunks; ++i)
+            {
+                result = combine(std::move(result), std::move(*partial[i]));
+            }
+            return result;
+        }
+
+        template <typename T>
+        value_sum_t<T> sum_scalar(std::span<const T> values) noexcept
+        {
+            value_sum_t<T> sum = 0;
+            for (const T v : values)
+            {
+                sum += v;
+            }
+            return sum;
+        }
+
+        template <typename T>
+        value_range<T> min_max_scalar(std::span<const T> values) noexcept
+        {
+            value_range<T> range{values.front(), values.front()};
+            for (const T v : values)
+            {
+                range.min = std::min(range.min, v);
+                range.max = std::max(range.max, v);
+            }
+            return range;
+        }
+
+        template <typename T>
+        std::size_t count_between_scalar(std::span<const T> values, T lo, T hi) noexcept
+        {
+            std::size_t count = 0;
+            for (const T v : values)
+            {
+                count += static_cast<std::size_t>(!(v < lo) && !(hi < v)); // Branch-free so it vectorises.
+            }
+            return count;
+        }
+
+#if LEARNINGS_SIMD_X86
+        inline std::int64_t horizontal_sum_epi64(__m128i v) noexcept
+        {
+            alignas(16) std::int64_t lanes[2];
+            _mm_store_si128(reinterpret_cast<__m128i *>(lanes), v);
+            return lanes[0] + lanes[1];
+        }
+
+        inline std::int64_t sum_sse2(std::span<const std::int32_t> values) noexcept
+        {
+            __m128i acc_lo = _mm_setzero_si128();
+            __m128i acc_hi = _mm_setzero_si128();
+            std::size_t i = 0;
+            for (; i + 4 <= values.size(); i += 4)
+            {
+                // Sign-extend to 64-bit lanes: SSE2 has no pmovsxdq.
+                const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(values.data() + i));
+                const __m128i sign = _mm_srai_epi32(v, 31);
+                acc_lo = _mm_add_epi64(acc_lo, _mm_unpacklo_epi32(v, sign));
+                acc_hi = _mm_add_epi64(acc_hi, _mm_unpackhi_epi32(v, sign));
+            }
+            return horizontal_sum_epi64(_mm_add_epi64(acc_lo, acc_hi)) + sum_scalar(values.subspan(i));
+        }
+
+        LEARNINGS_TARGET("avx2")
+        inline std::int64_t sum_avx2(std::span<const std::int32_t> values) noexcept
+        {
+            __m256i acc[2] = {_mm256_setzero_si256(), _mm256_setzero_si256()};
+            std::size_t i = 0;
+            for (; i + 8 <= values.size(); i += 8)
+            {
+                const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(values.data() + i));
+                const __m256i sign = _mm256_srai_epi32(v, 31);
+                acc[0] = _mm256_add_epi64(acc[0], _mm256_unpacklo_epi32(v, sign));
+                acc[1] = _mm256_add_epi64(acc[1], _mm256_unpackhi_epi32(v, sign));
+            }
+            const __m256i total = _mm256_add_epi64(acc[0], acc[1]);
+            const __m128i folded = _mm_add_epi64(_mm256_castsi256_si128(total), _mm256_extracti128_si256(total, 1));
+            return horizontal_sum_epi64(folded) + sum_scalar(values.subspan(i));
+        }
+
+        inline value_range<std::int32_t> min_max_sse2(std::span<const std::int32_t> values) noexcept
+        {
+            // SSE2 has no pminsd/pmaxsd, so select with a compare mask.
+            auto select = [](__m128i mask, __m128i a, __m128i b) {
+                return _mm_or_si128(_mm_and_si128(mask, a), _mm_andnot_si128(mask, b));
+            };
+            __m128i lo = _mm_set1_epi32(values.front());
+            __m128i hi = lo;
+            std::size_t i = 0;
+            for (; i + 4 <= values.size(); i += 4)
+            {
+                const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(values.data() + i));
+                lo = select(_mm_cmplt_epi32(v, lo), v, lo);
+                hi = select(_mm_cmpgt_epi32(v, hi), v, hi);
+            }
+            alignas(16) std::int32_t lo_lanes[4];
+            alignas(16) std::int32_t hi_lanes[4];
+            _mm_store_si128(reinterpret_cast<__m128i *>(lo_lanes), lo);
+            _mm_store_si128(reinterpret_cast<__m128i *>(hi_lanes), hi);
+            value_range<std::int32_t> range{*std::min_element(lo_lanes, lo_lanes + 4),
+                                            *std::max_element(hi_lanes, hi_lanes + 4)};
+            for (; i < values.size(); ++i)
+            {
+                range.min = std::min(range.min, values[i]);
+                range.max = std::max(range.max, values[i]);
+            }
+            return range;
+        }
+
+        LEARNINGS_TARGET("avx2")
+        inline value_range<std::int32_t> min_max_avx2(std::span<const std::int32_t> values) noexcept
+        {
+            __m256i lo = _mm256_set1_epi32(values.front());
+            __m256i hi = lo;
+            std::size_t i = 0;
+            for (; i + 8 <= values.size(); i += 8)
+            {
+                const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(values.data() + i));
+                lo = _mm256_min_epi32(lo, v);
+                hi = _mm256_max_epi32(hi, v);
+            }
+            alignas(32) std::int32_t lo_lanes[8];
+            alignas(32) std::int32_t hi_lanes[8];
+            _mm256_store_si256(reinterpret_cast<__m256i *>(lo_lanes), lo);
+            _mm256_store_si256(reinterpret_cast<__m256i *>(hi_lanes), hi);
+            value_range<std::int32_t> range{*std::min_element(lo_lanes, lo_lanes + 8),
+                                            *std::max_element(hi_lanes, hi_lanes + 8)};
+            for (; i < values.size(); ++i)
+            {
+                range.min = std::min(range.min, values[i]);
+                range.max = std::max(range.max, values[i]);
+            }
+            return range;
+        }
+
+        inline std::size_t count_between_sse2(std::span<const std::int32_t> values, std::int32_t lo,
+                                              std::int32_t hi) noexcept
+        {
+            const __m128i below = _mm_set1_epi32(lo);
+            const __m128i above = _mm_set1_epi32(hi);
+            __m128i outside = _mm_setzero_si128(); // Per-lane counts, subtracted as -1 masks.
+            std::size_t i = 0;
+            for (; i + 4 <= values.size(); i += 4)
+            {
+                const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(values.data() + i));
+                outside = _mm_sub_epi32(outside, _mm_or_si128(_mm_cmplt_epi32(v, below), _mm_cmpgt_epi32(v, above)));
+            }
+            alignas(16) std::uint32_t lanes[4];
+            _mm_store_si128(reinterpret_cast<__m128i *>(lanes), outside);
+            const std::size_t out = std::size_t{lanes[0]} + lanes[1] + lanes[2] + lanes[3];
+            return i - out + count_between_scalar(values.subspan(i), lo, hi);
+        }
+
+        LEARNINGS_TARGET("avx2")
+        inline std::size_t count_between_avx2(std::span<const std::int32_t> values, std::int32_t lo,
+                                              std::int32_t hi) noexcept
+        {
+            const __m256i below = _mm256_set1_epi32(lo);
+            const __m256i above = _mm256_set1_epi32(hi);
+            __m256i outside = _mm256_setzero_si256();
+            std::size_t i = 0;
+            for (; i + 8 <= values.size(); i += 8)
+            {
+                const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(values.data() + i));
+                const __m256i mask = _mm256_or_si256(_mm256_cmpgt_epi32(below, v), _mm256_cmpgt_epi32(v, above));
+                outside = _mm256_sub_epi32(outside, mask);
+            }
+            alignas(32) std::uint32_t lanes[8];
+            _mm256_store_si256(reinterpret_cast<__m256i *>(lanes), outside);
+            std::size_t out = 0;
+            for (const std::uint32_t lane : lanes)
+            {
+                out += lane;
+            }
+            return i - out + count_between_scalar(values.subspan(i), lo, hi);
+        }
+#endif
+
+        template <typename T>
+        value_sum_t<T> sum_kernel(std::span<const T> values) noexcept
+        {
+#if LEARNINGS_SIMD_X86
+            if constexpr (std::is_same_v<T, std::int32_t>)
+            {
+                const simd_level level = active_simd_level();
+                if (level >= simd_level::avx2)
+                {
+                    return sum_avx2(values);
+                }
+                if (level >= simd_level::sse2)
+                {
+                    return sum_sse2(values);
+                }
+            }
+#endif
+            return sum_scalar(values);
+        }
+
+        template <typename T>
+        value_range<T> min_max_kernel(std::span<const T> values) noexcept
+        {
+#if LEARNINGS_SIMD_X86
+            if constexpr (std::is_same_v<T, std::int32_t>)
+            {
+                const simd_level level = active_simd_level();
+                if (level >= simd_level::avx2)
+                {
+                    return min_max_avx2(values);
+                }
+                if (level >= simd_level::sse2)
+                {
+                    return min_max_sse2(values);
+                }
+            }
+#endif
+            return min_max_scalar(values);
+        }
+
+        template <typename T>
+        std::size_t count_between_kernel(std::span<const T> values, T lo, T hi) noexcept
+        {
+#if LEARNINGS_SIMD_X86
+            if constexpr (std::is_same_v<T, std::int32_t>)
+            {
+                const simd_level level = active_simd_level();
+                if (level >= simd_level::avx2)
+                {
+                    return count_between_avx2(values, lo, hi);
+                }
+                if (level >= simd_level::sse2)
+                {
+                    return count_between_sse2(values, lo, hi);
+                }
+            }
+#endif
+            return count_between_scalar(values, lo, hi);
+        }
+
+        template <typename R>
+        auto as_column(const R &values) noexcept
+        {
+            return std::span<const std::ranges::range_value_t<R>>(std::ranges::data(values), std::ranges::size(values));
+        }
+    } // namespace detail
+
+    /**
+     * @brief A contiguous range of arithmetic values, such as `flat_map::values()`.
+     * @details `bool` is arithmetic but has no unsigned counterpart or useful
+     *          sum, so it is excluded.
+     */
+    template <typename R>
+    concept value_column = std::ranges::contiguous_range<R> && std::ranges::sized_range<R> &&
+                           std::is_arithmetic_v<std::ranges::range_value_t<R>> &&
+                           !std::same_as<std::ranges::range_value_t<R>, bool>;
+
+    /**
+     * @brief Sums the column into a 64-bit (or `double`) accumulator.
+     */
+    template <value_column R>
+    auto sum_values(const R &values, unsigned max_threads = 1)
+    {
+        using T = std::ranges::range_value_t<R>;
+        return detail::parallel_reduce(detail::as_column(values), max_threads, detail::sum_kernel<T>,
+                                       [](value_sum_t<T> a, value_sum_t<T> b) { return a + b; });
+    }
+
+    /**
+     * @brief Returns the smallest and largest value, or `std::nullopt` for an empty column.
+     */
+    template <value_column R>
+    auto min_max_values(const R &values, unsigned max_threads = 1)
+    {
+        using T = std::ranges::range_value_t<R>;
+        std::optional<value_range<T>> result;
+        if (std::ranges::size(values) != 0)
+        {
+            result = detail::parallel_reduce(detail::as_column(values), max_threads, detail::min_max_kernel<T>,
+                                             [](value_range<T> a, value_range<T> b) {
+                                                 return value_range<T>{std::min(a.min, b.min), std::max(a.max, b.max)};
+                                             });
+        }
+        return result;
+    }
+
+    /**
+     * @brief Returns the arithmetic mean, or `std::nullopt` for an empty column.
+     */
+    template <value_column R>
+    std::optional<double> mean_values(const R &values, unsigned max_threads = 1)
+    {
+        const std::size_t n = std::ranges::size(values);
+        if (n == 0)
+        {
+            return std::nullopt;
+        }
+        return static_cast<double>(sum_values(values, max_threads)) / static_cast<double>(n);
+    }
+
+    /**
+     * @brief Counts the values in the closed interval [@p lo, @p hi].
+     */
+    template <value_column R>
+    std::size_t count_values_between(const R &values, std::ranges::range_value_t<R> lo,
+                                     std::ranges::range_value_t<R> hi, unsigned max_threads = 1)
+    {
+        using T = std::ranges::range_value_t<R>;
+        return detail::parallel_reduce(
+            detail::as_column(values), max_threads,
+            [lo, hi](std::span<const T> chunk) { return detail::count_between_kernel(chunk, lo, hi); },
+            [](std::size_t a, std::size_t b) { return a + b; });
+    }
+
+    /**
+     * @brief Counts the values satisfying @p pred.
+     * @details The count is accumulated without a branch, so a simple
+     *          predicate is vectorised by the compiler.
+     */
+    template <value_column R, typename Pred>
+    std::size_t count_values_if(const R &values, Pred pred, unsigned max_threads = 1)
+    {
+        using T = std::ranges::range_value_t<R>;
+        return detail::parallel_reduce(
+            detail::as_column(values), max_threads,
+            [&pred](std::span<const T> chunk) {
+                std::size_t count = 0;
+                for (const T v : chunk)
+                {
+                    count += static_cast<std::size_t>(static_cast<bool>(pred(v)));
+                }
+                return count;
+            },
+            [](std::size_t a, std::size_t b) { return a + b; });
+    }
+
+    /**
+     * @brief Counts values in @p buckets equal-width buckets spanning [@p lo, @p hi).
+     * @return One count per bucket; values outside the interval are not counted.
+     * @details Four interleaved sub-histograms break the store-to-load
+     *          dependency between neighbouring values that land in the same
+     *          bucket, which is what limits a naive histogram loop.
+     */
+    template <value_column R>
+    std::vector<std::size_t> histogram_values(const R &values, std::ranges::range_value_t<R> lo,
+                                              std::ranges::range_value_t<R> hi, std::size_t buckets,
+                                              unsigned max_threads = 1)
+    {
+        using T = std::ranges::range_value_t<R>;
+        if (buckets == 0 || !(lo < hi))
+        {
+            return std::vector<std::size_t>(buckets, 0);
+        }
+        // Integral columns spanning a small interval map values to buckets
+        // through a table, with one extra slot that absorbs out-of-range
+        // values so that the loop has no branches; others scale through double.
+        constexpr std::size_t table_limit = std::size_t{1} << 16;
+        std::vector<std::uint32_t> table;
+        if constexpr (std::is_integral_v<T>)
+        {
+            // Subtract in the unsigned type: `hi - lo` overflows T for ranges such as INT_MIN..INT_MAX.
+            using U = std::make_unsigned_t<T>;
+            const auto width = static_cast<std::size_t>(static_cast<U>(static_cast<U>(hi) - static_cast<U>(lo)));
+            if (width <= table_limit)
+            {
+                table.resize(width);
+                for (std::size_t offset = 0; offset < width; ++offset)
+                {
+                    table[offset] = static_cast<std::uint32_t>(offset * buckets / width);
+                }
+            }
+        }
+        const double scale = static_cast<double>(buckets) / (static_cast<double>(hi) - static_cast<double>(lo));
+        auto slot_of = [&](T v) -> std::size_t {
+            if constexpr (std::is_integral_v<T>)
+            {
+                if (!table.empty())
+                {
+                    using U = std::make_unsigned_t<T>;
+                    const auto offset = static_cast<std::size_t>(static_cast<U>(static_cast<U>(v) - static_cast<U>(lo)));
+                    return offset < table.size() ? table[offset] : buckets;
+                }
+            }
+            if (v < lo || !(v < hi))
+            {
+                return buckets;
+            }
+            const auto b = static_cast<std::size_t>((static_cast<double>(v) - static_cast<double>(lo)) * scale);
+            return std::min(b, buckets - 1); // Rounding can reach `buckets` just below hi.
+        };
+
+        auto kernel = [&](std::span<const T> chunk) {
+            const std::size_t stride = buckets + 1;
+            std::vector<std::size_t> counts(4 * stride, 0);
+            std::size_t i = 0;
+            for (; i + 4 <= chunk.size(); i += 4)
+            {
+                ++counts[slot_of(chunk[i])];
+                ++counts[stride + slot_of(chunk[i + 1])];
+                ++counts[2 * stride + slot_of(chunk[i + 2])];
+                ++counts[3 * stride + slot_of(chunk[i + 3])];
+            }
+            for (; i < chunk.size(); ++i)
+            {
+                ++counts[slot_of(chunk[i])];
+            }
+            for (std::size_t b = 0; b < buckets; ++b)
+            {
+                counts[b] += counts[stride + b] + counts[2 * stride + b] + counts[3 * stride + b];
+            }
+            counts.resize(buckets);
+            return counts;
+        };
+        return detail::parallel_reduce(detail::as_column(values), max_threads, kernel,
+                                       [](std::vector<std::size_t> a, const std::vector<std::size_t> &b) {
+                                           for (std::size_t i = 0; i < a.size(); ++i)
+                                           {
+                                               a[i] += b[i];
+                                           }
+                                           return a;
+                                       });
+    }
+} // namespace learnings
@@ -0,0 +1,286 @@
+/**
+ * @file flat_map_bulk.hpp
+ * @brief Bulk construction of `std::flat_map` from unsorted key/value pairs.
+ *
+ * Filling a `std::flat_map` with repeated `operator[]` costs an O(n) shift per
+ * new key, so loading n entries is O(n^2). The loader in this file instead
+ * collects the pairs, sorts and deduplicates them once (splitting the sort
+ * across threads for large inputs) and hands the finished key and value
+ * containers to the map through `std::sorted_unique` or `replace()`.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <flat_map> // C++23: std::flat_map, std::sorted_unique.
+#include <functional>
+#include <iterator>
+#include <optional>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace learnings
+{
+    namespace detail
+    {
+        /// Below this many elements a single-threaded sort is faster than spawning threads.
+        inline constexpr std::size_t parallel_sort_threshold = std::size_t{1} << 16;
+
+        /**
+         * @brief Stable sort that splits large ranges across up to @p max_threads threads.
+         * @details Each thread stable-sorts one chunk, then neighbouring chunks are
+         *          merged pairwise with `std::inplace_merge`, which preserves the
+         *          relative order of equivalent elements.
+         */
+        template <typename RandomIt, typename Compare>
+        void parallel_stable_sort(RandomIt first, RandomIt last, Compare comp, unsigned max_threads)
+        {
+            const auto n = static_cast<std::size_t>(last - first);
+            const std::size_t chunks = std::min<std::size_t>(max_threads, n / parallel_sort_threshold);
+            if (chunks <= 1)
+            {
+                std::stable_sort(first, last, comp);
+                return;
+            }
+
+            std::vector<RandomIt> bounds(chunks + 1);
+            for (std::size_t i = 0; i <= chunks; ++i)
+            {
+                bounds[i] = first + static_cast<std::ptrdiff_t>(n * i / chunks);
+            }
+
+            {
+                std::vector<std::jthread> workers;
+                for (std::size_t i = 0; i < chunks; ++i)
+                {
+                    workers.emplace_back([=] { std::stable_sort(bounds[i], bounds[i + 1], comp); });
+                }
+            } // jthreads join here.
+
+            for (std::size_t width = 1; width < chunks; width *= 2)
+            {
+                std::vector<std::jthread> workers;
+                for (std::size_t i = 0; i + width < chunks; i += 2 * width)
+                {
+                    const RandomIt lo = bounds[i];
+                    const RandomIt mid = bounds[i + width];
+                    const RandomIt hi = bounds[std::min(i + 2 * width, chunks)];
+                    workers.emplace_back([=] { std::inplace_merge(lo, mid, hi, comp); });
+                }
+            }
+        }
+
+        /**
+         * @brief Sorts pairs by key and keeps only the last pair queued for each key.
+         */
+        template <typename Key, typename V, typename Compare>
+        void sort_unique_last_wins(std::vector<std::pair<Key, V>> &pairs, const Compare &comp, unsigned max_threads)
+        {
+            auto by_key = [&comp](const auto &a, const auto &b) { return comp(a.first, b.first); };
+            parallel_stable_sort(pairs.begin(), pairs.end(), by_key, max_threads);
+
+            auto out = pairs.begin();
+            for (auto it = pairs.begin(); it != pairs.end();)
+            {
+                auto run_end = std::next(it);
+                while (run_end != pairs.end() && !comp(it->first, run_end->first))
+                {
+                    ++run_end;
+                }
+                auto last = std::prev(run_end);
+                if (out != last)
+                {
+                    *out = std::move(*last);
+                }
+                ++out;
+                it = run_end;
+            }
+            pairs.erase(out, pairs.end());
+        }
+    } // namespace detail
+
+    /**
+     * @brief Collects key/value pairs and builds a `std::flat_map` in one pass.
+     *
+     * @tparam Key     The key type.
+     * @tparam T       The mapped type.
+     * @tparam Compare The key ordering, as for `std::flat_map`.
+     * @details When a key is added more than once the last value wins, which
+     *          matches a sequence of `map[key] = value` assignments.
+     */
+    template <typename Key, typename T, typename Compare = std::less<Key>>
+    class flat_map_bulk_loader
+    {
+    public:
+        using map_type = std::flat_map<Key, T, Compare>;
+        using key_container_type = typename map_type::key_container_type;
+        using mapped_container_type = typename map_type::mapped_container_type;
+
+        /**
+         * @brief Constructs an empty loader.
+         * @param comp        The key ordering.
+         * @param max_threads Upper bound on threads used to sort large inputs.
+         */
+        explicit flat_map_bulk_loader(Compare comp = Compare(),
+                                      unsigned max_threads = std::thread::hardware_concurrency())
+            : comp_(std::move(comp)), max_threads_(max_threads == 0 ? 1 : max_threads)
+        {
+        }
+
+        /**
+         * @brief Reserves space for @p n pairs.
+         */
+        void reserve(std::size_t n) { pairs_.reserve(n); }
+
+        /**
+         * @brief Queues one key/value pair. O(1) amortised.
+         */
+        template <typename K, typename V>
+        void add(K &&key, V &&value)
+        {
+            pairs_.emplace_back(std::forward<K>(key), std::forward<V>(value));
+        }
+
+        /**
+         * @brief Returns the number of queued pairs, duplicates included.
+         */
+        std::size_t size() const noexcept { return pairs_.size(); }
+
+        /**
+         * @brief Builds a new map from the queued pairs. O(n log n).
+         * @return A map adopting the sorted containers via `std::sorted_unique`.
+         */
+        map_type build() &&
+        {
+            sort_unique();
+            key_container_type keys;
+            mapped_container_type values;
+            keys.reserve(pairs_.size());
+            values.reserve(pairs_.size());
+            for (auto &[key, value] : pairs_)
+            {
+                keys.push_back(std::move(key));
+                values.push_back(std::move(value));
+            }
+            pairs_.clear();
+            return map_type(std::sorted_unique, std::move(keys), std::move(values), comp_);
+        }
+
+        /**
+         * @brief Merges the queued pairs into an existing map. O(n + m log m).
+         * @param map The destination; queued values overwrite existing ones.
+         * @details The map's containers are extracted, merged linearly with the
+         *          sorted batch and put back with `replace()`. If an exception
+         *          escapes, @p map is left valid but empty.
+         */
+        void merge_into(map_type &map) &&
+        {
+            sort_unique();
+            auto old = std::move(map).extract();
+
+            key_container_type keys;
+            mapped_container_type values;
+            keys.reserve(old.keys.size() + pairs_.size());
+            values.reserve(old.keys.size() + pairs_.size());
+
+            std::size_t i = 0;
+            auto it = pairs_.begin();
+            while (i < old.keys.size() || it != pairs_.end())
+            {
+                const bool take_old = it == pairs_.end() ||
+                                      (i < old.keys.size() && comp_(old.keys[i], it->first));
+                if (take_old)
+                {
+                    keys.push_back(std::move(old.keys[i]));
+                    values.push_back(std::move(old.values[i]));
+                    ++i;
+                    continue;
+                }
+                if (i < old.keys.size() && !comp_(it->first, old.keys[i]))
+                {
+                    ++i; // Same key: the queued value replaces the existing one.
+                }
+                keys.push_back(std::move(it->first));
+                values.push_back(std::move(it->second));
+                ++it;
+            }
+            pairs_.clear();
+            map.replace(std::move(keys), std::move(values));
+        }
+
+    private:
+        void sort_unique() { detail::sort_unique_last_wins(pairs_, comp_, max_threads_); }
+
+        std::vector<std::pair<Key, T>> pairs_;
+        Compare comp_;
+        unsigned max_threads_;
+    };
+
+    /**
+     * @brief Builds a `std::flat_map` from unsorted pairs in O(n log n).
+     * @param pairs The pairs to load; for duplicate keys the last one wins.
+     * @param comp  The key ordering.
+     * @return The finished map.
+     */
+    template <typename Key, typename T, typename Compare = std::less<Key>>
+    std::flat_map<Key, T, Compare> make_flat_map(std::vector<std::pair<Key, T>> pairs, Compare comp = Compare())
+    {
+        flat_map_bulk_loader<Key, T, Compare> loader(std::move(comp));
+        loader.reserve(pairs.size());
+        for (auto &[key, value] : pairs)
+        {
+            loader.add(std::move(key), std::move(value));
+        }
+        return std::move(loader).build();
+    }
+
+    /**
+     * @brief Applies a batch of upserts and erasures to @p map in one linear merge.
+     * @param map         The map to update in place.
+     * @param updates     Key with its new value, or `std::nullopt` to erase the
+     *                    key; for repeated keys the last update wins.
+     * @param max_threads Upper bound on threads used to sort the batch.
+     * @details O(n + m log m) for n entries and m updates, against O(n m) for
+     *          applying the updates one at a time. If an exception escapes,
+     *          @p map is left valid but empty.
+     */
+    template <typename Key, typename T, typename Compare>
+    void apply_updates(std::flat_map<Key, T, Compare> &map, std::vector<std::pair<Key, std::optional<T>>> updates,
+                       unsigned max_threads = 1)
+    {
+        const Compare comp = map.key_comp();
+        detail::sort_unique_last_wins(updates, comp, max_threads);
+        auto old = std::move(map).extract();
+
+        decltype(old.keys) keys;
+        decltype(old.values) values;
+        keys.reserve(old.keys.size() + updates.size());
+        values.reserve(old.keys.size() + updates.size());
+
+        std::size_t i = 0;
+        auto it = updates.begin();
+        while (i < old.keys.size() || it != updates.end())
+        {
+            if (it == updates.end() || (i < old.keys.size() && comp(old.keys[i], it->first)))
+            {
+                keys.push_back(std::move(old.keys[i]));
+                values.push_back(std::move(old.values[i]));
+                ++i;
+                continue;
+            }
+            if (i < old.keys.size() && !comp(it->first, old.keys[i]))
+            {
+                ++i; // Same key: the update replaces or erases the existing entry.
+            }
+            if (it->second)
+            {
+                keys.push_back(std::move(it->first));
+                values.push_back(std::move(*it->second));
+            }
+            ++it;
+        }
+        map.replace(std::move(keys), std::move(values));
+    }
+} // namespace learnings
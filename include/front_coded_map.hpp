@@ -0,0 +1,390 @@
+/**
+ * @file front_coded_map.hpp
+ * @brief Read-only string-keyed map with front-coded (prefix-compressed) keys.
+ *
+ * Sorted hostnames and paths repeat long prefixes from one key to the next,
+ * and a `std::flat_map<std::string, T>` stores every byte of every key plus a
+ * 32-byte `std::string` header and, past 15 bytes, a heap block. Front coding
+ * stores each key as the length of the prefix it shares with its predecessor
+ * followed by the remaining suffix. Every `restart_interval` keys the chain is
+ * broken by a key stored in full, so a lookup binary-searches those restart
+ * keys without decoding anything and then decodes at most one block.
+ */
+
+#pragma once
+
+#include "heterogeneous_lookup.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <flat_map>
+#include <iterator>
+#include <limits>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace learnings
+{
+    namespace detail
+    {
+        /**
+         * @brief Appends @p value as an LEB128 varint: seven bits per byte, low bits first.
+         */
+        inline void put_varint(std::vector<char> &out, std::size_t value)
+        {
+            while (value >= 0x80)
+            {
+                out.push_back(static_cast<char>((value & 0x7f) | 0x80));
+                value >>= 7;
+            }
+            out.push_back(static_cast<char>(value));
+        }
+
+        /**
+         * @brief Decodes a varint at @p p and advances @p p past it.
+         */
+        inline std::size_t get_varint(const char *&p) noexcept
+        {
+            std::size_t value = 0;
+            for (unsigned shift = 0;; shift += 7)
+            {
+                const auto byte = static_cast<unsigned char>(*p++);
+                value |= static_cast<std::size_t>(byte & 0x7f) << shift;
+                if (byte < 0x80)
+                {
+                    return value;
+                }
+            }
+        }
+    } // namespace detail
+
+    /**
+     * @brief Immutable sorted sequence of strings, front-coded in one buffer.
+     *
+     * @details Each block starts with `varint(length) bytes`; the other keys of
+     *          the block are `varint(shared) varint(suffix length) suffix`.
+     */
+    class front_coded_keys
+    {
+    public:
+        /**
+         * @brief Forward iterator that decodes keys one after another.
+         * @details The yielded view points into the iterator's own buffer and is
+         *          invalidated when the iterator advances.
+         */
+        class iterator
+        {
+        public:
+            using iterator_category = std::forward_iterator_tag;
+            using value_type = std::string_view;
+            using difference_type = std::ptrdiff_t;
+            using pointer = void;
+            using reference = std::string_view;
+
+            iterator() = default;
+
+            std::string_view operator*() const noexcept { return key_; }
+            std::size_t index() const noexcept { return index_; }
+
+            iterator &operator++()
+            {
+                if (++index_ < keys_->size_)
+                {
+                    decode();
+                }
+                return *this;
+            }
+
+            iterator operator++(int)
+            {
+                iterator previous = *this;
+                ++*this;
+                return previous;
+            }
+
+            friend bool operator==(const iterator &a, const iterator &b) noexcept { return a.index_ == b.index_; }
+
+        private:
+            friend class front_coded_keys;
+
+            iterator(const front_coded_keys *keys, std::size_t index) : keys_(keys), index_(index)
+            {
+                if (index_ < keys_->size_)
+                {
+                    next_ = keys_->bytes_.data() + keys_->restarts_[index_ / keys_->interval_];
+                    decode();
+                }
+            }
+
+            void decode()
+            {
+                const std::size_t shared = index_ % keys_->interval_ == 0 ? 0 : detail::get_varint(next_);
+                const std::size_t suffix = detail::get_varint(next_);
+                key_.resize(shared);
+                key_.append(next_, suffix);
+                next_ += suffix;
+            }
+
+            const front_coded_keys *keys_ = nullptr;
+            std::size_t index_ = 0;
+            const char *next_ = nullptr; ///< Start of the next key's encoding.
+            std::string key_;
+        };
+
+        front_coded_keys() = default;
+
+        /**
+         * @brief Encodes keys that are already sorted and free of duplicates. O(total bytes).
+         * @param keys             Any range of values convertible to `std::string_view`.
+         * @param restart_interval Keys per block; larger blocks compress better and decode longer.
+         * @throws std::length_error if the encoding exceeds 4 GiB.
+         */
+        template <typename Range>
+        static front_coded_keys from_sorted_unique(const Range &keys, std::size_t restart_interval = 16)
+        {
+            front_coded_keys coded;
+            coded.interval_ = std::max<std::size_t>(restart_interval, 1);
+            std::string_view previous;
+            for (const auto &key : keys)
+            {
+                const std::string_view view(key);
+                if (coded.size_ % coded.interval_ == 0)
+                {
+                    coded.restarts_.push_back(static_cast<std::uint32_t>(coded.bytes_.size()));
+                    detail::put_varint(coded.bytes_, view.size());
+                    coded.bytes_.insert(coded.bytes_.end(), view.begin(), view.end());
+                }
+                else
+                {
+                    const auto mismatch = std::ranges::mismatch(previous, view);
+                    const auto shared = static_cast<std::size_t>(mismatch.in2 - view.begin());
+                    detail::put_varint(coded.bytes_, shared);
+                    detail::put_varint(coded.bytes_, view.size() - shared);
+                    coded.bytes_.insert(coded.bytes_.end(), view.begin() + shared, view.end());
+                }
+                if (coded.bytes_.size() > std::numeric_limits<std::uint32_t>::max())
+                {
+                    throw std::length_error("front_coded_keys: more than 4 GiB of encoded keys");
+                }
+                previous = view;
+                ++coded.size_;
+            }
+            coded.bytes_.shrink_to_fit();
+            coded.restarts_.shrink_to_fit();
+            return coded;
+        }
+
+        std::size_t size() const noexcept { return size_; }
+        std::size_t restart_interval() const noexcept { return interval_; }
+        iterator begin() const { return iterator(this, 0); }
+        iterator end() const { return iterator(this, size_); }
+
+        /**
+         * @brief Returns the index of @p key, or `std::nullopt`.
+         * @details Binary search over the restart keys, which are stored whole
+         *          and compared in place, then a linear decode of one block.
+         */
+        std::optional<std::size_t> find(std::string_view key) const
+        {
+            // Last block whose first key is <= key.
+            std::size_t lo = 0;
+            std::size_t hi = restarts_.size();
+            while (lo < hi)
+            {
+                const std::size_t mid = lo + (hi - lo) / 2;
+                if (restart_key(mid) <= key)
+                {
+                    lo = mid + 1;
+                }
+                else
+                {
+                    hi = mid;
+                }
+            }
+            if (lo == 0)
+            {
+                return std::nullopt;
+            }
+            const std::size_t block = lo - 1;
+
+            // Walk the block. `matched` is how much of `key` the current entry
+            // shares; an entry sharing less with its predecessor than that has
+            // diverged upwards past `key`, so the search can stop without
+            // materialising any key.
+            const char *p = bytes_.data() + restarts_[block];
+            const std::size_t first = block * interval_;
+            const std::size_t last = std::min(first + interval_, size_);
+            std::size_t matched = 0;
+            for (std::size_t i = first; i < last; ++i)
+            {
+                std::size_t shared = 0;
+                if (i != first)
+                {
+                    shared = detail::get_varint(p);
+                }
+                const std::size_t suffix_length = detail::get_varint(p);
+                const std::string_view suffix(p, suffix_length);
+                p += suffix_length;
+                if (shared < matched)
+                {
+                    return std::nullopt; // This entry is greater than every key sharing `matched` bytes.
+                }
+                if (shared > matched)
+                {
+                    continue; // Still below `key`: it agrees with the previous entry past where that one differed.
+                }
+                const std::string_view rest = key.substr(matched);
+                const auto mismatch = std::ranges::mismatch(suffix, rest);
+                const auto common = static_cast<std::size_t>(mismatch.in1 - suffix.begin());
+                if (common == suffix.size() && common == rest.size())
+                {
+                    return i;
+                }
+                if (common < suffix.size() &&
+                    (common == rest.size() ||
+                     static_cast<unsigned char>(suffix[common]) > static_cast<unsigned char>(rest[common])))
+                {
+                    return std::nullopt; // Passed the place where `key` would be.
+                }
+                matched += common;
+            }
+            return std::nullopt;
+        }
+
+        /**
+         * @brief Returns the heap bytes owned by the encoding.
+         */
+        std::size_t memory_bytes() const noexcept
+        {
+            return bytes_.capacity() + restarts_.capacity() * sizeof(std::uint32_t);
+        }
+
+    private:
+        std::string_view restart_key(std::size_t block) const noexcept
+        {
+            const char *p = bytes_.data() + restarts_[block];
+            const std::size_t length = detail::get_varint(p);
+            return {p, length};
+        }
+
+        std::vector<char> bytes_;
+        std::vector<std::uint32_t> restarts_; ///< Byte offset of each block's first key.
+        std::size_t size_ = 0;
+        std::size_t interval_ = 16;
+    };
+
+    /**
+     * @brief Read-only map from front-coded string keys to values.
+     * @tparam T The mapped type.
+     * @details Iterates in the order of the `std::flat_map<std::string, T>` it
+     *          was built from, yielding `std::pair<std::string_view, const T &>`.
+     */
+    template <typename T>
+    class front_coded_map
+    {
+    public:
+        /**
+         * @brief Forward iterator over (key, value) pairs in key order.
+         */
+        class iterator
+        {
+        public:
+            using iterator_category = std::forward_iterator_tag;
+            using value_type = std::pair<std::string_view, const T &>;
+            using difference_type = std::ptrdiff_t;
+            using pointer = void;
+            using reference = value_type;
+
+            iterator() = default;
+
+            reference operator*() const { return {*key_, (*values_)[key_.index()]}; }
+
+            iterator &operator++()
+            {
+                ++key_;
+                return *this;
+            }
+
+            iterator operator++(int)
+            {
+                iterator previous = *this;
+                ++*this;
+                return previous;
+            }
+
+            friend bool operator==(const iterator &a, const iterator &b) noexcept { return a.key_ == b.key_; }
+
+        private:
+            friend class front_coded_map;
+            iterator(front_coded_keys::iterator key, const std::vector<T> *values)
+                : key_(std::move(key)), values_(values)
+            {
+            }
+
+            front_coded_keys::iterator key_;
+            const std::vector<T> *values_ = nullptr;
+        };
+
+        front_coded_map() = default;
+
+        /**
+         * @brief Encodes the keys of a finished map and copies its values. O(n).
+         */
+        template <typename Compare>
+            requires lexicographic_string_order<Compare>
+        explicit front_coded_map(const std::flat_map<std::string, T, Compare> &source,
+                                 std::size_t restart_interval = 16)
+            : keys_(front_coded_keys::from_sorted_unique(source.keys(), restart_interval)),
+              values_(source.values().begin(), source.values().end())
+        {
+        }
+
+        std::size_t size() const noexcept { return keys_.size(); }
+        iterator begin() const { return iterator(keys_.begin(), &values_); }
+        iterator end() const { return iterator(keys_.end(), &values_); }
+
+        /**
+         * @brief Returns the front-coded key container.
+         */
+        const front_coded_keys &keys() const noexcept { return keys_; }
+
+        /**
+         * @brief Returns a pointer to the value for @p key, or nullptr.
+         */
+        const T *find(std::string_view key) const
+        {
+            const auto index = keys_.find(key);
+            return index ? &values_[*index] : nullptr;
+        }
+
+        bool contains(std::string_view key) const { return keys_.find(key).has_value(); }
+
+        /**
+         * @brief Returns the value for @p key.
+         * @throws std::out_of_range if the key is absent.
+         */
+        const T &at(std::string_view key) const
+        {
+            const T *value = find(key);
+            if (value == nullptr)
+            {
+                throw std::out_of_range("front_coded_map::at: key not found");
+            }
+            return *value;
+        }
+
+        /**
+         * @brief Returns the heap bytes owned by the keys and values.
+         */
+        std::size_t memory_bytes() const noexcept { return keys_.memory_bytes() + values_.capacity() * sizeof(T); }
+
+    private:
+        front_coded_keys keys_;
+        std::vector<T> values_;
+    };
+} // namespace learnings
@@ -0,0 +1,113 @@
+/**
+ * @file heterogeneous_lookup.hpp
+ * @brief Allocation-free `std::string_view` lookups in string-keyed maps.
+ *
+ * `std::flat_map<std::string, T>` only accepts `const std::string &` in
+ * `find`, so probing it with a `const char *` or a `std::string_view` builds a
+ * temporary string, which is a heap allocation once the key outgrows the
+ * small-string buffer. A transparent comparator (`std::less<>`) removes the
+ * temporary. The helpers here do the same for maps declared with the default
+ * `std::less<std::string>`, and `string_hash` gives `std::unordered_map` the
+ * matching transparent hash.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <concepts>
+#include <cstddef>
+#include <flat_map>
+#include <functional>
+#include <ranges>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+namespace learnings
+{
+    /**
+     * @brief A comparator or hash that accepts heterogeneous arguments.
+     */
+    template <typename F>
+    concept transparent = requires { typename F::is_transparent; };
+
+    /**
+     * @brief Orderings under which a `std::string` and a `std::string_view` compare like their bytes.
+     */
+    template <typename Compare>
+    concept lexicographic_string_order =
+        std::same_as<Compare, std::less<std::string>> || std::same_as<Compare, std::less<>>;
+
+    /**
+     * @brief A (possibly const) map keyed by `std::string` under a lexicographic order.
+     * @details Constrains the free functions below, which would otherwise be
+     *          candidates for every unqualified `find`, `contains` or `at`
+     *          call that finds this namespace through argument-dependent lookup.
+     *          A map without a transparent comparator must expose its sorted
+     *          keys through `keys()`, as `std::flat_map` does.
+     */
+    template <typename Map>
+    concept string_keyed_map =
+        std::same_as<typename std::remove_const_t<Map>::key_type, std::string> &&
+        lexicographic_string_order<typename std::remove_const_t<Map>::key_compare> &&
+        (transparent<typename std::remove_const_t<Map>::key_compare> || requires(Map &map) {
+            { map.keys() } -> std::ranges::random_access_range;
+        });
+
+    /**
+     * @brief Transparent hash for `std::unordered_map<std::string, T, string_hash, std::equal_to<>>`.
+     */
+    struct string_hash
+    {
+        using is_transparent = void;
+
+        std::size_t operator()(std::string_view key) const noexcept { return std::hash<std::string_view>{}(key); }
+    };
+
+    /**
+     * @brief Finds @p key in a string-keyed flat_map without materialising a `std::string`.
+     * @details Transparent maps forward to their own `find`; otherwise the key
+     *          container is searched directly with a string/string_view
+     *          comparison. O(log n) either way.
+     */
+    template <string_keyed_map Map>
+    auto find(Map &map, std::string_view key)
+    {
+        if constexpr (transparent<typename std::remove_const_t<Map>::key_compare>)
+        {
+            return map.find(key);
+        }
+        else
+        {
+            const auto &keys = map.keys();
+            const auto it = std::lower_bound(keys.begin(), keys.end(), key,
+                                             [](const std::string &a, std::string_view b) { return a < b; });
+            return it != keys.end() && *it == key ? map.begin() + (it - keys.begin()) : map.end();
+        }
+    }
+
+    /**
+     * @brief Returns whether a string-keyed flat_map holds @p key. No allocation.
+     */
+    template <string_keyed_map Map>
+    bool contains(const Map &map, std::string_view key)
+    {
+        return learnings::find(map, key) != map.end();
+    }
+
+    /**
+     * @brief Returns the value for @p key in a string-keyed flat_map.
+     * @throws std::out_of_range if the key is absent, as `std::flat_map::at` does.
+     */
+    template <string_keyed_map Map>
+    auto &at(Map &map, std::string_view key)
+    {
+        const auto it = learnings::find(map, key);
+        if (it == map.end())
+        {
+            throw std::out_of_range("flat_map::at: key not found");
+        }
+        return it->second;
+    }
+} // namespace learnings
@@ -0,0 +1,217 @@
+/**
+ * @file mapped_file.hpp
+ * @brief Read-only, move-only RAII wrapper around a POSIX memory mapping, and durable file replacement.
+ *
+ * Errors are reported through `std::expected` rather than exceptions, in the
+ * same way as `safe_divide` in C++26.cpp: failing to open a file is an
+ * expected outcome that callers should handle at the call site.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cerrno>
+#include <cstddef>
+#include <cstring>
+#include <expected> // C++23: std::expected for explicit error handling.
+#include <filesystem>
+#include <span>
+#include <string>
+#include <utility>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace learnings
+{
+    /**
+     * @brief Expected access pattern for a mapped range, passed to `posix_madvise`.
+     */
+    enum class access_advice
+    {
+        normal,
+        sequential, ///< Read ahead aggressively and drop pages behind the reader.
+        random,     ///< Do not read ahead.
+        will_need,  ///< Start reading the range in now.
+        dont_need   ///< The range will not be used soon.
+    };
+
+    /**
+     * @brief A whole file mapped read-only into the address space.
+     */
+    class mapped_file
+    {
+    public:
+        mapped_file() = default;
+
+        /**
+         * @brief Maps @p path read-only.
+         * @return The mapping, or a message naming the failing system call.
+         */
+        static std::expected<mapped_file, std::string> open(const std::string &path)
+        {
+            const int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+            if (fd < 0)
+            {
+                return std::unexpected("open(" + path + "): " + std::strerror(errno));
+            }
+
+            struct stat info{};
+            if (::fstat(fd, &info) != 0)
+            {
+                const std::string error = "fstat(" + path + "): " + std::strerror(errno);
+                ::close(fd);
+                return std::unexpected(error);
+            }
+
+            mapped_file file;
+            file.size_ = static_cast<std::size_t>(info.st_size);
+            if (file.size_ > 0)
+            {
+                void *address = ::mmap(nullptr, file.size_, PROT_READ, MAP_SHARED, fd, 0);
+                if (address == MAP_FAILED)
+                {
+                    const std::string error = "mmap(" + path + "): " + std::strerror(errno);
+                    ::close(fd);
+                    return std::unexpected(error);
+                }
+                file.data_ = static_cast<const std::byte *>(address);
+            }
+            ::close(fd); // The mapping keeps the file alive.
+            return file;
+        }
+
+        mapped_file(mapped_file &&other) noexcept
+            : data_(std::exchange(other.data_, nullptr)), size_(std::exchange(other.size_, 0))
+        {
+        }
+
+        mapped_file &operator=(mapped_file &&other) noexcept
+        {
+            if (this != &other)
+            {
+                unmap();
+                data_ = std::exchange(other.data_, nullptr);
+                size_ = std::exchange(other.size_, 0);
+            }
+            return *this;
+        }
+
+        mapped_file(const mapped_file &) = delete;
+        mapped_file &operator=(const mapped_file &) = delete;
+
+        ~mapped_file() { unmap(); }
+
+        /**
+         * @brief Returns the mapped bytes; valid until the object is destroyed or moved from.
+         */
+        std::span<const std::byte> bytes() const noexcept { return {data_, size_}; }
+
+        const std::byte *data() const noexcept { return data_; }
+        std::size_t size() const noexcept { return size_; }
+
+        /**
+         * @brief Tells the kernel how bytes [@p offset, @p offset + @p length) will be read.
+         * @details The range is widened to whole pages and clamped to the file.
+         *          Advice is a hint: success does not mean any I/O has happened.
+         * @return Nothing, or a message with the `posix_madvise` error.
+         */
+        std::expected<void, std::string> advise(access_advice advice, std::size_t offset = 0,
+                                                std::size_t length = static_cast<std::size_t>(-1)) const
+        {
+            if (data_ == nullptr || offset >= size_)
+            {
+                return {};
+            }
+            static const std::size_t page = static_cast<std::size_t>(::sysconf(_SC_PAGESIZE));
+            const std::size_t begin = offset / page * page; // The mapping itself is page-aligned.
+            const std::size_t end = length > size_ - offset ? size_ : offset + length;
+            constexpr int flags[] = {POSIX_MADV_NORMAL, POSIX_MADV_SEQUENTIAL, POSIX_MADV_RANDOM, POSIX_MADV_WILLNEED,
+                                     POSIX_MADV_DONTNEED};
+            const int error = ::posix_madvise(const_cast<std::byte *>(data_) + begin, end - begin,
+                                              flags[static_cast<int>(advice)]);
+            if (error != 0)
+            {
+                return std::unexpected(std::string("posix_madvise: ") + std::strerror(error));
+            }
+            return {};
+        }
+
+    private:
+        void unmap() noexcept
+        {
+            if (data_ != nullptr)
+            {
+                ::munmap(const_cast<std::byte *>(data_), size_);
+                data_ = nullptr;
+                size_ = 0;
+            }
+        }
+
+        const std::byte *data_ = nullptr;
+        std::size_t size_ = 0;
+    };
+
+    namespace detail
+    {
+        inline std::expected<void, std::string> fsync_path(const std::filesystem::path &path, int flags)
+        {
+            const int fd = ::open(path.c_str(), flags | O_CLOEXEC);
+            if (fd < 0)
+            {
+                return std::unexpected("open(" + path.string() + "): " + std::strerror(errno));
+            }
+            const bool synced = ::fsync(fd) == 0;
+            const int error = errno;
+            ::close(fd);
+            if (!synced)
+            {
+                return std::unexpected("fsync(" + path.string() + "): " + std::strerror(error));
+            }
+            return {};
+        }
+    } // namespace detail
+
+    /**
+     * @brief Returns a temporary file name next to @p path, unique to this call.
+     * @details The process id and a per-process counter keep concurrent
+     *          writers of the same @p path, in this process or others, from
+     *          truncating each other's file before `replace_file` renames it.
+     */
+    inline std::filesystem::path temp_path_for(const std::filesystem::path &path)
+    {
+        static std::atomic<unsigned long> counter{0};
+        return path.string() + ".tmp." + std::to_string(::getpid()) + "." +
+               std::to_string(counter.fetch_add(1, std::memory_order_relaxed));
+    }
+
+    /**
+     * @brief Flushes the finished file @p temp to disk and renames it over @p path.
+     * @details The directory is flushed after the rename as well, so that
+     *          after a crash @p path holds either its old contents or the
+     *          complete new file, never a prefix of it. If either step
+     *          before the rename fails, @p temp is removed.
+     * @return Nothing, or a message naming the failing step.
+     */
+    inline std::expected<void, std::string> replace_file(const std::filesystem::path &temp,
+                                                         const std::filesystem::path &path)
+    {
+        std::error_code ec;
+        if (auto synced = detail::fsync_path(temp, O_RDONLY); !synced)
+        {
+            std::filesystem::remove(temp, ec);
+            return synced;
+        }
+        std::filesystem::rename(temp, path, ec);
+        if (ec)
+        {
+            const std::string message = "rename to " + path.string() + ": " + ec.message();
+            std::filesystem::remove(temp, ec);
+            return std::unexpected(message);
+        }
+        const std::filesystem::path directory = path.has_parent_path() ? path.parent_path() : ".";
+        return detail::fsync_path(directory, O_RDONLY | O_DIRECTORY);
+    }
+} // namespace learnings
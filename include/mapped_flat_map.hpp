@@ -0,0 +1,432 @@
+/**
+ * @file mapped_flat_map.hpp
+ * @brief On-disk format for sorted string-keyed maps and a zero-copy reader.
+ *
+ * A map such as `ages` is written once with `write_mapped_flat_map` and later
+ * opened with `mapped_flat_map<T>::open`, which maps the file and serves
+ * lookups and iteration straight out of the page cache: nothing is parsed,
+ * allocated or copied at startup.
+ *
+ * File layout (host byte order, every section 8-byte aligned):
+ * | Section | Contents                                                   |
+ * |---------|------------------------------------------------------------|
+ * | header  | `mapped_flat_map_header`, 64 bytes                         |
+ * | offsets | `count + 1` x `uint64_t`, key `i` is `blob[off[i], off[i+1])` |
+ * | values  | `count` x `T`, zero-padded to a multiple of 8 bytes        |
+ * | blob    | all key bytes back to back, zero-padded                    |
+ *
+ * The header checksum covers every byte after the header.
+ */
+
+#pragma once
+
+#include "mapped_file.hpp"
+
+#include <algorithm>
+#include <array>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <expected> // C++23: std::expected for explicit error handling.
+#include <filesystem>
+#include <flat_map>
+#include <fstream>
+#include <functional>
+#include <iterator>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+
+namespace learnings
+{
+    /**
+     * @brief Fixed-size header at the start of every mapped flat_map file.
+     */
+    struct mapped_flat_map_header
+    {
+        static constexpr std::array<char, 8> expected_magic{'L', 'F', 'M', 'A', 'P', '\0', '\0', '\1'};
+        static constexpr std::uint32_t current_version = 1;
+
+        std::array<char, 8> magic;
+        std::uint32_t version;
+        std::uint32_t value_size; ///< `sizeof(T)`, to catch reading with the wrong value type.
+        std::uint64_t count;
+        std::uint64_t offsets_offset;
+        std::uint64_t values_offset;
+        std::uint64_t blob_offset;
+        std::uint64_t blob_size;
+        std::uint64_t checksum; ///< `checksum64` of every byte after the header.
+    };
+    static_assert(sizeof(mapped_flat_map_header) == 64);
+
+    /**
+     * @brief Streaming 64-bit checksum: an FNV-1a-style mix over 8-byte words.
+     * @details Mixing a word at a time keeps full verification close to memory
+     *          bandwidth, unlike byte-wise FNV-1a.
+     */
+    class checksum64
+    {
+    public:
+        void update(std::span<const std::byte> bytes) noexcept
+        {
+            std::size_t i = 0;
+            while (pending_size_ != 0 && i < bytes.size())
+            {
+                pending_[pending_size_++] = bytes[i++];
+                if (pending_size_ == pending_.size())
+                {
+                    mix();
+                }
+            }
+            update_words(bytes.subspan(i));
+        }
+
+        std::uint64_t value() const noexcept
+        {
+            std::uint64_t h = hash_;
+            for (std::size_t i = 0; i < pending_size_; ++i)
+            {
+                h = (h ^ static_cast<std::uint64_t>(pending_[i])) * prime;
+            }
+            return h;
+        }
+
+    private:
+        static constexpr std::uint64_t prime = 0x100000001b3ull;
+
+        void update_words(std::span<const std::byte> bytes) noexcept
+        {
+            std::size_t i = 0;
+            for (; i + 8 <= bytes.size(); i += 8)
+            {
+                std::uint64_t word;
+                std::memcpy(&word, bytes.data() + i, 8);
+                hash_ = (hash_ ^ word) * prime;
+                hash_ ^= hash_ >> 29;
+            }
+            for (; i < bytes.size(); ++i)
+            {
+                pending_[pending_size_++] = bytes[i];
+            }
+        }
+
+        void mix() noexcept
+        {
+            std::uint64_t word;
+            std::memcpy(&word, pending_.data(), 8);
+            hash_ = (hash_ ^ word) * prime;
+            hash_ ^= hash_ >> 29;
+            pending_size_ = 0;
+        }
+
+        std::uint64_t hash_ = 0xcbf29ce484222325ull;
+        std::array<std::byte, 8> pending_{};
+        std::size_t pending_size_ = 0;
+    };
+
+    namespace detail
+    {
+        constexpr std::uint64_t align8(std::uint64_t n) noexcept { return (n + 7) & ~std::uint64_t{7}; }
+
+        template <typename T>
+        std::span<const std::byte> as_bytes_of(const T &value) noexcept
+        {
+            return std::as_bytes(std::span<const T, 1>(&value, 1));
+        }
+    } // namespace detail
+
+    /**
+     * @brief Writes @p map in the mapped flat_map format.
+     * @details The file is written next to @p path, flushed and renamed into
+     *          place (see `replace_file`), so readers never observe a
+     *          half-written file, even after a crash.
+     * @return Nothing on success, or an error message.
+     */
+    template <typename T, typename Compare>
+        requires std::is_trivially_copyable_v<T> && (alignof(T) <= 8) &&
+                 (std::same_as<Compare, std::less<std::string>> || std::same_as<Compare, std::less<>>)
+    std::expected<void, std::string> write_mapped_flat_map(const std::filesystem::path &path,
+                                                           const std::flat_map<std::string, T, Compare> &map)
+    {
+        static constexpr std::array<std::byte, 8> zeros{};
+
+        mapped_flat_map_header header{};
+        header.magic = mapped_flat_map_header::expected_magic;
+        header.version = mapped_flat_map_header::current_version;
+        header.value_size = sizeof(T);
+        header.count = map.size();
+        header.offsets_offset = sizeof(mapped_flat_map_header);
+        header.values_offset = header.offsets_offset + (header.count + 1) * sizeof(std::uint64_t);
+        header.blob_offset = header.values_offset + detail::align8(header.count * sizeof(T));
+        for (const auto &key : map.keys())
+        {
+            header.blob_size += key.size();
+        }
+
+        const std::filesystem::path temp = temp_path_for(path);
+        std::ofstream out(temp, std::ios::binary | std::ios::trunc);
+        if (!out)
+        {
+            return std::unexpected("cannot create " + temp.string());
+        }
+
+        checksum64 checksum;
+        auto emit = [&](std::span<const std::byte> bytes) {
+            checksum.update(bytes);
+            out.write(reinterpret_cast<const char *>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+        };
+        auto pad = [&](std::uint64_t written) {
+            emit(std::span(zeros).first(detail::align8(written) - written));
+        };
+
+        out.write(reinterpret_cast<const char *>(&header), sizeof(header)); // Rewritten below with the checksum.
+
+        std::uint64_t offset = 0;
+        emit(detail::as_bytes_of(offset));
+        for (const auto &key : map.keys())
+        {
+            offset += key.size();
+            emit(detail::as_bytes_of(offset));
+        }
+
+        emit(std::as_bytes(std::span(map.values().data(), map.values().size())));
+        pad(header.count * sizeof(T));
+
+        for (const auto &key : map.keys())
+        {
+            emit(std::as_bytes(std::span(key.data(), key.size())));
+        }
+        pad(header.blob_size);
+
+        header.checksum = checksum.value();
+        out.seekp(0);
+        out.write(reinterpret_cast<const char *>(&header), sizeof(header));
+        out.close();
+        if (!out)
+        {
+            std::error_code ec;
+            std::filesystem::remove(temp, ec);
+            return std::unexpected("write failed for " + temp.string());
+        }
+
+        return replace_file(temp, path);
+    }
+
+    /**
+     * @brief How much of a mapped file `mapped_flat_map::open` validates.
+     */
+    enum class mapped_verify
+    {
+        header, ///< Magic, version, value size and section bounds; O(1). Trusts the key offsets.
+        full,   ///< Additionally the checksum and key offsets; O(file size).
+    };
+
+    /**
+     * @brief Read-only flat map served directly from a memory-mapped file.
+     * @tparam T The trivially copyable mapped type the file was written with.
+     */
+    template <typename T>
+        requires std::is_trivially_copyable_v<T> && (alignof(T) <= 8)
+    class mapped_flat_map
+    {
+    public:
+        using value_type = std::pair<std::string_view, const T &>;
+
+        /**
+         * @brief Random-access iterator yielding `(key, value)` pairs in key order.
+         */
+        class iterator
+        {
+        public:
+            using iterator_category = std::random_access_iterator_tag;
+            using difference_type = std::ptrdiff_t;
+            using value_type = mapped_flat_map::value_type;
+            using reference = value_type;
+
+            iterator() = default;
+            iterator(const mapped_flat_map *map, std::size_t index) : map_(map), index_(index) {}
+
+            reference operator*() const { return {map_->key(index_), map_->value(index_)}; }
+            reference operator[](difference_type n) const { return *(*this + n); }
+
+            iterator &operator++() { ++index_; return *this; }
+            iterator operator++(int) { auto copy = *this; ++index_; return copy; }
+            iterator &operator--() { --index_; return *this; }
+            iterator operator--(int) { auto copy = *this; --index_; return copy; }
+            iterator &operator+=(difference_type n) { index_ += n; return *this; }
+            iterator &operator-=(difference_type n) { index_ -= n; return *this; }
+            friend iterator operator+(iterator it, difference_type n) { return it += n; }
+            friend iterator operator+(difference_type n, iterator it) { return it += n; }
+            friend iterator operator-(iterator it, difference_type n) { return it -= n; }
+            friend difference_type operator-(iterator a, iterator b)
+            {
+                return static_cast<difference_type>(a.index_) - static_cast<difference_type>(b.index_);
+            }
+            friend bool operator==(iterator a, iterator b) { return a.index_ == b.index_; }
+            friend auto operator<=>(iterator a, iterator b) { return a.index_ <=> b.index_; }
+
+        private:
+            const mapped_flat_map *map_ = nullptr;
+            std::size_t index_ = 0;
+        };
+
+        /**
+         * @brief Constructs an empty map that is not backed by a file.
+         */
+        mapped_flat_map() = default;
+
+        /**
+         * @brief Maps the file at @p path and validates it to the requested depth.
+         * @return The map, or a description of why the file was rejected.
+         */
+        static std::expected<mapped_flat_map, std::string> open(const std::filesystem::path &file_path,
+                                                                mapped_verify verify = mapped_verify::header)
+        {
+            const std::string path = file_path.string();
+            auto file = mapped_file::open(path);
+            if (!file)
+            {
+                return std::unexpected(file.error());
+            }
+
+            mapped_flat_map map;
+            map.file_ = std::move(*file);
+            const auto bytes = map.file_.bytes();
+            if (bytes.size() < sizeof(mapped_flat_map_header))
+            {
+                return std::unexpected(path + ": file too small for header");
+            }
+
+            mapped_flat_map_header header;
+            std::memcpy(&header, bytes.data(), sizeof(header));
+            if (header.magic != mapped_flat_map_header::expected_magic)
+            {
+                return std::unexpected(path + ": not a mapped flat_map file");
+            }
+            if (header.version != mapped_flat_map_header::current_version)
+            {
+                return std::unexpected(path + ": unsupported version " + std::to_string(header.version));
+            }
+            if (header.value_size != sizeof(T))
+            {
+                return std::unexpected(path + ": value size mismatch");
+            }
+            if (header.count > bytes.size() / sizeof(std::uint64_t))
+            {
+                return std::unexpected(path + ": entry count out of range");
+            }
+            const std::uint64_t values_end = header.values_offset + header.count * sizeof(T);
+            if (header.offsets_offset != sizeof(mapped_flat_map_header) ||
+                header.values_offset != header.offsets_offset + (header.count + 1) * sizeof(std::uint64_t) ||
+                header.blob_offset != detail::align8(values_end) ||
+                header.blob_offset > bytes.size() || header.blob_size > bytes.size() - header.blob_offset)
+            {
+                return std::unexpected(path + ": section bounds out of range");
+            }
+
+            map.size_ = header.count;
+            map.offsets_ = reinterpret_cast<const std::uint64_t *>(bytes.data() + header.offsets_offset);
+            map.values_ = reinterpret_cast<const T *>(bytes.data() + header.values_offset);
+            map.blob_ = reinterpret_cast<const char *>(bytes.data() + header.blob_offset);
+
+            if (verify == mapped_verify::full)
+            {
+                checksum64 checksum;
+                checksum.update(bytes.subspan(sizeof(mapped_flat_map_header)));
+                if (checksum.value() != header.checksum)
+                {
+                    return std::unexpected(path + ": checksum mismatch");
+                }
+                for (std::size_t i = 0; i < map.size_; ++i)
+                {
+                    if (map.offsets_[i] > map.offsets_[i + 1])
+                    {
+                        return std::unexpected(path + ": key offsets not monotonic");
+                    }
+                }
+                if (map.offsets_[0] != 0 || map.offsets_[map.size_] != header.blob_size)
+                {
+                    return std::unexpected(path + ": key offsets do not cover the blob");
+                }
+            }
+            return map;
+        }
+
+        std::size_t size() const noexcept { return size_; }
+        bool empty() const noexcept { return size_ == 0; }
+
+        /**
+         * @brief Returns key @p i, a view into the mapping.
+         */
+        std::string_view key(std::size_t i) const noexcept
+        {
+            return {blob_ + offsets_[i], static_cast<std::size_t>(offsets_[i + 1] - offsets_[i])};
+        }
+
+        /**
+         * @brief Returns value @p i, a reference into the mapping.
+         */
+        const T &value(std::size_t i) const noexcept { return values_[i]; }
+
+        iterator begin() const noexcept { return {this, 0}; }
+        iterator end() const noexcept { return {this, size_}; }
+
+        /**
+         * @brief Returns the first entry whose key is not less than @p key. O(log n).
+         */
+        iterator lower_bound(std::string_view key) const noexcept
+        {
+            std::size_t lo = 0;
+            std::size_t hi = size_;
+            while (lo < hi)
+            {
+                const std::size_t mid = lo + (hi - lo) / 2;
+                if (this->key(mid) < key)
+                {
+                    lo = mid + 1;
+                }
+                else
+                {
+                    hi = mid;
+                }
+            }
+            return {this, lo};
+        }
+
+        /**
+         * @brief Finds the entry for @p key. O(log n), no allocation.
+         */
+        iterator find(std::string_view key) const noexcept
+        {
+            const iterator it = lower_bound(key);
+            return it != end() && (*it).first == key ? it : end();
+        }
+
+        bool contains(std::string_view key) const noexcept { return find(key) != end(); }
+
+        /**
+         * @brief Returns the value for @p key. O(log n), no allocation.
+         * @throws std::out_of_range if the key is absent.
+         */
+        const T &at(std::string_view key) const
+        {
+            const iterator it = find(key);
+            if (it == end())
+            {
+                throw std::out_of_range("mapped_flat_map::at: key not found");
+            }
+            return (*it).second;
+        }
+
+    private:
+        mapped_file file_;
+        std::size_t size_ = 0;
+        const std::uint64_t *offsets_ = nullptr;
+        const T *values_ = nullptr;
+        const char *blob_ = nullptr;
+    };
+} // namespace learnings
@@ -0,0 +1,455 @@
+/**
+ * @file multi_pattern.hpp
+ * @brief Single-pass search for many needles: Aho-Corasick and Teddy.
+ *
+ * Checking k keywords with k `contains` calls reads the haystack k times.
+ * Both matchers here are compiled once from the needle list and then report
+ * every occurrence of every needle in one pass:
+ *
+ *  - `aho_corasick` walks a DFA over the trie of all needles, one table
+ *    lookup per haystack byte whatever the number of needles. Bytes that occur
+ *    in no needle share one input class, which keeps the table narrow.
+ *  - `teddy_matcher` (from Hyperscan and the Rust regex crate) tests 16 start
+ *    positions at once: `pshufb` nibble tables map the first bytes of the
+ *    haystack to a bitmask of the 8 needle buckets they could begin, and only
+ *    positions with a non-empty mask are verified. It wins for a few dozen
+ *    needles, after which the buckets fill up and verification dominates.
+ *
+ * `multi_pattern_matcher` picks between them.
+ */
+
+#pragma once
+
+#include "simd_dispatch.hpp"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <numeric>
+#include <queue>
+#include <ranges>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <variant>
+#include <vector>
+
+namespace learnings
+{
+    /**
+     * @brief One occurrence of a needle.
+     */
+    struct pattern_match
+    {
+        std::size_t pattern;  ///< Index of the needle in the list the matcher was compiled from.
+        std::size_t position; ///< Offset of the first byte of the occurrence.
+
+        friend bool operator==(const pattern_match &, const pattern_match &) = default;
+    };
+
+    /**
+     * @brief Aho-Corasick automaton over byte classes, stored as a dense DFA.
+     * @details Memory is `states x classes x 4` bytes, where states is at most
+     *          the total needle length and classes is the number of distinct
+     *          needle bytes plus one.
+     */
+    class aho_corasick
+    {
+    public:
+        aho_corasick() = default;
+
+        /**
+         * @brief Compiles the needles. O(total length x classes). Empty needles never match.
+         * @param needles Any range of values convertible to `std::string_view`.
+         * @throws std::length_error if the transition table would exceed 2^31 entries.
+         */
+        template <typename Range>
+        explicit aho_corasick(const Range &needles)
+        {
+            for (const auto &needle : needles)
+            {
+                lengths_.push_back(std::string_view(needle).size());
+            }
+            build_classes(needles);
+
+            // Trie; 0 in a transition means "absent" until the failure pass fills it.
+            std::vector<std::vector<std::uint32_t>> own(1);
+            next_.assign(classes_, 0);
+            std::uint32_t pattern = 0;
+            for (const auto &needle : needles)
+            {
+                const std::string_view view(needle);
+                if (!view.empty())
+                {
+                    std::uint32_t state = 0;
+                    for (const char c : view)
+                    {
+                        std::uint32_t &slot = next_[state * classes_ + class_of(c)];
+                        if (slot == 0)
+                        {
+                            slot = static_cast<std::uint32_t>(own.size());
+                            own.emplace_back();
+                            next_.resize(next_.size() + classes_, 0);
+                        }
+                        state = next_[state * classes_ + class_of(c)]; // `slot` may dangle after the resize.
+                    }
+                    own[state].push_back(pattern);
+                }
+                ++pattern;
+            }
+
+            // Breadth-first: a state's failure target is shallower, so it is final when read.
+            const std::size_t states = own.size();
+            std::vector<std::uint32_t> fail(states, 0);
+            std::vector<std::vector<std::uint32_t>> outputs(states);
+            std::queue<std::uint32_t> pending;
+            for (std::size_t c = 0; c < classes_; ++c)
+            {
+                if (const std::uint32_t child = next_[c]; child != 0)
+                {
+                    pending.push(child);
+                }
+            }
+            while (!pending.empty())
+            {
+                const std::uint32_t state = pending.front();
+                pending.pop();
+                outputs[state] = own[state];
+                const auto &inherited = outputs[fail[state]];
+                outputs[state].insert(outputs[state].end(), inherited.begin(), inherited.end());
+                for (std::size_t c = 0; c < classes_; ++c)
+                {
+                    std::uint32_t &slot = next_[state * classes_ + c];
+                    const std::uint32_t fallback = next_[fail[state] * classes_ + c];
+                    if (slot == 0)
+                    {
+                        slot = fallback;
+                    }
+                    else
+                    {
+                        fail[slot] = fallback;
+                        pending.push(slot);
+                    }
+                }
+            }
+
+            output_begin_.reserve(states + 1);
+            for (const auto &list : outputs)
+            {
+                output_begin_.push_back(static_cast<std::uint32_t>(output_.size()));
+                output_.insert(output_.end(), list.begin(), list.end());
+            }
+            output_begin_.push_back(static_cast<std::uint32_t>(output_.size()));
+
+            // Store targets as row offsets tagged with "has output", so the
+            // scan needs neither a multiply nor a second load per byte.
+            if (next_.size() > output_flag)
+            {
+                throw std::length_error("aho_corasick: transition table exceeds 2^31 entries");
+            }
+            for (std::uint32_t &target : next_)
+            {
+                const bool reports = !outputs[target].empty();
+                target = static_cast<std::uint32_t>(target * classes_) | (reports ? output_flag : 0);
+            }
+        }
+
+        std::size_t pattern_count() const noexcept { return lengths_.size(); }
+        std::size_t state_count() const noexcept { return output_begin_.empty() ? 0 : output_begin_.size() - 1; }
+
+        /**
+         * @brief Calls @p fn(pattern_match) for every occurrence, in order of the position where it ends.
+         */
+        template <typename F>
+        void for_each_match(std::string_view haystack, F &&fn) const
+        {
+            if (next_.empty())
+            {
+                return;
+            }
+            std::uint32_t row = 0;
+            for (std::size_t i = 0; i < haystack.size(); ++i)
+            {
+                const std::uint32_t entry = next_[row + class_of(haystack[i])];
+                row = entry & ~output_flag;
+                if ((entry & output_flag) != 0)
+                {
+                    const std::size_t state = row / classes_;
+                    for (std::uint32_t o = output_begin_[state]; o < output_begin_[state + 1]; ++o)
+                    {
+                        fn(pattern_match{output_[o], i + 1 - lengths_[output_[o]]});
+                    }
+                }
+            }
+        }
+
+        /**
+         * @brief Returns the heap bytes owned by the automaton.
+         */
+        std::size_t memory_bytes() const noexcept
+        {
+            return next_.capacity() * sizeof(std::uint32_t) + output_.capacity() * sizeof(std::uint32_t) +
+                   output_begin_.capacity() * sizeof(std::uint32_t) + lengths_.capacity() * sizeof(std::size_t);
+        }
+
+    private:
+        static constexpr std::uint32_t output_flag = 0x8000'0000;
+
+        template <typename Range>
+        void build_classes(const Range &needles)
+        {
+            std::array<bool, 256> used{};
+            for (const auto &needle : needles)
+            {
+                for (const char c : std::string_view(needle))
+                {
+                    used[static_cast<unsigned char>(c)] = true;
+                }
+            }
+            classes_ = 1; // Class 0: every byte that no needle contains.
+            for (std::size_t byte = 0; byte < 256; ++byte)
+            {
+                class_of_[byte] = used[byte] ? static_cast<std::uint16_t>(classes_++) : 0;
+            }
+        }
+
+        std::size_t class_of(char c) const noexcept { return class_of_[static_cast<unsigned char>(c)]; }
+
+        std::array<std::uint16_t, 256> class_of_{}; ///< Up to 257 classes when every byte occurs.
+        std::size_t classes_ = 1;
+        std::vector<std::uint32_t> next_;           ///< `next_[row + class]`: target row, plus `output_flag`.
+        std::vector<std::uint32_t> output_;         ///< Patterns ending in each state, including via failure links.
+        std::vector<std::uint32_t> output_begin_;   ///< Per state, its first entry in `output_`; one extra at the end.
+        std::vector<std::size_t> lengths_;
+    };
+
+    /**
+     * @brief Teddy matcher for small needle sets, with SSSE3 nibble-table filtering.
+     * @details Needles are sorted and split into 8 buckets so that needles with
+     *          similar beginnings share a bucket. Without SSSE3 every start
+     *          position is verified directly.
+     */
+    class teddy_matcher
+    {
+    public:
+        static constexpr std::size_t buckets = 8;
+
+        teddy_matcher() = default;
+
+        /**
+         * @brief Compiles the needles. Empty needles never match.
+         */
+        template <typename Range>
+        explicit teddy_matcher(const Range &needles)
+        {
+            for (const auto &needle : needles)
+            {
+                needles_.emplace_back(std::string_view(needle));
+            }
+            std::vector<std::uint32_t> order(needles_.size());
+            std::iota(order.begin(), order.end(), 0);
+            std::erase_if(order, [this](std::uint32_t i) { return needles_[i].empty(); });
+            std::ranges::sort(order, {}, [this](std::uint32_t i) -> std::string_view { return needles_[i]; });
+
+            fingerprint_ = 3;
+            for (const std::uint32_t i : order)
+            {
+                fingerprint_ = std::min(fingerprint_, needles_[i].size());
+            }
+            for (std::size_t rank = 0; rank < order.size(); ++rank)
+            {
+                const std::uint32_t i = order[rank];
+                const std::size_t bucket = rank * buckets / order.size();
+                buckets_[bucket].push_back(i);
+                for (std::size_t k = 0; k < fingerprint_; ++k)
+                {
+                    const auto byte = static_cast<unsigned char>(needles_[i][k]);
+                    low_[k][byte & 0xf] |= static_cast<std::uint8_t>(1u << bucket);
+                    high_[k][byte >> 4] |= static_cast<std::uint8_t>(1u << bucket);
+                }
+            }
+        }
+
+        std::size_t pattern_count() const noexcept { return needles_.size(); }
+
+        /**
+         * @brief Calls @p fn(pattern_match) for every occurrence, in order of start position.
+         */
+        template <typename F>
+        void for_each_match(std::string_view haystack, F &&fn) const
+        {
+            if (fingerprint_ == 0 || needles_.empty())
+            {
+                return;
+            }
+            std::size_t i = 0;
+#if LEARNINGS_SIMD_X86
+            if (active_simd_level() >= simd_level::ssse3)
+            {
+                i = scan_ssse3(haystack, fn);
+            }
+#endif
+            for (; i < haystack.size(); ++i)
+            {
+                verify(haystack, i, 0xff, fn);
+            }
+        }
+
+    private:
+        /**
+         * @brief Reports the needles of the buckets in @p mask that occur at @p position.
+         */
+        template <typename F>
+        void verify(std::string_view haystack, std::size_t position, unsigned mask, F &fn) const
+        {
+            const std::string_view rest = haystack.substr(position);
+            while (mask != 0)
+            {
+                const int bucket = std::countr_zero(mask);
+                mask &= mask - 1;
+                for (const std::uint32_t i : buckets_[bucket])
+                {
+                    if (rest.starts_with(needles_[i]))
+                    {
+                        fn(pattern_match{i, position});
+                    }
+                }
+            }
+        }
+
+#if LEARNINGS_SIMD_X86
+        /**
+         * @brief Filters whole 16-byte blocks of start positions; returns the first position not scanned.
+         */
+        template <typename F>
+        LEARNINGS_TARGET("ssse3")
+        std::size_t scan_ssse3(std::string_view haystack, F &fn) const
+        {
+            __m128i low[3];
+            __m128i high[3];
+            for (std::size_t k = 0; k < fingerprint_; ++k)
+            {
+                low[k] = _mm_loadu_si128(reinterpret_cast<const __m128i *>(low_[k].data()));
+                high[k] = _mm_loadu_si128(reinterpret_cast<const __m128i *>(high_[k].data()));
+            }
+            const __m128i nibble = _mm_set1_epi8(0x0f);
+            std::size_t i = 0;
+            for (; i + fingerprint_ - 1 + 16 <= haystack.size(); i += 16)
+            {
+                // Lane j: buckets whose needles could start with haystack[i + j ...].
+                __m128i candidates = _mm_set1_epi8(static_cast<char>(0xff));
+                for (std::size_t k = 0; k < fingerprint_; ++k)
+                {
+                    const __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i *>(haystack.data() + i + k));
+                    const __m128i lo = _mm_shuffle_epi8(low[k], _mm_and_si128(bytes, nibble));
+                    const __m128i hi = _mm_shuffle_epi8(high[k], _mm_and_si128(_mm_srli_epi16(bytes, 4), nibble));
+                    candidates = _mm_and_si128(candidates, _mm_and_si128(lo, hi));
+                }
+                auto lanes = static_cast<std::uint32_t>(
+                    ~_mm_movemask_epi8(_mm_cmpeq_epi8(candidates, _mm_setzero_si128())) & 0xffff);
+                if (lanes == 0)
+                {
+                    continue;
+                }
+                alignas(16) std::uint8_t masks[16];
+                _mm_store_si128(reinterpret_cast<__m128i *>(masks), candidates);
+                while (lanes != 0)
+                {
+                    const int lane = std::countr_zero(lanes);
+                    lanes &= lanes - 1;
+                    verify(haystack, i + lane, masks[lane], fn);
+                }
+            }
+            return i;
+        }
+#endif
+
+        std::vector<std::string> needles_;
+        std::array<std::vector<std::uint32_t>, buckets> buckets_;
+        std::array<std::array<std::uint8_t, 16>, 3> low_{};  ///< Per fingerprint byte: low nibble -> bucket bits.
+        std::array<std::array<std::uint8_t, 16>, 3> high_{}; ///< Per fingerprint byte: high nibble -> bucket bits.
+        std::size_t fingerprint_ = 0;                         ///< Leading needle bytes filtered on, 1 to 3.
+    };
+
+    /**
+     * @brief Compiled needle set that uses Teddy for small sets and Aho-Corasick otherwise.
+     */
+    class multi_pattern_matcher
+    {
+    public:
+        /// Largest set handed to Teddy; beyond this its buckets hold too many needles to verify cheaply.
+        static constexpr std::size_t teddy_max_patterns = 32;
+
+        multi_pattern_matcher() = default;
+
+        template <typename Range>
+        explicit multi_pattern_matcher(const Range &needles)
+        {
+            const auto count = static_cast<std::size_t>(std::ranges::distance(needles));
+            if (count <= teddy_max_patterns && active_simd_level() >= simd_level::ssse3)
+            {
+                matcher_.emplace<teddy_matcher>(needles);
+            }
+            else
+            {
+                matcher_.emplace<aho_corasick>(needles);
+            }
+        }
+
+        multi_pattern_matcher(std::initializer_list<std::string_view> needles)
+            : multi_pattern_matcher(std::span<const std::string_view>(needles.begin(), needles.size()))
+        {
+        }
+
+        /**
+         * @brief Returns "teddy" or "aho_corasick".
+         */
+        std::string_view engine() const noexcept
+        {
+            return std::holds_alternative<teddy_matcher>(matcher_) ? "teddy" : "aho_corasick";
+        }
+
+        /**
+         * @brief Calls @p fn(pattern_match) for every occurrence of every needle, in one pass.
+         */
+        template <typename F>
+        void for_each_match(std::string_view haystack, F &&fn) const
+        {
+            std::visit([&](const auto &matcher) { matcher.for_each_match(haystack, fn); }, matcher_);
+        }
+
+        /**
+         * @brief Returns every occurrence, sorted by position and then needle index.
+         */
+        std::vector<pattern_match> find_all(std::string_view haystack) const
+        {
+            std::vector<pattern_match> matches;
+            for_each_match(haystack, [&](pattern_match m) { matches.push_back(m); });
+            std::ranges::sort(matches, {}, [](const pattern_match &m) { return std::pair(m.position, m.pattern); });
+            return matches;
+        }
+
+        /**
+         * @brief Returns, per needle, whether it occurs in @p haystack.
+         */
+        std::vector<bool> contains_each(std::string_view haystack) const
+        {
+            std::vector<bool> found(pattern_count());
+            for_each_match(haystack, [&](pattern_match m) { found[m.pattern] = true; });
+            return found;
+        }
+
+        std::size_t pattern_count() const noexcept
+        {
+            return std::visit([](const auto &matcher) { return matcher.pattern_count(); }, matcher_);
+        }
+
+    private:
+        std::variant<aho_corasick, teddy_matcher> matcher_;
+    };
+} // namespace learnings
@@ -0,0 +1,87 @@
+/**
+ * @file my_class.hpp
+ * @brief `MyClass` from C++23.cpp, with its payload type and accessor tracing chosen at compile time.
+ *
+ * `get_value` demonstrates deduced `this`: one template that returns a
+ * reference into mutable objects, a copy or const reference from const
+ * ones, and moves the payload out of rvalues, so that
+ * `make_list().get_value()` costs a move instead of a deep copy. Each call
+ * reports the object's category through the `Trace` policy of
+ * access_trace.hpp, so a build with `LEARNINGS_ACCESS_TRACE=none` turns every
+ * call into a plain load or move.
+ */
+
+#pragma once
+
+#include "access_trace.hpp"
+
+#include <type_traits>
+#include <utility>
+
+namespace learnings
+{
+    /**
+     * @brief A class demonstrating deduced `this` in C++23.
+     * @tparam T The payload type.
+     * @tparam Trace How accesses are recorded; see access_trace.hpp.
+     * @details Deduced `this` allows a single member function to see the
+     *          cv-qualifiers and value category of the object it is called on.
+     */
+    template <typename T = int, access_trace_policy Trace = default_access_trace>
+    class basic_my_class
+    {
+        T value_{};
+
+    public:
+        using value_type = T;
+
+        /// Whether const objects hand out copies instead of references: the payload fits in two registers.
+        static constexpr bool returns_by_value = std::is_trivially_copyable_v<T> && sizeof(T) <= 2 * sizeof(void *);
+
+        /**
+         * @brief Constructor for MyClass.
+         * @param val Initial value.
+         */
+        basic_my_class(T val) : value_(std::move(val)) {}
+
+        /**
+         * @brief Returns the value in the form that suits the object's value category.
+         * @param self The object itself (deduced `this`).
+         * @return - a non-const object: `T &`;
+         *         - a const object: `T` if `returns_by_value`, else `const T &`;
+         *         - a non-const rvalue: `T`, moved out of the expiring object.
+         * @details Returning `T` rather than `T &&` for rvalues keeps
+         *          `auto &&v = make().get_value()` from dangling, at the cost
+         *          of one move.
+         */
+        template <typename Self>
+        decltype(auto) get_value(this Self &&self)
+        { ///< C++23: Deduced `this` replaces the `const &`, `&` and `&&` overloads.
+            if constexpr (std::is_const_v<std::remove_reference_t<Self>>)
+            {
+                Trace::record(&self, access_kind::const_ref);
+                if constexpr (returns_by_value)
+                {
+                    return T(self.value_);
+                }
+                else
+                {
+                    return static_cast<const T &>(self.value_);
+                }
+            }
+            else if constexpr (std::is_lvalue_reference_v<Self>)
+            {
+                Trace::record(&self, access_kind::mutable_ref);
+                return static_cast<T &>(self.value_);
+            }
+            else
+            {
+                Trace::record(&self, access_kind::rvalue);
+                return T(std::move(self.value_));
+            }
+        }
+    };
+} // namespace learnings
+
+/// The class used in C++23.cpp, traced by the build's `LEARNINGS_ACCESS_TRACE` policy.
+using MyClass = learnings::basic_my_class<>;
@@ -0,0 +1,267 @@
+/**
+ * @file parallel_file_search.hpp
+ * @brief Multi-threaded substring search over large buffers and mapped files.
+ *
+ * A single core running `simd_find` is limited to a few GB/s, well below what
+ * the page cache (and fast NVMe) can deliver, so archives of log files are
+ * searched in chunks on several threads. A chunk owns a range of start
+ * positions and reads `needle.size() - 1` bytes past its end, so a match that
+ * straddles a boundary is found exactly once, by the chunk it starts in.
+ * Workers take chunks in file order from a shared counter, which balances
+ * uneven chunks and lets `find_first` stop all workers once no unclaimed chunk
+ * can hold an earlier match.
+ *
+ * For files that are not in the page cache, `file_searcher` marks the mapping
+ * sequential and asks for each worker's next chunk to be read ahead while it
+ * searches the current one.
+ */
+
+#pragma once
+
+#include "compiled_needle.hpp"
+#include "mapped_file.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <expected>
+#include <numeric>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace learnings
+{
+    /**
+     * @brief Tuning for the parallel searches.
+     */
+    struct parallel_search_options
+    {
+        unsigned threads = std::max(std::thread::hardware_concurrency(), 1u);
+        std::size_t chunk_bytes = std::size_t{8} << 20; ///< Start positions per chunk.
+        bool readahead = true;                           ///< For files: advise `will_need` on upcoming chunks.
+    };
+
+    namespace detail
+    {
+        /**
+         * @brief Runs @p search(chunk, begin) for every chunk of @p text on up to `options.threads` threads.
+         * @details @p search returns false to stop workers from claiming more
+         *          chunks. @p file, if not null, is the mapping behind @p text.
+         */
+        template <typename Search>
+        void for_each_chunk(std::string_view text, std::string_view needle, const parallel_search_options &options,
+                            const mapped_file *file, Search search)
+        {
+            const std::size_t chunk = std::max<std::size_t>(options.chunk_bytes, 1);
+            const std::size_t chunks = (text.size() + chunk - 1) / chunk;
+            if (chunks == 0)
+            {
+                return;
+            }
+            const std::size_t overlap = needle.empty() ? 0 : needle.size() - 1;
+            std::atomic<std::size_t> next{0};
+            std::atomic<bool> stop{false};
+            const unsigned threads = static_cast<unsigned>(std::clamp<std::size_t>(options.threads, 1, chunks));
+
+            auto worker = [&] {
+                // `stop` is checked before a claim, never between a claim and its search: a claimed
+                // chunk that went unsearched could hide the first match from find_first_chunked.
+                while (!stop.load())
+                {
+                    const std::size_t k = next.fetch_add(1, std::memory_order_relaxed);
+                    if (k >= chunks)
+                    {
+                        break;
+                    }
+                    if (file != nullptr && options.readahead && k + threads < chunks)
+                    {
+                        // Likely this worker's next chunk; the kernel reads it while this one is searched.
+                        (void)file->advise(access_advice::will_need, (k + threads) * chunk, chunk + overlap);
+                    }
+                    const std::size_t begin = k * chunk;
+                    if (!search(text.substr(begin, chunk + overlap), begin))
+                    {
+                        stop.store(true);
+                    }
+                }
+            };
+            {
+                std::vector<std::jthread> workers;
+                for (unsigned i = 1; i < threads; ++i)
+                {
+                    workers.emplace_back(worker);
+                }
+                worker(); // The calling thread searches too.
+            } // jthreads join here.
+        }
+
+        inline std::optional<std::size_t> find_first_chunked(std::string_view text, std::string_view needle,
+                                                             const parallel_search_options &options,
+                                                             const mapped_file *file)
+        {
+            if (needle.empty())
+            {
+                return std::optional<std::size_t>(0);
+            }
+            const compiled_needle compiled(needle);
+            std::atomic<std::size_t> best{std::string_view::npos};
+            for_each_chunk(text, needle, options, file, [&](std::string_view chunk, std::size_t begin) {
+                if (begin > best.load(std::memory_order_relaxed))
+                {
+                    return false; // Chunks are claimed in order: none after this one can do better.
+                }
+                const std::size_t hit = compiled.find(chunk);
+                if (hit == std::string_view::npos)
+                {
+                    return true;
+                }
+                std::size_t current = best.load(std::memory_order_relaxed);
+                while (begin + hit < current && !best.compare_exchange_weak(current, begin + hit))
+                {
+                }
+                return false;
+            });
+            const std::size_t first = best.load();
+            return first == std::string_view::npos ? std::nullopt : std::optional<std::size_t>(first);
+        }
+
+        inline std::size_t count_chunked(std::string_view text, std::string_view needle,
+                                         const parallel_search_options &options, const mapped_file *file)
+        {
+            if (needle.empty())
+            {
+                return text.size() + 1;
+            }
+            const compiled_needle compiled(needle);
+            std::atomic<std::size_t> total{0};
+            for_each_chunk(text, needle, options, file, [&](std::string_view chunk, std::size_t) {
+                std::size_t count = 0;
+                for (std::size_t pos = compiled.find(chunk); pos != std::string_view::npos;
+                     pos = compiled.find(chunk, pos + 1))
+                {
+                    ++count;
+                }
+                total.fetch_add(count, std::memory_order_relaxed);
+                return true;
+            });
+            return total.load();
+        }
+
+        inline std::vector<std::size_t> find_all_chunked(std::string_view text, std::string_view needle,
+                                                         const parallel_search_options &options,
+                                                         const mapped_file *file)
+        {
+            std::vector<std::size_t> offsets;
+            if (needle.empty())
+            {
+                offsets.resize(text.size() + 1);
+                std::iota(offsets.begin(), offsets.end(), std::size_t{0});
+                return offsets;
+            }
+            const compiled_needle compiled(needle);
+            const std::size_t chunk = std::max<std::size_t>(options.chunk_bytes, 1);
+            std::vector<std::vector<std::size_t>> per_chunk((text.size() + chunk - 1) / chunk);
+            for_each_chunk(text, needle, options, file, [&](std::string_view part, std::size_t begin) {
+                auto &found = per_chunk[begin / chunk];
+                for (std::size_t pos = compiled.find(part); pos != std::string_view::npos;
+                     pos = compiled.find(part, pos + 1))
+                {
+                    found.push_back(begin + pos);
+                }
+                return true;
+            });
+            for (const auto &found : per_chunk)
+            {
+                offsets.insert(offsets.end(), found.begin(), found.end());
+            }
+            return offsets;
+        }
+    } // namespace detail
+
+    /**
+     * @brief Returns the offset of the first occurrence of @p needle in @p text, or `std::nullopt`.
+     */
+    inline std::optional<std::size_t> parallel_find_first(std::string_view text, std::string_view needle,
+                                                          const parallel_search_options &options = {})
+    {
+        return detail::find_first_chunked(text, needle, options, nullptr);
+    }
+
+    /**
+     * @brief Counts the occurrences of @p needle in @p text, overlapping ones included.
+     */
+    inline std::size_t parallel_count(std::string_view text, std::string_view needle,
+                                      const parallel_search_options &options = {})
+    {
+        return detail::count_chunked(text, needle, options, nullptr);
+    }
+
+    /**
+     * @brief Returns the offsets of all occurrences of @p needle in @p text, in increasing order.
+     */
+    inline std::vector<std::size_t> parallel_find_all(std::string_view text, std::string_view needle,
+                                                      const parallel_search_options &options = {})
+    {
+        return detail::find_all_chunked(text, needle, options, nullptr);
+    }
+
+    /**
+     * @brief A mapped file prepared for parallel searches.
+     */
+    class file_searcher
+    {
+    public:
+        /**
+         * @brief Maps @p path and advises sequential access.
+         * @return The searcher, or the error from `mapped_file::open`.
+         */
+        static std::expected<file_searcher, std::string> open(const std::string &path,
+                                                              parallel_search_options options = {})
+        {
+            auto file = mapped_file::open(path);
+            if (!file)
+            {
+                return std::unexpected(std::move(file.error()));
+            }
+            if (options.readahead)
+            {
+                (void)file->advise(access_advice::sequential); // A hint; searching works without it.
+            }
+            return file_searcher(std::move(*file), options);
+        }
+
+        std::string_view text() const noexcept
+        {
+            return {reinterpret_cast<const char *>(file_.data()), file_.size()};
+        }
+
+        const mapped_file &file() const noexcept { return file_; }
+
+        std::optional<std::size_t> find_first(std::string_view needle) const
+        {
+            return detail::find_first_chunked(text(), needle, options_, &file_);
+        }
+
+        std::size_t count(std::string_view needle) const
+        {
+            return detail::count_chunked(text(), needle, options_, &file_);
+        }
+
+        std::vector<std::size_t> find_all(std::string_view needle) const
+        {
+            return detail::find_all_chunked(text(), needle, options_, &file_);
+        }
+
+    private:
+        file_searcher(mapped_file file, parallel_search_options options) : file_(std::move(file)), options_(options)
+        {
+        }
+
+        mapped_file file_;
+        parallel_search_options options_;
+    };
+} // namespace learnings
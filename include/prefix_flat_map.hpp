@@ -0,0 +1,161 @@
+/**
+ * @file prefix_flat_map.hpp
+ * @brief String-keyed flat map that resolves most comparisons on key prefixes.
+ *
+ * A binary search over `std::string` keys dereferences a key's heap buffer at
+ * every step. `prefix_flat_map` keeps a dense array with the first eight bytes
+ * of each key packed big-endian into a `uint64_t`, so that integer order is
+ * byte order. The search narrows to the run of keys sharing the probe's prefix
+ * using only that array and compares whole strings only inside the run.
+ *
+ * Names, hostnames and paths often share more than eight leading bytes, so
+ * the map can keep several such arrays, one per successive 8-byte word of
+ * the key; each one is only consulted inside the run left by the previous.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <flat_map>
+#include <functional>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace learnings
+{
+    /**
+     * @brief Packs bytes `[8 * word, 8 * word + 8)` of @p s big-endian, zero-padded.
+     * @details For two strings that agree on all earlier words, `a < b`
+     *          implies `key_word(a, w) <= key_word(b, w)`, so successive words
+     *          order keys exactly except inside runs of ties.
+     */
+    inline std::uint64_t key_word(std::string_view s, std::size_t word) noexcept
+    {
+        unsigned char bytes[8] = {};
+        const std::size_t begin = 8 * word;
+        if (begin < s.size())
+        {
+            std::memcpy(bytes, s.data() + begin, std::min<std::size_t>(s.size() - begin, 8));
+        }
+        std::uint64_t prefix = 0;
+        for (unsigned char b : bytes)
+        {
+            prefix = (prefix << 8) | b;
+        }
+        return prefix;
+    }
+
+    /**
+     * @brief Read-mostly string-keyed map with parallel prefix arrays.
+     * @tparam T     The mapped type.
+     * @tparam Words Number of 8-byte key words kept in dense arrays.
+     */
+    template <typename T, std::size_t Words = 2>
+    class prefix_flat_map
+    {
+    public:
+        using map_type = std::flat_map<std::string, T>;
+        using const_iterator = typename map_type::const_iterator;
+
+        prefix_flat_map() = default;
+
+        /**
+         * @brief Adopts a finished map and computes its prefix array. O(n).
+         */
+        explicit prefix_flat_map(map_type map) : map_(std::move(map))
+        {
+            for (std::size_t w = 0; w < Words; ++w)
+            {
+                words_[w].reserve(map_.size());
+                for (const auto &key : map_.keys())
+                {
+                    words_[w].push_back(key_word(key, w));
+                }
+            }
+        }
+
+        std::size_t size() const noexcept { return map_.size(); }
+        const_iterator begin() const noexcept { return map_.begin(); }
+        const_iterator end() const noexcept { return map_.end(); }
+
+        /**
+         * @brief Returns the underlying map, e.g. to iterate or to rebuild.
+         */
+        const map_type &map() const noexcept { return map_; }
+
+        /**
+         * @brief Returns the first entry whose key is not less than @p key.
+         */
+        const_iterator lower_bound(std::string_view key) const
+        {
+            // Every key outside [first, last) differs from the probe within the
+            // words examined so far, so the word order alone places it.
+            std::size_t first = 0;
+            std::size_t last = map_.size();
+            for (std::size_t w = 0; w < Words && last - first > 1; ++w)
+            {
+                const std::uint64_t word = key_word(key, w);
+                const auto begin = words_[w].begin();
+                const auto lo = std::lower_bound(begin + first, begin + last, word);
+                const auto hi = std::upper_bound(lo, begin + last, word);
+                first = static_cast<std::size_t>(lo - begin);
+                last = static_cast<std::size_t>(hi - begin);
+            }
+
+            const auto &keys = map_.keys();
+            const auto lo = keys.begin() + static_cast<std::ptrdiff_t>(first);
+            const auto hi = keys.begin() + static_cast<std::ptrdiff_t>(last);
+            const auto it = std::lower_bound(lo, hi, key, [](const std::string &a, std::string_view b) { return a < b; });
+            return map_.begin() + (it - keys.begin());
+        }
+
+        /**
+         * @brief Finds the entry for @p key; only keys in the final prefix run are dereferenced.
+         */
+        const_iterator find(std::string_view key) const
+        {
+            const auto it = lower_bound(key);
+            return it != end() && it->first == key ? it : end();
+        }
+
+        bool contains(std::string_view key) const { return find(key) != end(); }
+
+        /**
+         * @brief Returns the value for @p key.
+         * @throws std::out_of_range if the key is absent.
+         */
+        const T &at(std::string_view key) const
+        {
+            const auto it = find(key);
+            if (it == end())
+            {
+                throw std::out_of_range("prefix_flat_map::at: key not found");
+            }
+            return it->second;
+        }
+
+        /**
+         * @brief Heap bytes owned by the prefix arrays alone.
+         */
+        std::size_t prefix_bytes() const noexcept
+        {
+            std::size_t bytes = 0;
+            for (const auto &word : words_)
+            {
+                bytes += word.capacity() * sizeof(std::uint64_t);
+            }
+            return bytes;
+        }
+
+    private:
+        map_type map_;
+        std::array<std::vector<std::uint64_t>, Words> words_; ///< words_[w][i] == key_word(map_.keys()[i], w).
+    };
+} // namespace learnings
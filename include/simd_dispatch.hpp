@@ -0,0 +1,122 @@
+/**
+ * @file simd_dispatch.hpp
+ * @brief Runtime selection of SIMD kernels on x86.
+ *
+ * The library is built for the baseline instruction set, so wider kernels are
+ * compiled per function with `LEARNINGS_TARGET("avx2")` and only called after
+ * `active_simd_level()` has confirmed that the CPU supports them. Setting the
+ * environment variable `LEARNINGS_SIMD` to `scalar`, `sse2`, `ssse3`, `avx2`
+ * or `avx512` caps the level, which makes it easy to compare kernels on one
+ * machine.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cstdlib>
+#include <iterator>
+#include <string_view>
+
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#define LEARNINGS_SIMD_X86 1
+#define LEARNINGS_TARGET(features) __attribute__((target(features)))
+#elif defined(_M_X64)
+#define LEARNINGS_SIMD_X86 1
+#define LEARNINGS_TARGET(features) // MSVC emits any intrinsic without a per-function target.
+#else
+#define LEARNINGS_SIMD_X86 0
+#define LEARNINGS_TARGET(features)
+#endif
+
+#if LEARNINGS_SIMD_X86
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+#endif
+
+namespace learnings
+{
+    /**
+     * @brief Instruction-set tiers that kernels are written for, in increasing order.
+     */
+    enum class simd_level
+    {
+        scalar,
+        sse2,
+        ssse3,
+        avx2,
+        avx512 ///< AVX-512 F and BW.
+    };
+
+    namespace detail
+    {
+        /// Names of the `simd_level` values, in order, as accepted by `LEARNINGS_SIMD`.
+        inline constexpr std::string_view simd_level_names[] = {"scalar", "sse2", "ssse3", "avx2", "avx512"};
+
+        inline simd_level detect_simd_level() noexcept
+        {
+#if LEARNINGS_SIMD_X86 && (defined(__GNUC__) || defined(__clang__))
+            __builtin_cpu_init();
+            if (__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512bw"))
+            {
+                return simd_level::avx512;
+            }
+            if (__builtin_cpu_supports("avx2"))
+            {
+                return simd_level::avx2;
+            }
+            if (__builtin_cpu_supports("ssse3"))
+            {
+                return simd_level::ssse3;
+            }
+            return __builtin_cpu_supports("sse2") ? simd_level::sse2 : simd_level::scalar;
+#elif LEARNINGS_SIMD_X86
+            int info[4];
+            __cpuid(info, 1);
+            const bool ssse3 = (info[2] & (1 << 9)) != 0;
+            __cpuidex(info, 7, 0);
+            const bool avx2 = (info[1] & (1 << 5)) != 0;
+            const bool avx512 = (info[1] & (1 << 16)) != 0 && (info[1] & (1 << 30)) != 0;
+            // OS support for the wider register state is not checked here.
+            return avx512 ? simd_level::avx512 : avx2 ? simd_level::avx2 : ssse3 ? simd_level::ssse3 : simd_level::sse2;
+#else
+            return simd_level::scalar;
+#endif
+        }
+
+        inline simd_level simd_level_cap() noexcept
+        {
+            const char *cap = std::getenv("LEARNINGS_SIMD");
+            if (cap == nullptr)
+            {
+                return simd_level::avx512;
+            }
+            for (int i = 0; i < std::ssize(simd_level_names); ++i)
+            {
+                if (simd_level_names[i] == cap)
+                {
+                    return static_cast<simd_level>(i);
+                }
+            }
+            return simd_level::avx512;
+        }
+    } // namespace detail
+
+    /**
+     * @brief Returns the widest supported level, capped by `LEARNINGS_SIMD`. Computed once.
+     */
+    inline simd_level active_simd_level() noexcept
+    {
+        static const simd_level level = std::min(detail::detect_simd_level(), detail::simd_level_cap());
+        return level;
+    }
+
+    /**
+     * @brief Returns the level's name as accepted by `LEARNINGS_SIMD`.
+     */
+    constexpr std::string_view to_string(simd_level level) noexcept
+    {
+        return detail::simd_level_names[static_cast<int>(level)];
+    }
+} // namespace learnings
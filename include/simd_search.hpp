@@ -0,0 +1,193 @@
+/**
+ * @file simd_search.hpp
+ * @brief Vectorised substring search for large texts.
+ *
+ * `std::string_view::find` in libstdc++ looks for the needle's first byte with
+ * `memchr` and then compares, which degrades badly when that byte is common,
+ * as spaces and letters are in log text. This search compares the needle's
+ * first and last bytes against a whole register of candidate positions at
+ * once; only positions where both match are verified with `memcmp`, and in
+ * ordinary text that is rare even for short needles. Kernels exist for SSE2
+ * (16 positions per step), AVX2 (32) and AVX-512BW (64) and are picked at run
+ * time through `active_simd_level()`.
+ *
+ * Reference: Wojciech Muła, "SIMD-friendly algorithms for substring searching".
+ */
+
+#pragma once
+
+#include "simd_dispatch.hpp"
+
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+
+namespace learnings
+{
+    namespace detail
+    {
+        /**
+         * @brief Each kernel scans whole blocks of start positions, needs `needle.size() >= 2`, and
+         *        returns the first match (or npos) together with the first start position it did not scan.
+         */
+        struct search_step
+        {
+            std::size_t found;
+            std::size_t scanned;
+        };
+
+#if LEARNINGS_SIMD_X86
+        /**
+         * @brief Returns the offset in @p p of the first verified candidate in @p mask, or npos.
+         * @details Bit i of @p mask means that the needle's first and last bytes
+         *          match at `p + i`; the bytes between them are checked here.
+         */
+        template <typename Mask>
+        inline std::size_t verify_candidates(const char *p, Mask mask, std::string_view needle) noexcept
+        {
+            while (mask != 0)
+            {
+                const int bit = std::countr_zero(mask);
+                if (std::memcmp(p + bit + 1, needle.data() + 1, needle.size() - 2) == 0)
+                {
+                    return static_cast<std::size_t>(bit);
+                }
+                mask &= mask - 1;
+            }
+            return std::string_view::npos;
+        }
+
+        inline search_step find_sse2(std::string_view haystack, std::string_view needle) noexcept
+        {
+            const std::size_t last = needle.size() - 1;
+            const __m128i first_byte = _mm_set1_epi8(needle.front());
+            const __m128i last_byte = _mm_set1_epi8(needle.back());
+            std::size_t i = 0;
+            for (; i + last + 16 <= haystack.size(); i += 16)
+            {
+                const char *p = haystack.data() + i;
+                const __m128i head = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p));
+                const __m128i tail = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p + last));
+                const __m128i both = _mm_and_si128(_mm_cmpeq_epi8(head, first_byte), _mm_cmpeq_epi8(tail, last_byte));
+                const auto mask = static_cast<std::uint32_t>(_mm_movemask_epi8(both));
+                if (mask != 0)
+                {
+                    const std::size_t hit = verify_candidates(p, mask, needle);
+                    if (hit != std::string_view::npos)
+                    {
+                        return {i + hit, i};
+                    }
+                }
+            }
+            return {std::string_view::npos, i};
+        }
+
+        LEARNINGS_TARGET("avx2")
+        inline search_step find_avx2(std::string_view haystack, std::string_view needle) noexcept
+        {
+            const std::size_t last = needle.size() - 1;
+            const __m256i first_byte = _mm256_set1_epi8(needle.front());
+            const __m256i last_byte = _mm256_set1_epi8(needle.back());
+            std::size_t i = 0;
+            for (; i + last + 32 <= haystack.size(); i += 32)
+            {
+                const char *p = haystack.data() + i;
+                const __m256i head = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p));
+                const __m256i tail = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p + last));
+                const __m256i both =
+                    _mm256_and_si256(_mm256_cmpeq_epi8(head, first_byte), _mm256_cmpeq_epi8(tail, last_byte));
+                const auto mask = static_cast<std::uint32_t>(_mm256_movemask_epi8(both));
+                if (mask != 0)
+                {
+                    const std::size_t hit = verify_candidates(p, mask, needle);
+                    if (hit != std::string_view::npos)
+                    {
+                        return {i + hit, i};
+                    }
+                }
+            }
+            return {std::string_view::npos, i};
+        }
+
+        LEARNINGS_TARGET("avx512f,avx512bw")
+        inline search_step find_avx512(std::string_view haystack, std::string_view needle) noexcept
+        {
+            const std::size_t last = needle.size() - 1;
+            const __m512i first_byte = _mm512_set1_epi8(needle.front());
+            const __m512i last_byte = _mm512_set1_epi8(needle.back());
+            std::size_t i = 0;
+            for (; i + last + 64 <= haystack.size(); i += 64)
+            {
+                const char *p = haystack.data() + i;
+                const __m512i head = _mm512_loadu_si512(p);
+                const __m512i tail = _mm512_loadu_si512(p + last);
+                const std::uint64_t mask =
+                    _mm512_cmpeq_epi8_mask(head, first_byte) & _mm512_cmpeq_epi8_mask(tail, last_byte);
+                if (mask != 0)
+                {
+                    const std::size_t hit = verify_candidates(p, mask, needle);
+                    if (hit != std::string_view::npos)
+                    {
+                        return {i + hit, i};
+                    }
+                }
+            }
+            return {std::string_view::npos, i};
+        }
+#endif
+    } // namespace detail
+
+    /**
+     * @brief Returns the position of the first occurrence of @p needle at or after @p pos, or npos.
+     * @details Same contract as `std::string_view::find(needle, pos)`. O(n)
+     *          expected; matches of the first and last byte that fail the
+     *          middle comparison cost a `memcmp` each.
+     */
+    inline std::size_t simd_find(std::string_view haystack, std::string_view needle, std::size_t pos = 0) noexcept
+    {
+        if (pos > haystack.size() || needle.size() > haystack.size() - pos)
+        {
+            return std::string_view::npos;
+        }
+        if (needle.size() < 2)
+        {
+            return haystack.find(needle, pos); // Empty or single byte: memchr is already vectorised.
+        }
+        const std::string_view rest = haystack.substr(pos);
+        detail::search_step step{std::string_view::npos, 0};
+#if LEARNINGS_SIMD_X86
+        // Below a few registers of text the dispatch and tail handling cost
+        // more than the library's memchr-and-compare.
+        const simd_level level = rest.size() < 128 ? simd_level::scalar : active_simd_level();
+        if (level >= simd_level::avx512)
+        {
+            step = detail::find_avx512(rest, needle);
+        }
+        else if (level >= simd_level::avx2)
+        {
+            step = detail::find_avx2(rest, needle);
+        }
+        else if (level >= simd_level::sse2)
+        {
+            step = detail::find_sse2(rest, needle);
+        }
+        if (step.found != std::string_view::npos)
+        {
+            return pos + step.found;
+        }
+#endif
+        // The last start positions do not fill a register; finish with the library search.
+        const std::size_t tail = rest.find(needle, step.scanned);
+        return tail == std::string_view::npos ? tail : pos + tail;
+    }
+
+    /**
+     * @brief Returns whether @p haystack contains @p needle; a drop-in for `std::string_view::contains`.
+     */
+    inline bool simd_contains(std::string_view haystack, std::string_view needle) noexcept
+    {
+        return simd_find(haystack, needle) != std::string_view::npos;
+    }
+} // namespace learnings
@@ -0,0 +1,386 @@
+/**
+ * @file snapshot_flat_map.hpp
+ * @brief Read-mostly concurrent `std::flat_map` built on immutable snapshots.
+ *
+ * Readers load the current snapshot through an atomic pointer and never take
+ * a lock. Writers stage updates, and `publish()` folds a whole batch into a
+ * fresh copy of the map and swaps it in. Superseded snapshots are freed with
+ * epoch-based reclamation once no reader can still be looking at them.
+ */
+
+#pragma once
+
+#include "flat_map_bulk.hpp"
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <flat_map>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace learnings
+{
+    namespace detail
+    {
+        /// Upper bound on threads that may read from an `epoch_domain` at the same time.
+        inline constexpr std::size_t max_reader_threads = 256;
+
+        /**
+         * @brief Hands every thread a small index, recycled when the thread exits.
+         */
+        class thread_index_registry
+        {
+        public:
+            /**
+             * @brief Returns the calling thread's index in [0, max_reader_threads).
+             * @throws std::runtime_error if more threads are alive than supported.
+             */
+            static std::size_t current()
+            {
+                thread_local const owner self;
+                return self.index;
+            }
+
+        private:
+            struct owner
+            {
+                std::size_t index;
+                owner() : index(acquire()) {}
+                ~owner() { release(index); }
+            };
+
+            struct state
+            {
+                std::mutex mutex;
+                std::vector<std::size_t> free;
+                std::size_t next = 0;
+            };
+
+            static state &shared()
+            {
+                static state s;
+                return s;
+            }
+
+            static std::size_t acquire()
+            {
+                auto &s = shared();
+                std::lock_guard lock(s.mutex);
+                if (!s.free.empty())
+                {
+                    const std::size_t index = s.free.back();
+                    s.free.pop_back();
+                    return index;
+                }
+                if (s.next == max_reader_threads)
+                {
+                    throw std::runtime_error("thread_index_registry: too many threads");
+                }
+                return s.next++;
+            }
+
+            static void release(std::size_t index)
+            {
+                auto &s = shared();
+                std::lock_guard lock(s.mutex);
+                s.free.push_back(index);
+            }
+        };
+    } // namespace detail
+
+    /**
+     * @brief Epoch-based reclamation for objects shared with lock-free readers.
+     *
+     * @details A reader pins the domain for the duration of its access by
+     *          publishing the global epoch in its per-thread slot. An object is
+     *          retired after it has been unlinked; it is freed once every
+     *          pinned reader announced an epoch later than the retirement, as
+     *          such readers started after the unlink and cannot reach it.
+     */
+    class epoch_domain
+    {
+    public:
+        /**
+         * @brief RAII pin; while alive, nothing retired afterwards is freed.
+         */
+        class guard
+        {
+        public:
+            explicit guard(epoch_domain &domain) : domain_(&domain), index_(detail::thread_index_registry::current())
+            {
+                auto &slot = domain_->slots_[index_];
+                if (slot.depth++ == 0)
+                {
+                    slot.epoch.store(domain_->global_epoch_.load());
+                }
+            }
+
+            guard(guard &&other) noexcept
+                : domain_(std::exchange(other.domain_, nullptr)), index_(other.index_)
+            {
+            }
+
+            guard(const guard &) = delete;
+            guard &operator=(const guard &) = delete;
+            guard &operator=(guard &&) = delete;
+
+            ~guard()
+            {
+                if (domain_ != nullptr)
+                {
+                    auto &slot = domain_->slots_[index_];
+                    if (--slot.depth == 0)
+                    {
+                        slot.epoch.store(idle, std::memory_order_release);
+                    }
+                }
+            }
+
+        private:
+            epoch_domain *domain_;
+            std::size_t index_;
+        };
+
+        epoch_domain() = default;
+        epoch_domain(const epoch_domain &) = delete;
+        epoch_domain &operator=(const epoch_domain &) = delete;
+
+        /**
+         * @brief Frees everything still retired; no reader may be pinned.
+         */
+        ~epoch_domain()
+        {
+            for (auto &entry : retired_)
+            {
+                entry.deleter();
+            }
+        }
+
+        /**
+         * @brief Pins the calling thread. Lock-free, and nests on one thread.
+         */
+        guard pin() { return guard(*this); }
+
+        /**
+         * @brief Schedules @p deleter to run once no reader can observe the object.
+         * @details Call only after the object has been unlinked from every
+         *          place a new reader could find it.
+         */
+        void retire(std::function<void()> deleter)
+        {
+            std::lock_guard lock(retired_mutex_);
+            const std::uint64_t epoch = global_epoch_.fetch_add(1);
+            retired_.push_back({epoch, std::move(deleter)});
+        }
+
+        /**
+         * @brief Frees the retired objects that no pinned reader can still see.
+         */
+        void collect()
+        {
+            // Only objects retired before the scan starts are covered by it.
+            const std::uint64_t scan_start = global_epoch_.load();
+            std::uint64_t oldest = scan_start;
+            for (const auto &slot : slots_)
+            {
+                const std::uint64_t epoch = slot.epoch.load();
+                if (epoch != idle && epoch < oldest)
+                {
+                    oldest = epoch;
+                }
+            }
+
+            std::vector<retired> ready;
+            {
+                std::lock_guard lock(retired_mutex_);
+                auto keep = retired_.begin();
+                for (auto &entry : retired_)
+                {
+                    if (entry.epoch < oldest)
+                    {
+                        ready.push_back(std::move(entry));
+                    }
+                    else
+                    {
+                        if (&*keep != &entry)
+                        {
+                            *keep = std::move(entry);
+                        }
+                        ++keep;
+                    }
+                }
+                retired_.erase(keep, retired_.end());
+            }
+            for (auto &entry : ready)
+            {
+                entry.deleter();
+            }
+        }
+
+    private:
+        static constexpr std::uint64_t idle = 0;
+
+        struct alignas(64) slot
+        {
+            std::atomic<std::uint64_t> epoch{idle};
+            std::uint32_t depth = 0; ///< Nesting depth; only touched by the owning thread.
+        };
+
+        struct retired
+        {
+            std::uint64_t epoch;
+            std::function<void()> deleter;
+        };
+
+        std::atomic<std::uint64_t> global_epoch_{1};
+        std::array<slot, detail::max_reader_threads> slots_{};
+        std::mutex retired_mutex_;
+        std::vector<retired> retired_;
+    };
+
+    /**
+     * @brief A `std::flat_map` that many threads read while a few threads update.
+     *
+     * @tparam Key     The key type.
+     * @tparam T       The mapped type.
+     * @tparam Compare The key ordering.
+     * @details Reads cost two atomic stores and an atomic load. An update costs
+     *          a full copy of the map, so updates are staged and published in
+     *          batches: a few publishes per second are cheap even for large maps.
+     */
+    template <typename Key, typename T, typename Compare = std::less<Key>>
+    class snapshot_flat_map
+    {
+    public:
+        using map_type = std::flat_map<Key, T, Compare>;
+
+        /**
+         * @brief A pinned view of one snapshot. Keep it short-lived: it delays reclamation.
+         */
+        class read_handle
+        {
+        public:
+            const map_type &operator*() const noexcept { return *map_; }
+            const map_type *operator->() const noexcept { return map_; }
+
+        private:
+            friend class snapshot_flat_map;
+            read_handle(epoch_domain::guard guard, const map_type *map) : guard_(std::move(guard)), map_(map) {}
+
+            epoch_domain::guard guard_;
+            const map_type *map_;
+        };
+
+        explicit snapshot_flat_map(map_type initial = map_type()) : current_(new map_type(std::move(initial))) {}
+
+        snapshot_flat_map(const snapshot_flat_map &) = delete;
+        snapshot_flat_map &operator=(const snapshot_flat_map &) = delete;
+
+        ~snapshot_flat_map() { delete current_.load(); }
+
+        /**
+         * @brief Pins and returns the current snapshot. Lock-free.
+         */
+        read_handle read() const
+        {
+            auto guard = domain_.pin();
+            return read_handle(std::move(guard), current_.load());
+        }
+
+        /**
+         * @brief Returns a copy of the value for @p key in the current snapshot.
+         */
+        template <typename K>
+        std::optional<T> find(const K &key) const
+        {
+            const auto snapshot = read();
+            const auto it = snapshot->find(key);
+            if (it == snapshot->end())
+            {
+                return std::nullopt;
+            }
+            return it->second;
+        }
+
+        /**
+         * @brief Returns whether the current snapshot holds @p key.
+         * @details Like `find`, a `std::string_view` probe needs a transparent
+         *          `Compare` such as `std::less<>` to avoid a temporary key.
+         */
+        template <typename K>
+        bool contains(const K &key) const
+        {
+            return read()->contains(key);
+        }
+
+        /**
+         * @brief Stages an insert-or-assign for the next `publish()`.
+         */
+        void stage_assign(Key key, T value)
+        {
+            std::lock_guard lock(writer_mutex_);
+            staged_.emplace_back(std::move(key), std::move(value));
+        }
+
+        /**
+         * @brief Stages an erase for the next `publish()`.
+         */
+        void stage_erase(Key key)
+        {
+            std::lock_guard lock(writer_mutex_);
+            staged_.emplace_back(std::move(key), std::nullopt);
+        }
+
+        /**
+         * @brief Applies every staged update to a copy of the map and publishes it.
+         * @details O(n + m log m). Readers that started earlier keep their old
+         *          snapshot until they release it.
+         */
+        void publish()
+        {
+            {
+                std::lock_guard lock(writer_mutex_);
+                if (staged_.empty())
+                {
+                    return;
+                }
+                auto next = std::make_unique<map_type>(*current_.load());
+                apply_updates(*next, std::exchange(staged_, {}));
+                swap_in(next.release());
+            }
+            domain_.collect();
+        }
+
+        /**
+         * @brief Replaces the whole map, discarding staged updates.
+         */
+        void replace(map_type map)
+        {
+            {
+                std::lock_guard lock(writer_mutex_);
+                staged_.clear();
+                swap_in(new map_type(std::move(map)));
+            }
+            domain_.collect();
+        }
+
+    private:
+        void swap_in(map_type *next)
+        {
+            map_type *previous = current_.exchange(next);
+            domain_.retire([previous] { delete previous; });
+        }
+
+        std::atomic<map_type *> current_;
+        mutable epoch_domain domain_;
+        std::mutex writer_mutex_;
+        std::vector<std::pair<Key, std::optional<T>>> staged_;
+    };
+} // namespace learnings
@@ -0,0 +1,269 @@
+/**
+ * @file static_perfect_hash.hpp
+ * @brief Compile-time perfect hashing for maps whose keys are known at build time.
+ *
+ * Maps such as `ages` in C++23.cpp often have a key set that is fixed when
+ * the program is built. `make_perfect_hash_map` runs a hash-and-displace
+ * search during constant evaluation and produces a table with no collisions:
+ * the object lives in read-only data, costs nothing at startup, and a lookup
+ * is one hash, one probe and one key comparison.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+#include <utility>
+
+namespace learnings
+{
+    namespace detail
+    {
+        /**
+         * @brief Loads @p Bytes bytes of @p key at @p offset as a little-endian integer.
+         * @details During constant evaluation the word is assembled byte by
+         *          byte, because `std::memcpy` is not usable there; at run time
+         *          on a little-endian host it is a single unaligned load.
+         */
+        template <std::size_t Bytes>
+        constexpr std::uint64_t load_le(std::string_view key, std::size_t offset) noexcept
+        {
+            auto assemble = [&] {
+                std::uint64_t word = 0;
+                for (std::size_t i = 0; i < Bytes; ++i)
+                {
+                    word |= static_cast<std::uint64_t>(static_cast<unsigned char>(key[offset + i])) << (8 * i);
+                }
+                return word;
+            };
+            if consteval
+            { ///< C++23: if consteval selects the portable path during constant evaluation.
+                return assemble();
+            }
+            else
+            {
+                if constexpr (std::endian::native == std::endian::little && Bytes > 1)
+                {
+                    std::uint64_t word = 0;
+                    std::memcpy(&word, key.data() + offset, Bytes);
+                    return word;
+                }
+                else
+                {
+                    return assemble();
+                }
+            }
+        }
+    } // namespace detail
+
+    /**
+     * @brief Seeded 64-bit string hash that gives identical results at compile time and run time.
+     * @details Whole 8-byte words are mixed in turn; the tail is read with
+     *          overlapping fixed-size loads, which is safe because the length
+     *          is part of the hash.
+     */
+    constexpr std::uint64_t seeded_hash(std::string_view key, std::uint64_t seed) noexcept
+    {
+        constexpr std::uint64_t multiplier = 0x9e3779b97f4a7c15ull;
+        auto mix = [](std::uint64_t h) {
+            h ^= h >> 32;
+            h *= 0xd6e8feb86659fd93ull;
+            h ^= h >> 32;
+            return h;
+        };
+
+        const std::size_t n = key.size();
+        std::uint64_t h = seed ^ (n * multiplier);
+        std::size_t offset = 0;
+        for (; offset + 8 < n; offset += 8)
+        {
+            h = mix(h ^ detail::load_le<8>(key, offset)) * multiplier;
+        }
+
+        std::uint64_t tail = 0;
+        if (n >= 8)
+        {
+            tail = detail::load_le<8>(key, n - 8);
+        }
+        else if (n >= 4)
+        {
+            tail = detail::load_le<4>(key, 0) | (detail::load_le<4>(key, n - 4) << 32);
+        }
+        else if (n > 0)
+        {
+            tail = detail::load_le<1>(key, 0) | (detail::load_le<1>(key, n / 2) << 8) |
+                   (detail::load_le<1>(key, n - 1) << 16);
+        }
+        return mix(mix(h ^ tail) * multiplier);
+    }
+
+    /**
+     * @brief Immutable string-keyed map with a collision-free hash table.
+     *
+     * @tparam T The mapped type; must be usable in constant expressions.
+     * @tparam N The number of keys.
+     * @details Keys are grouped into buckets by one part of their hash; each
+     *          bucket stores a displacement `d` chosen at compile time so that
+     *          `(f1 + d * f2) mod table_size` lands every key of the bucket in
+     *          its own slot. Build it with `make_perfect_hash_map`.
+     */
+    template <typename T, std::size_t N>
+    class perfect_hash_map
+    {
+    public:
+        static constexpr std::size_t table_size = std::bit_ceil(N + N / 4 + 1);
+        static constexpr std::size_t bucket_count = N / 4 + 1;
+
+        /**
+         * @brief Finds the value for @p key. One hash, one probe, no branches on collisions.
+         */
+        constexpr const T *find(std::string_view key) const noexcept
+        {
+            const std::uint64_t h = seeded_hash(key, seed_);
+            const std::size_t s = slot(h, displacements_[bucket(h)]);
+            return occupied_[s] && keys_[s] == key ? &values_[s] : nullptr;
+        }
+
+        constexpr bool contains(std::string_view key) const noexcept { return find(key) != nullptr; }
+
+        static constexpr std::size_t size() noexcept { return N; }
+
+        /**
+         * @brief Builds the table; only callable during constant evaluation.
+         * @details Fails to compile (by throwing) if two keys are equal.
+         */
+        consteval explicit perfect_hash_map(const std::array<std::pair<std::string_view, T>, N> &entries)
+        {
+            for (std::size_t i = 0; i < N; ++i)
+            {
+                for (std::size_t j = i + 1; j < N; ++j)
+                {
+                    if (entries[i].first == entries[j].first)
+                    {
+                        throw "perfect_hash_map: duplicate key";
+                    }
+                }
+            }
+            for (std::uint64_t seed = 0;; ++seed)
+            {
+                if (try_build(entries, seed))
+                {
+                    return;
+                }
+            }
+        }
+
+    private:
+        static constexpr std::uint32_t max_displacement = 1u << 12;
+
+        static constexpr std::size_t bucket(std::uint64_t h) noexcept
+        {
+            return static_cast<std::size_t>((h >> 16) % bucket_count);
+        }
+
+        static constexpr std::size_t slot(std::uint64_t h, std::uint32_t d) noexcept
+        {
+            const std::uint64_t f1 = h & 0xffff'ffffu;
+            const std::uint64_t f2 = (h >> 32) | 1;
+            return static_cast<std::size_t>((f1 + d * f2) & (table_size - 1));
+        }
+
+        /**
+         * @brief One hash-and-displace attempt with @p seed; false if some bucket cannot be placed.
+         */
+        consteval bool try_build(const std::array<std::pair<std::string_view, T>, N> &entries, std::uint64_t seed)
+        {
+            std::array<std::uint64_t, N> hashes{};
+            std::array<std::size_t, N> order{};
+            for (std::size_t i = 0; i < N; ++i)
+            {
+                hashes[i] = seeded_hash(entries[i].first, seed);
+                order[i] = i;
+            }
+
+            // Place the biggest buckets first while the table is still empty.
+            std::array<std::size_t, bucket_count> bucket_sizes{};
+            for (std::size_t i = 0; i < N; ++i)
+            {
+                ++bucket_sizes[bucket(hashes[i])];
+            }
+            std::sort(order.begin(), order.end(), [&](std::size_t a, std::size_t b) {
+                const std::size_t ba = bucket(hashes[a]);
+                const std::size_t bb = bucket(hashes[b]);
+                return bucket_sizes[ba] != bucket_sizes[bb] ? bucket_sizes[ba] > bucket_sizes[bb] : ba < bb;
+            });
+
+            occupied_ = {};
+            displacements_ = {};
+            for (std::size_t first = 0; first < N;)
+            {
+                const std::size_t b = bucket(hashes[order[first]]);
+                std::size_t last = first;
+                while (last < N && bucket(hashes[order[last]]) == b)
+                {
+                    ++last;
+                }
+
+                bool placed = false;
+                for (std::uint32_t d = 0; d < max_displacement && !placed; ++d)
+                {
+                    placed = true;
+                    for (std::size_t i = first; i < last && placed; ++i)
+                    {
+                        const std::size_t s = slot(hashes[order[i]], d);
+                        placed = !occupied_[s];
+                        for (std::size_t j = first; j < i && placed; ++j)
+                        {
+                            placed = slot(hashes[order[j]], d) != s;
+                        }
+                    }
+                    if (placed)
+                    {
+                        displacements_[b] = d;
+                        for (std::size_t i = first; i < last; ++i)
+                        {
+                            const std::size_t s = slot(hashes[order[i]], d);
+                            occupied_[s] = true;
+                            keys_[s] = entries[order[i]].first;
+                            values_[s] = entries[order[i]].second;
+                        }
+                    }
+                }
+                if (!placed)
+                {
+                    return false;
+                }
+                first = last;
+            }
+            seed_ = seed;
+            return true;
+        }
+
+        std::uint64_t seed_ = 0;
+        std::array<std::uint32_t, bucket_count> displacements_{};
+        std::array<bool, table_size> occupied_{};
+        std::array<std::string_view, table_size> keys_{};
+        std::array<T, table_size> values_{};
+    };
+
+    /**
+     * @brief Builds a `perfect_hash_map` from a braced list of key/value pairs.
+     *
+     * @code
+     * constexpr auto ages = learnings::make_perfect_hash_map<int>({{"Alice", 30}, {"Bob", 25}, {"Charlie", 35}});
+     * static_assert(*ages.find("Bob") == 25);
+     * @endcode
+     */
+    template <typename T, std::size_t N>
+    consteval perfect_hash_map<T, N> make_perfect_hash_map(const std::pair<std::string_view, T> (&entries)[N])
+    {
+        std::array<std::pair<std::string_view, T>, N> list{};
+        std::copy(std::begin(entries), std::end(entries), list.begin());
+        return perfect_hash_map<T, N>(list);
+    }
+} // namespace learnings
@@ -0,0 +1,292 @@
+/**
+ * @file static_search_map.hpp
+ * @brief Read-only maps whose key layout is tuned for fast lookup.
+ *
+ * `std::flat_map` searches a sorted key vector by binary search: the branch at
+ * every level is a coin flip and every level below the first few misses the
+ * cache. Both maps here are built once from a finished `std::flat_map` and
+ * then only answer lookups:
+ * - `eytzinger_map` stores keys in breadth-first (Eytzinger) order, searches
+ *   without branches and prefetches the grand-grandchildren of each node.
+ * - `static_btree_map` stores 32-bit integer keys in 64-byte B+-tree-like
+ *   nodes of 16 keys and ranks the key within a node with SIMD compares, so
+ *   each level costs a single cache line.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <flat_map> // C++23: std::flat_map as the source of the static maps.
+#include <functional>
+#include <limits>
+#include <numeric>
+#include <type_traits>
+#include <vector>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#endif
+
+namespace learnings
+{
+    /**
+     * @brief Issues a read prefetch for @p address; a no-op where unsupported.
+     */
+    inline void prefetch(const void *address) noexcept
+    {
+#if defined(__GNUC__) || defined(__clang__)
+        __builtin_prefetch(address);
+#else
+        (void)address;
+#endif
+    }
+
+    /**
+     * @brief Static map with keys in Eytzinger order and a branchless search.
+     *
+     * @tparam Key     The key type.
+     * @tparam T       The mapped type.
+     * @tparam Compare The key ordering.
+     * @details Node `k` (1-based) has children `2k` and `2k + 1`, so the top of
+     *          the tree shares a handful of cache lines and the nodes a search
+     *          will visit four levels down are contiguous and can be prefetched.
+     */
+    template <typename Key, typename T, typename Compare = std::less<Key>>
+    class eytzinger_map
+    {
+    public:
+        eytzinger_map() = default;
+
+        /**
+         * @brief Lays out the entries of a finished flat_map.
+         * @details O(n) when @p source is ordered by `Compare`; a source with
+         *          another comparator is first re-sorted by @p comp, O(n log n).
+         */
+        template <typename SourceCompare>
+        explicit eytzinger_map(const std::flat_map<Key, T, SourceCompare> &source, Compare comp = Compare())
+            : keys_(source.size() + 1), values_(source.size() + 1), comp_(comp)
+        {
+            std::size_t next = 0;
+            if constexpr (std::same_as<SourceCompare, Compare>)
+            {
+                fill(source.keys(), source.values(), next, 1);
+            }
+            else
+            {
+                std::vector<std::size_t> order(source.size());
+                std::iota(order.begin(), order.end(), std::size_t{0});
+                std::ranges::stable_sort(order, comp_, [&](std::size_t i) -> const Key & { return source.keys()[i]; });
+                std::vector<Key> keys;
+                std::vector<T> values;
+                keys.reserve(order.size());
+                values.reserve(order.size());
+                for (const std::size_t i : order)
+                {
+                    keys.push_back(source.keys()[i]);
+                    values.push_back(source.values()[i]);
+                }
+                fill(keys, values, next, 1);
+            }
+        }
+
+        std::size_t size() const noexcept { return keys_.empty() ? 0 : keys_.size() - 1; }
+
+        /**
+         * @brief Returns a pointer to the value for @p key, or nullptr. O(log n).
+         */
+        template <typename K>
+        const T *find(const K &key) const
+        {
+            const std::size_t n = size();
+            std::size_t k = 1;
+            while (k <= n)
+            {
+                prefetch(keys_.data() + std::min(k * prefetch_stride, n));
+                k = 2 * k + static_cast<std::size_t>(comp_(keys_[k], key)); // Branchless descent.
+            }
+            // Undo the trailing right turns plus one left turn to land on the lower bound.
+            k >>= std::countr_one(k) + 1;
+            if (k == 0 || comp_(key, keys_[k]))
+            {
+                return nullptr;
+            }
+            return &values_[k];
+        }
+
+        template <typename K>
+        bool contains(const K &key) const
+        {
+            return find(key) != nullptr;
+        }
+
+    private:
+        /// Descendants four levels down; for small keys they share one cache line.
+        static constexpr std::size_t prefetch_stride = 16;
+
+        /**
+         * @brief Assigns sorted entries to nodes by an in-order walk of the implicit tree.
+         */
+        template <typename KeyContainer, typename ValueContainer>
+        void fill(const KeyContainer &keys, const ValueContainer &values, std::size_t &next, std::size_t k)
+        {
+            if (k > size())
+            {
+                return;
+            }
+            fill(keys, values, next, 2 * k);
+            keys_[k] = keys[next];
+            values_[k] = values[next];
+            ++next;
+            fill(keys, values, next, 2 * k + 1);
+        }
+
+        std::vector<Key> keys_;  ///< 1-based; keys_[0] is unused.
+        std::vector<T> values_;  ///< Parallel to keys_.
+        [[no_unique_address]] Compare comp_;
+    };
+
+    /**
+     * @brief Static map over 32-bit integer keys laid out as a 17-ary search tree.
+     *
+     * @tparam Key A 32-bit integral key type.
+     * @tparam T   The mapped type.
+     * @details Each node holds 16 keys in one 64-byte cache line. A lookup
+     *          counts the node keys below the probe with four SSE2 compares
+     *          (a scalar loop elsewhere) and descends into child `rank`.
+     *          Values are stored in the same slot order as the keys, so a hit
+     *          costs one more cache miss at most.
+     */
+    template <typename Key, typename T>
+        requires std::integral<Key> && (sizeof(Key) == 4)
+    class static_btree_map
+    {
+    public:
+        static_btree_map() = default;
+
+        /**
+         * @brief Lays out the entries of a finished, ascending flat_map. O(n).
+         */
+        explicit static_btree_map(const std::flat_map<Key, T> &source)
+            : nodes_((source.size() + node_keys - 1) / node_keys),
+              values_(nodes_.size() * node_keys),
+              size_(source.size()),
+              has_max_key_(!source.empty() && encode(source.keys().back()) == padding_key)
+        {
+            std::size_t next = 0;
+            fill(source.keys(), source.values(), next, 0);
+        }
+
+        std::size_t size() const noexcept { return size_; }
+
+        /**
+         * @brief Returns a pointer to the value for @p key, or nullptr. O(log_17 n).
+         */
+        const T *find(Key key) const noexcept
+        {
+            const std::int32_t x = encode(key);
+            std::size_t slot = npos;
+            std::size_t k = 0;
+            while (k < nodes_.size())
+            {
+                const std::size_t i = rank(nodes_[k], x);
+                slot = i < node_keys ? k * node_keys + i : slot;
+                k = k * (node_keys + 1) + i + 1;
+            }
+            // Padding sorts after every real key, so it only matches a probe equal
+            // to the padding value, and only if no real key claimed it first.
+            if (slot == npos || nodes_[slot / node_keys].keys[slot % node_keys] != x ||
+                (x == padding_key && !has_max_key_))
+            {
+                return nullptr;
+            }
+            return &values_[slot];
+        }
+
+        bool contains(Key key) const noexcept { return find(key) != nullptr; }
+
+    private:
+        static constexpr std::size_t node_keys = 16;
+        static constexpr std::size_t npos = static_cast<std::size_t>(-1);
+        static constexpr std::int32_t padding_key = std::numeric_limits<std::int32_t>::max();
+
+        struct alignas(64) node
+        {
+            std::int32_t keys[node_keys];
+        };
+
+        /**
+         * @brief Maps keys to signed integers with the same order, for signed SIMD compares.
+         */
+        static constexpr std::int32_t encode(Key key) noexcept
+        {
+            if constexpr (std::is_signed_v<Key>)
+            {
+                return static_cast<std::int32_t>(key);
+            }
+            else
+            {
+                return static_cast<std::int32_t>(static_cast<std::uint32_t>(key) ^ 0x8000'0000u);
+            }
+        }
+
+        /**
+         * @brief Counts the keys of @p n that are less than @p x.
+         */
+        static std::size_t rank(const node &n, std::int32_t x) noexcept
+        {
+#if defined(__SSE2__) || defined(_M_X64)
+            const __m128i probe = _mm_set1_epi32(x);
+            const auto *keys = reinterpret_cast<const __m128i *>(n.keys);
+            const int m0 = _mm_movemask_ps(_mm_castsi128_ps(_mm_cmpgt_epi32(probe, _mm_load_si128(keys + 0))));
+            const int m1 = _mm_movemask_ps(_mm_castsi128_ps(_mm_cmpgt_epi32(probe, _mm_load_si128(keys + 1))));
+            const int m2 = _mm_movemask_ps(_mm_castsi128_ps(_mm_cmpgt_epi32(probe, _mm_load_si128(keys + 2))));
+            const int m3 = _mm_movemask_ps(_mm_castsi128_ps(_mm_cmpgt_epi32(probe, _mm_load_si128(keys + 3))));
+            return static_cast<std::size_t>(
+                std::popcount(static_cast<unsigned>(m0 | (m1 << 4) | (m2 << 8) | (m3 << 12))));
+#else
+            std::size_t count = 0;
+            for (std::int32_t key : n.keys)
+            {
+                count += static_cast<std::size_t>(key < x);
+            }
+            return count;
+#endif
+        }
+
+        /**
+         * @brief Assigns sorted keys to node slots by an in-order walk of the implicit tree.
+         */
+        template <typename KeyContainer, typename ValueContainer>
+        void fill(const KeyContainer &keys, const ValueContainer &values, std::size_t &next, std::size_t k)
+        {
+            if (k >= nodes_.size())
+            {
+                return;
+            }
+            for (std::size_t i = 0; i < node_keys; ++i)
+            {
+                fill(keys, values, next, k * (node_keys + 1) + i + 1);
+                if (next < keys.size())
+                {
+                    nodes_[k].keys[i] = encode(keys[next]);
+                    values_[k * node_keys + i] = values[next];
+                    ++next;
+                }
+                else
+                {
+                    nodes_[k].keys[i] = padding_key;
+                }
+            }
+            fill(keys, values, next, k * (node_keys + 1) + node_keys + 1);
+        }
+
+        std::vector<node> nodes_;
+        std::vector<T> values_; ///< Parallel to the key slots of nodes_.
+        std::size_t size_ = 0;
+        bool has_max_key_ = false;
+    };
+} // namespace learnings
@@ -0,0 +1,205 @@
+/**
+ * @file streaming_matcher.hpp
+ * @brief Substring search over data that arrives in chunks.
+ *
+ * Pipes and sockets deliver text a buffer at a time, and a needle can be cut
+ * in two by a buffer boundary. Accumulating everything into a `std::string`
+ * to call `contains` costs memory and a copy. `streaming_matcher` searches
+ * each chunk in place and carries one integer across boundaries: how much of
+ * the needle the stream currently ends with, as in Knuth-Morris-Pratt.
+ *
+ * KMP on its own advances one byte at a time. Here it runs only at the start
+ * of a chunk, until a partial match carried over from the previous chunk
+ * dies out or could no longer end inside the chunk; the rest of the chunk is
+ * searched with `compiled_needle`, and the carried state for the next chunk
+ * is recomputed from the last `needle.size() - 1` bytes. Throughput therefore
+ * matches an in-memory search once chunks are much longer than the needle.
+ */
+
+#pragma once
+
+#include "compiled_needle.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <istream>
+#include <optional>
+#include <span>
+#include <string_view>
+#include <vector>
+
+namespace learnings
+{
+    /**
+     * @brief Finds every occurrence of a needle in a stream fed as consecutive chunks.
+     * @details Offsets are counted from the first byte ever fed. An empty
+     *          needle is `found()` from the start and reports no offsets.
+     */
+    class streaming_matcher
+    {
+    public:
+        /**
+         * @brief Copies @p needle and builds its KMP failure table. O(needle length).
+         */
+        explicit streaming_matcher(std::string_view needle)
+            : needle_(needle.begin(), needle.end()), failure_(needle.size(), 0), compiled_(view())
+        {
+            for (std::size_t i = 1, k = 0; i < needle_.size(); ++i)
+            {
+                while (k > 0 && needle_[i] != needle_[k])
+                {
+                    k = failure_[k - 1];
+                }
+                if (needle_[i] == needle_[k])
+                {
+                    ++k;
+                }
+                failure_[i] = k;
+            }
+        }
+
+        // `compiled_` refers to `needle_`'s buffer, which a vector move keeps.
+        streaming_matcher(streaming_matcher &&) noexcept = default;
+        streaming_matcher &operator=(streaming_matcher &&) noexcept = default;
+        streaming_matcher(const streaming_matcher &) = delete;
+        streaming_matcher &operator=(const streaming_matcher &) = delete;
+
+        /**
+         * @brief Searches the next chunk and calls @p on_match(offset) for each occurrence that ends in it.
+         * @details Offsets are reported in increasing order. The chunk is not
+         *          copied and need not outlive the call.
+         */
+        template <typename F>
+        void feed(std::span<const char> chunk, F &&on_match)
+        {
+            const std::size_t m = needle_.size();
+            if (m == 0)
+            {
+                consumed_ += chunk.size();
+                return;
+            }
+            auto report = [&](std::uint64_t offset) {
+                if (matches_ == 0)
+                {
+                    first_ = offset;
+                }
+                ++matches_;
+                on_match(offset);
+            };
+
+            // A partial match carried over can only complete within the first m - 1 bytes.
+            std::size_t i = 0;
+            while (state_ > 0 && i < chunk.size() && i < m - 1)
+            {
+                if (step(chunk[i++]))
+                {
+                    report(consumed_ + i - m);
+                }
+            }
+            if (i == chunk.size())
+            {
+                consumed_ += chunk.size();
+                return; // Chunk shorter than the carried partial match: the state is already current.
+            }
+
+            // Any match not yet reported starts inside this chunk, no earlier than the live partial match.
+            const std::string_view text(chunk.data(), chunk.size());
+            for (std::size_t pos = compiled_.find(text, i - state_); pos != std::string_view::npos;
+                 pos = compiled_.find(text, pos + 1))
+            {
+                report(consumed_ + pos);
+            }
+
+            // The partial match at the end of the chunk is shorter than the needle.
+            state_ = 0;
+            for (std::size_t j = chunk.size() - std::min(chunk.size(), m - 1); j < chunk.size(); ++j)
+            {
+                step(chunk[j]); // m - 1 bytes cannot hold a whole match, so nothing is reported twice.
+            }
+            consumed_ += chunk.size();
+        }
+
+        /**
+         * @brief Searches the next chunk; returns the number of occurrences that end in it.
+         */
+        std::size_t feed(std::span<const char> chunk)
+        {
+            std::size_t found = 0;
+            feed(chunk, [&found](std::uint64_t) { ++found; });
+            return found;
+        }
+
+        std::string_view needle() const noexcept { return view(); }
+        bool found() const noexcept { return matches_ != 0 || needle_.empty(); }
+        std::uint64_t match_count() const noexcept { return matches_; }
+        std::uint64_t bytes_consumed() const noexcept { return consumed_; }
+
+        /**
+         * @brief Returns the offset of the first occurrence so far, if any.
+         */
+        std::optional<std::uint64_t> first_match() const noexcept
+        {
+            return matches_ != 0 ? std::optional<std::uint64_t>(first_) : std::nullopt;
+        }
+
+        /**
+         * @brief Forgets all input, as if newly constructed.
+         */
+        void reset() noexcept
+        {
+            state_ = 0;
+            consumed_ = 0;
+            matches_ = 0;
+            first_ = 0;
+        }
+
+    private:
+        std::string_view view() const noexcept { return {needle_.data(), needle_.size()}; }
+
+        /**
+         * @brief Advances the KMP state by @p c; returns true when a whole needle has just matched.
+         */
+        bool step(char c) noexcept
+        {
+            while (state_ > 0 && needle_[state_] != c)
+            {
+                state_ = failure_[state_ - 1];
+            }
+            if (needle_[state_] == c)
+            {
+                ++state_;
+            }
+            if (state_ == needle_.size())
+            {
+                state_ = failure_[state_ - 1];
+                return true;
+            }
+            return false;
+        }
+
+        std::vector<char> needle_;
+        std::vector<std::size_t> failure_; ///< Longest proper prefix of `needle_[0..i]` that is also its suffix.
+        compiled_needle compiled_;
+        std::size_t state_ = 0; ///< Length of the needle prefix the stream currently ends with.
+        std::uint64_t consumed_ = 0;
+        std::uint64_t matches_ = 0;
+        std::uint64_t first_ = 0;
+    };
+
+    /**
+     * @brief Feeds @p in to @p matcher through a buffer of @p buffer_bytes until end of stream.
+     * @return Whether the stream ended without a read error.
+     */
+    template <typename F>
+    bool feed_stream(std::istream &in, streaming_matcher &matcher, F &&on_match, std::size_t buffer_bytes = 1 << 16)
+    {
+        std::vector<char> buffer(buffer_bytes);
+        while (in)
+        {
+            in.read(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+            matcher.feed(std::span<const char>(buffer.data(), static_cast<std::size_t>(in.gcount())), on_match);
+        }
+        return in.eof() && !in.bad();
+    }
+} // namespace learnings
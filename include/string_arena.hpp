@@ -0,0 +1,260 @@
+/**
+ * @file string_arena.hpp
+ * @brief Contiguous string interning and a `std::flat_map` keyed on the handles.
+ *
+ * A `std::flat_map<std::string, int>` stores one `std::string` per key; names
+ * longer than the small-string buffer each own a heap block, and every lookup
+ * comparison chases a pointer into it. `string_arena` instead packs all key
+ * bytes into one buffer and names them with dense 32-bit `string_id`s handed
+ * out in sorted order, so comparing two ids is an integer comparison that
+ * agrees with comparing the strings.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <compare>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <flat_map> // C++23: std::flat_map, std::sorted_unique.
+#include <functional>
+#include <limits>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace learnings
+{
+    /**
+     * @brief Handle to a string interned in a `string_arena`.
+     * @details Ids are assigned in lexicographic order, so `a < b` on ids
+     *          holds exactly when the interned strings compare the same way.
+     */
+    struct string_id
+    {
+        std::uint32_t value = 0;
+
+        friend auto operator<=>(string_id, string_id) = default;
+    };
+
+    /**
+     * @brief Immutable, sorted set of strings stored back to back in one buffer.
+     */
+    class string_arena
+    {
+    public:
+        string_arena() = default;
+
+        /**
+         * @brief Interns a range of strings.
+         * @param strings Any range of values convertible to `std::string_view`;
+         *                duplicates are allowed and interned once.
+         * @throws std::length_error if the total size exceeds 4 GiB.
+         */
+        template <typename Range>
+        static string_arena build(const Range &strings)
+        {
+            std::vector<std::string_view> sorted;
+            for (const auto &s : strings)
+            {
+                sorted.emplace_back(s);
+            }
+            std::sort(sorted.begin(), sorted.end());
+            sorted.erase(std::unique(sorted.begin(), sorted.end()), sorted.end());
+            return from_sorted_unique(sorted);
+        }
+
+        /**
+         * @brief Interns strings that are already sorted and free of duplicates.
+         * @details This is the O(n) path used when the input comes straight out
+         *          of a `std::flat_map` with the default ordering.
+         */
+        template <typename Range>
+        static string_arena from_sorted_unique(const Range &strings)
+        {
+            string_arena arena;
+            std::size_t total = 0;
+            std::size_t count = 0;
+            for (const auto &s : strings)
+            {
+                total += std::string_view(s).size();
+                ++count;
+            }
+            if (total > std::numeric_limits<std::uint32_t>::max() ||
+                count > std::numeric_limits<std::uint32_t>::max())
+            {
+                throw std::length_error("string_arena: more than 4 GiB of key bytes");
+            }
+
+            arena.bytes_.reserve(total);
+            arena.offsets_.reserve(count + 1);
+            arena.offsets_.push_back(0);
+            for (const auto &s : strings)
+            {
+                const std::string_view view(s);
+                arena.bytes_.insert(arena.bytes_.end(), view.begin(), view.end());
+                arena.offsets_.push_back(static_cast<std::uint32_t>(arena.bytes_.size()));
+            }
+            return arena;
+        }
+
+        /**
+         * @brief Returns the number of interned strings.
+         */
+        std::size_t size() const noexcept { return offsets_.empty() ? 0 : offsets_.size() - 1; }
+
+        /**
+         * @brief Returns the string named by @p id. The view lives as long as the arena.
+         */
+        std::string_view view(string_id id) const noexcept
+        {
+            const std::uint32_t begin = offsets_[id.value];
+            return {bytes_.data() + begin, offsets_[id.value + 1] - begin};
+        }
+
+        /**
+         * @brief Looks up the id of @p s by binary search over the arena. O(log n).
+         * @return The id, or `std::nullopt` if @p s was never interned.
+         */
+        std::optional<string_id> find(std::string_view s) const noexcept
+        {
+            std::uint32_t lo = 0;
+            std::uint32_t hi = static_cast<std::uint32_t>(size());
+            while (lo < hi)
+            {
+                const std::uint32_t mid = lo + (hi - lo) / 2;
+                if (view(string_id{mid}) < s)
+                {
+                    lo = mid + 1;
+                }
+                else
+                {
+                    hi = mid;
+                }
+            }
+            if (lo < size() && view(string_id{lo}) == s)
+            {
+                return string_id{lo};
+            }
+            return std::nullopt;
+        }
+
+        /**
+         * @brief Returns the heap bytes owned by the arena.
+         */
+        std::size_t memory_bytes() const noexcept
+        {
+            return bytes_.capacity() + offsets_.capacity() * sizeof(std::uint32_t);
+        }
+
+    private:
+        std::vector<char> bytes_;            ///< All key bytes, in id order.
+        std::vector<std::uint32_t> offsets_; ///< offsets_[i]..offsets_[i + 1] delimit string i.
+    };
+
+    /**
+     * @brief A `std::flat_map` keyed on `string_id`s from an owned `string_arena`.
+     * @tparam T The mapped type.
+     */
+    template <typename T>
+    class interned_flat_map
+    {
+    public:
+        using map_type = std::flat_map<string_id, T>;
+        using iterator = typename map_type::iterator;
+        using const_iterator = typename map_type::const_iterator;
+
+        interned_flat_map() = default;
+
+        /**
+         * @brief Interns the keys of a finished string-keyed flat_map. O(n).
+         * @details Only lexicographic orderings are accepted, since the arena
+         *          relies on the source keys already being in id order.
+         */
+        template <typename Compare>
+            requires std::same_as<Compare, std::less<std::string>> || std::same_as<Compare, std::less<>>
+        explicit interned_flat_map(const std::flat_map<std::string, T, Compare> &source)
+            : arena_(string_arena::from_sorted_unique(source.keys()))
+        {
+            std::vector<string_id> ids(source.size());
+            for (std::uint32_t i = 0; i < ids.size(); ++i)
+            {
+                ids[i] = string_id{i};
+            }
+            map_ = map_type(std::sorted_unique, std::move(ids),
+                            typename map_type::mapped_container_type(source.values().begin(), source.values().end()));
+        }
+
+        /**
+         * @brief Returns the arena that resolves ids back to strings.
+         */
+        const string_arena &arena() const noexcept { return arena_; }
+
+        /**
+         * @brief Returns the underlying id-keyed map.
+         */
+        const map_type &map() const noexcept { return map_; }
+
+        std::size_t size() const noexcept { return map_.size(); }
+        iterator begin() noexcept { return map_.begin(); }
+        iterator end() noexcept { return map_.end(); }
+        const_iterator begin() const noexcept { return map_.begin(); }
+        const_iterator end() const noexcept { return map_.end(); }
+
+        /**
+         * @brief Finds an entry by handle; a pure integer binary search.
+         */
+        iterator find(string_id id) { return map_.find(id); }
+        const_iterator find(string_id id) const { return map_.find(id); }
+
+        /**
+         * @brief Finds an entry by name: resolves the id in the arena, then the map.
+         */
+        const_iterator find(std::string_view name) const
+        {
+            const auto id = arena_.find(name);
+            if (!id)
+            {
+                return map_.end();
+            }
+            if (map_.size() == arena_.size())
+            {
+                return map_.begin() + id->value; // Every id is present, so the id is the position.
+            }
+            return map_.find(*id);
+        }
+
+        bool contains(std::string_view name) const { return find(name) != end(); }
+
+        /**
+         * @brief Returns the value for @p name.
+         * @throws std::out_of_range if the name is absent.
+         */
+        const T &at(std::string_view name) const
+        {
+            const auto it = find(name);
+            if (it == end())
+            {
+                throw std::out_of_range("interned_flat_map::at: key not found");
+            }
+            return it->second;
+        }
+
+        /**
+         * @brief Returns the heap bytes owned by the arena and the map containers.
+         */
+        std::size_t memory_bytes() const noexcept
+        {
+            return arena_.memory_bytes() + map_.keys().capacity() * sizeof(string_id) +
+                   map_.values().capacity() * sizeof(T);
+        }
+
+    private:
+        string_arena arena_;
+        map_type map_;
+    };
+} // namespace learnings
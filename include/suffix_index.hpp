@@ -0,0 +1,786 @@
+/**
+ * @file suffix_index.hpp
+ * @brief Substring index over a fixed corpus: a suffix array or an FM-index, saved and mapped as one buffer.
+ *
+ * `contains` on the `sentence` in C++23.cpp reads the whole text per query.
+ * When one large corpus is queried thousands of times, it pays to sort its
+ * suffixes once: every occurrence of a pattern is then a contiguous range
+ * of the suffix array, found with two binary searches.
+ *
+ * The suffix array is built with SA-IS (Nong, Zhang and Chan, "Two Efficient
+ * Algorithms for Linear Time Suffix Array Construction", 2011) in O(n). With
+ * `suffix_index_kind::fm_index` it is turned into an FM-index (Ferragina and
+ * Manzini, 2000) and dropped, together with the text: the Burrows-Wheeler
+ * transform plus occurrence counts every 256 rows answers `count` by
+ * backward search, and a sample of every `sample_rate`-th text position
+ * answers `locate` by walking at most that many rows. That takes roughly
+ * `2 + sigma / 128` bytes per text byte for an alphabet of `sigma` symbols,
+ * against 5 for text plus suffix array, at the price of slower queries.
+ *
+ * The built index is a single 8-byte-aligned buffer whose bytes are exactly
+ * the file format, so `save` is one write and `open` maps the file and
+ * queries it in place, with the same validation levels as `mapped_flat_map`.
+ *
+ * File layout (host byte order, every section 8-byte aligned):
+ * | Section       | Contents                                                  |
+ * |---------------|-----------------------------------------------------------|
+ * | header        | `suffix_index_header`, 192 bytes                          |
+ * | text          | suffix array kind: the corpus                             |
+ * | suffix_array  | suffix array kind: `n` x `uint32_t`                       |
+ * | bwt           | FM-index: `n + 1` BWT bytes, zero-padded to 256 bytes     |
+ * | tables        | FM-index: `detail::fm_tables` (alphabet codes, C array)   |
+ * | superblocks   | FM-index: `uint32_t` counts per symbol every 65'536 rows  |
+ * | blocks        | FM-index: `uint16_t` counts since the superblock, every 256 rows |
+ * | sampled_bits  | FM-index: one bit per row, set when its position is sampled |
+ * | sampled_ranks | FM-index: `uint32_t` set bits before each 64-bit word     |
+ * | samples       | FM-index: `uint32_t` text positions of the sampled rows   |
+ */
+
+#pragma once
+
+#include "mapped_file.hpp"
+#include "mapped_flat_map.hpp"
+#include "simd_dispatch.hpp"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <expected>
+#include <filesystem>
+#include <fstream>
+#include <limits>
+#include <numeric>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace learnings
+{
+    enum class suffix_index_kind : std::uint32_t
+    {
+        suffix_array, ///< Text plus suffix array: fastest queries, 5 bytes per text byte.
+        fm_index,     ///< Compressed self-index; the text itself is not stored.
+    };
+
+    struct suffix_index_options
+    {
+        suffix_index_kind kind = suffix_index_kind::suffix_array;
+        std::uint32_t sample_rate = 32; ///< FM-index: rows a `locate` walks at most; costs 4 / rate bytes per byte.
+    };
+
+    /**
+     * @brief Fixed-size header at the start of every suffix index buffer and file.
+     */
+    struct suffix_index_header
+    {
+        static constexpr std::array<char, 8> expected_magic{'L', 'S', 'U', 'F', 'I', 'D', 'X', '\1'};
+        static constexpr std::uint32_t current_version = 1;
+
+        enum section : std::size_t
+        {
+            text,
+            suffix_array,
+            bwt,
+            tables,
+            superblocks,
+            blocks,
+            sampled_bits,
+            sampled_ranks,
+            samples,
+            section_count
+        };
+
+        struct extent
+        {
+            std::uint64_t offset;
+            std::uint64_t size; ///< In bytes, including padding; 0 when the kind has no such section.
+        };
+
+        std::array<char, 8> magic;
+        std::uint32_t version;
+        suffix_index_kind kind;
+        std::uint64_t text_size;
+        std::uint64_t dollar_row; ///< FM-index: the BWT row of the whole text, where `$` stands.
+        std::uint32_t sigma;      ///< FM-index: number of distinct bytes in the text.
+        std::uint32_t sample_rate;
+        std::array<extent, section_count> sections;
+        std::uint64_t checksum; ///< `checksum64` of every byte after the header.
+    };
+    static_assert(sizeof(suffix_index_header) == 192);
+
+    namespace detail
+    {
+        /**
+         * @brief SA-IS: the suffix array of @p s, whose symbols are in `[0, upper]`.
+         * @details Induced sorting: the leftmost-S-type suffixes are sorted by
+         *          recursing on the string of their substring names, and all
+         *          other suffixes are induced from them in two linear scans.
+         */
+        template <typename Symbol>
+        std::vector<std::int32_t> sa_is(std::span<const Symbol> s, std::int32_t upper)
+        {
+            const auto n = static_cast<std::int32_t>(s.size());
+            auto at = [&](std::int32_t i) { return static_cast<std::int32_t>(s[static_cast<std::size_t>(i)]); };
+            if (n == 0)
+            {
+                return {};
+            }
+            if (n == 1)
+            {
+                return {0};
+            }
+            if (n == 2)
+            {
+                return at(0) < at(1) ? std::vector<std::int32_t>{0, 1} : std::vector<std::int32_t>{1, 0};
+            }
+
+            std::vector<std::int32_t> sa(static_cast<std::size_t>(n));
+            std::vector<bool> s_type(static_cast<std::size_t>(n)); // The last suffix is L-type.
+            for (std::int32_t i = n - 2; i >= 0; --i)
+            {
+                s_type[i] = at(i) == at(i + 1) ? s_type[i + 1] : at(i) < at(i + 1);
+            }
+            // Bucket starts: L-type suffixes of symbol c start at l_start[c], S-type ones at s_start[c].
+            std::vector<std::int32_t> l_start(static_cast<std::size_t>(upper) + 2);
+            std::vector<std::int32_t> s_start(static_cast<std::size_t>(upper) + 2);
+            for (std::int32_t i = 0; i < n; ++i)
+            {
+                if (!s_type[i])
+                {
+                    ++s_start[at(i)];
+                }
+                else
+                {
+                    ++l_start[at(i) + 1];
+                }
+            }
+            for (std::int32_t c = 0; c <= upper; ++c)
+            {
+                s_start[c] += l_start[c];
+                l_start[c + 1] += s_start[c];
+            }
+
+            auto induce = [&](const std::vector<std::int32_t> &lms) {
+                std::ranges::fill(sa, -1);
+                std::vector<std::int32_t> next(s_start);
+                for (const std::int32_t i : lms)
+                {
+                    sa[next[at(i)]++] = i;
+                }
+                next = l_start;
+                sa[next[at(n - 1)]++] = n - 1;
+                for (std::int32_t k = 0; k < n; ++k)
+                {
+                    const std::int32_t i = sa[k];
+                    if (i >= 1 && !s_type[i - 1])
+                    {
+                        sa[next[at(i - 1)]++] = i - 1;
+                    }
+                }
+                next = l_start;
+                for (std::int32_t k = n - 1; k >= 0; --k)
+                {
+                    const std::int32_t i = sa[k];
+                    if (i >= 1 && s_type[i - 1])
+                    {
+                        sa[--next[at(i - 1) + 1]] = i - 1;
+                    }
+                }
+            };
+
+            std::vector<std::int32_t> lms_index(static_cast<std::size_t>(n) + 1, -1);
+            std::vector<std::int32_t> lms;
+            for (std::int32_t i = 1; i < n; ++i)
+            {
+                if (!s_type[i - 1] && s_type[i])
+                {
+                    lms_index[i] = static_cast<std::int32_t>(lms.size());
+                    lms.push_back(i);
+                }
+            }
+            induce(lms);
+            if (lms.empty())
+            {
+                return sa;
+            }
+
+            // Name the LMS substrings in sorted order; equal substrings share a name.
+            const auto m = static_cast<std::int32_t>(lms.size());
+            std::vector<std::int32_t> sorted_lms;
+            sorted_lms.reserve(lms.size());
+            for (const std::int32_t i : sa)
+            {
+                if (lms_index[i] != -1)
+                {
+                    sorted_lms.push_back(i);
+                }
+            }
+            std::vector<std::int32_t> names(lms.size());
+            std::int32_t name = 0;
+            names[lms_index[sorted_lms[0]]] = 0;
+            for (std::int32_t k = 1; k < m; ++k)
+            {
+                std::int32_t l = sorted_lms[k - 1];
+                std::int32_t r = sorted_lms[k];
+                const std::int32_t end_l = lms_index[l] + 1 < m ? lms[lms_index[l] + 1] : n;
+                const std::int32_t end_r = lms_index[r] + 1 < m ? lms[lms_index[r] + 1] : n;
+                bool same = end_l - l == end_r - r;
+                if (same)
+                {
+                    while (l < end_l && at(l) == at(r))
+                    {
+                        ++l;
+                        ++r;
+                    }
+                    same = l < n && r < n && at(l) == at(r);
+                }
+                if (!same)
+                {
+                    ++name;
+                }
+                names[lms_index[sorted_lms[k]]] = name;
+            }
+
+            const std::vector<std::int32_t> reduced = sa_is(std::span<const std::int32_t>(names), name);
+            for (std::int32_t k = 0; k < m; ++k)
+            {
+                sorted_lms[k] = lms[reduced[k]];
+            }
+            induce(sorted_lms);
+            return sa;
+        }
+
+        /**
+         * @brief The FM-index alphabet: dense codes for the bytes present, and the C array.
+         */
+        struct fm_tables
+        {
+            static constexpr std::uint16_t absent = 0xffff;
+
+            std::array<std::uint16_t, 256> code; ///< Column in the count tables, or `absent`.
+            std::array<std::uint64_t, 256> less; ///< Rows whose first symbol sorts before the byte, `$` included.
+        };
+
+        /**
+         * @brief Counts the bytes equal to @p c in `p[0, length)`; may read up to 16 bytes past the end.
+         */
+        inline std::size_t count_byte(const unsigned char *p, std::size_t length, unsigned char c) noexcept
+        {
+            std::size_t total = 0;
+#if LEARNINGS_SIMD_X86
+            const __m128i target = _mm_set1_epi8(static_cast<char>(c));
+            for (std::size_t i = 0; i < length; i += 16)
+            {
+                const __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p + i));
+                auto mask = static_cast<std::uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(block, target)));
+                if (length - i < 16)
+                {
+                    mask &= (std::uint32_t{1} << (length - i)) - 1;
+                }
+                total += static_cast<std::size_t>(std::popcount(mask));
+            }
+#else
+            for (std::size_t i = 0; i < length; ++i)
+            {
+                total += p[i] == c ? 1 : 0;
+            }
+#endif
+            return total;
+        }
+    } // namespace detail
+
+    /**
+     * @brief Count and locate queries over a fixed text; build once, save, and map.
+     */
+    class suffix_index
+    {
+    public:
+        /// The suffix array holds 32-bit positions.
+        static constexpr std::size_t max_text_size = std::numeric_limits<std::int32_t>::max() - 1;
+
+        suffix_index() = default;
+        suffix_index(suffix_index &&) noexcept = default;
+        suffix_index &operator=(suffix_index &&) noexcept = default;
+        suffix_index(const suffix_index &) = delete;
+        suffix_index &operator=(const suffix_index &) = delete;
+
+        /**
+         * @brief Indexes @p text. O(n) time; SA-IS needs about 13 bytes per text byte while building.
+         * @throws std::length_error if @p text is longer than `max_text_size`.
+         * @throws std::invalid_argument if an FM-index is requested with a zero sample rate.
+         */
+        static suffix_index build(std::string_view text, suffix_index_options options = {})
+        {
+            if (text.size() > max_text_size)
+            {
+                throw std::length_error("suffix_index::build: text too long");
+            }
+            if (options.kind == suffix_index_kind::fm_index && options.sample_rate == 0)
+            {
+                throw std::invalid_argument("suffix_index::build: sample rate must be positive");
+            }
+            const auto bytes = std::span(reinterpret_cast<const unsigned char *>(text.data()), text.size());
+            const std::vector<std::int32_t> sa = detail::sa_is(bytes, 255);
+            return options.kind == suffix_index_kind::suffix_array ? build_suffix_array(text, sa)
+                                                                   : build_fm_index(bytes, sa, options.sample_rate);
+        }
+
+        /**
+         * @brief Maps an index written by `save` and validates it to the requested depth.
+         * @return The index, or a description of why the file was rejected.
+         */
+        static std::expected<suffix_index, std::string> open(const std::filesystem::path &file_path,
+                                                             mapped_verify verify = mapped_verify::header)
+        {
+            const std::string path = file_path.string();
+            auto file = mapped_file::open(path);
+            if (!file)
+            {
+                return std::unexpected(file.error());
+            }
+            (void)file->advise(access_advice::random); // Binary searches and LF walks jump around.
+
+            suffix_index index;
+            index.file_ = std::move(*file);
+            const auto bytes = index.file_.bytes();
+            if (auto valid = validate(bytes, verify); !valid)
+            {
+                return std::unexpected(path + ": " + valid.error());
+            }
+            index.attach(bytes);
+            return index;
+        }
+
+        /**
+         * @brief Writes the index next to @p path, flushes it and renames it into place (see `replace_file`).
+         * @return Nothing on success, or an error message.
+         */
+        std::expected<void, std::string> save(const std::filesystem::path &path) const
+        {
+            const std::filesystem::path temp = temp_path_for(path);
+            std::ofstream out(temp, std::ios::binary | std::ios::trunc);
+            if (!out)
+            {
+                return std::unexpected("cannot create " + temp.string());
+            }
+            out.write(reinterpret_cast<const char *>(bytes_.data()), static_cast<std::streamsize>(bytes_.size()));
+            out.close();
+            if (!out)
+            {
+                std::error_code ec;
+                std::filesystem::remove(temp, ec);
+                return std::unexpected("write failed for " + temp.string());
+            }
+            return replace_file(temp, path);
+        }
+
+        suffix_index_kind kind() const noexcept { return header_.kind; }
+        std::size_t text_size() const noexcept { return static_cast<std::size_t>(header_.text_size); }
+
+        /**
+         * @brief Bytes of the buffer or file, header included.
+         */
+        std::size_t size_bytes() const noexcept { return bytes_.size(); }
+
+        /**
+         * @brief The indexed text; empty for an FM-index, which does not store it.
+         */
+        std::string_view text() const noexcept { return text_; }
+
+        /**
+         * @brief Number of occurrences of @p pattern, overlapping ones included.
+         * @details O(m log n) for a suffix array, O(m) rank queries for an FM-index.
+         */
+        std::size_t count(std::string_view pattern) const noexcept
+        {
+            const auto [first, last] = rows(pattern);
+            return last - first;
+        }
+
+        bool contains(std::string_view pattern) const noexcept { return count(pattern) != 0; }
+
+        /**
+         * @brief Start positions of all occurrences of @p pattern, in increasing order.
+         * @details An FM-index walks at most `sample_rate` rows per occurrence.
+         */
+        std::vector<std::size_t> locate(std::string_view pattern) const
+        {
+            std::vector<std::size_t> positions;
+            if (pattern.empty())
+            {
+                positions.resize(text_size() + 1); // Like `std::string_view::find`: every position matches.
+                std::iota(positions.begin(), positions.end(), std::size_t{0});
+                return positions;
+            }
+            const auto [first, last] = rows(pattern);
+            positions.reserve(last - first);
+            for (std::size_t row = first; row < last; ++row)
+            {
+                positions.push_back(position_of(row));
+            }
+            std::ranges::sort(positions);
+            return positions;
+        }
+
+    private:
+        using header = suffix_index_header;
+
+        struct row_range
+        {
+            std::size_t first;
+            std::size_t last;
+        };
+
+        /**
+         * @brief Section sizes implied by a header's kind and counts.
+         */
+        static std::array<std::uint64_t, header::section_count> section_sizes(suffix_index_kind kind,
+                                                                              std::uint64_t n, std::uint32_t sigma,
+                                                                              std::uint64_t samples)
+        {
+            std::array<std::uint64_t, header::section_count> sizes{};
+            if (kind == suffix_index_kind::suffix_array)
+            {
+                sizes[header::text] = detail::align8(n);
+                sizes[header::suffix_array] = detail::align8(n * sizeof(std::uint32_t));
+                return sizes;
+            }
+            const std::uint64_t rows = n + 1;
+            const std::uint64_t words = (rows + 63) / 64;
+            sizes[header::bwt] = ((rows >> 8) + 1) << 8;
+            sizes[header::tables] = sizeof(detail::fm_tables);
+            sizes[header::superblocks] = detail::align8(((rows >> 16) + 1) * sigma * sizeof(std::uint32_t));
+            sizes[header::blocks] = detail::align8(((rows >> 8) + 1) * sigma * sizeof(std::uint16_t));
+            sizes[header::sampled_bits] = words * sizeof(std::uint64_t);
+            sizes[header::sampled_ranks] = detail::align8((words + 1) * sizeof(std::uint32_t));
+            sizes[header::samples] = detail::align8(samples * sizeof(std::uint32_t));
+            return sizes;
+        }
+
+        /**
+         * @brief Lays out the sections back to back after the header and allocates the buffer.
+         */
+        static suffix_index allocate(header h, std::uint64_t samples)
+        {
+            const auto sizes = section_sizes(h.kind, h.text_size, h.sigma, samples);
+            std::uint64_t offset = sizeof(header);
+            for (std::size_t s = 0; s < header::section_count; ++s)
+            {
+                h.sections[s] = {sizes[s] != 0 ? offset : 0, sizes[s]};
+                offset += sizes[s];
+            }
+            suffix_index index;
+            index.owned_.assign(offset / sizeof(std::uint64_t), 0);
+            index.header_ = h;
+            return index;
+        }
+
+        /**
+         * @brief Writes the header with its checksum into the buffer and points the views at it.
+         */
+        void seal()
+        {
+            const auto bytes = std::as_bytes(std::span(owned_));
+            checksum64 checksum;
+            checksum.update(bytes.subspan(sizeof(header)));
+            header_.checksum = checksum.value();
+            std::memcpy(owned_.data(), &header_, sizeof(header_));
+            attach(bytes);
+        }
+
+        /**
+         * @brief A section of the buffer being built.
+         */
+        template <typename T>
+        T *section(header::section s) noexcept
+        {
+            return reinterpret_cast<T *>(reinterpret_cast<std::byte *>(owned_.data()) + header_.sections[s].offset);
+        }
+
+        /**
+         * @brief A section of the attached buffer or mapping.
+         */
+        template <typename T>
+        const T *view(header::section s) const noexcept
+        {
+            return reinterpret_cast<const T *>(bytes_.data() + header_.sections[s].offset);
+        }
+
+        static header make_header(suffix_index_kind kind, std::size_t n)
+        {
+            header h{};
+            h.magic = header::expected_magic;
+            h.version = header::current_version;
+            h.kind = kind;
+            h.text_size = n;
+            return h;
+        }
+
+        static suffix_index build_suffix_array(std::string_view text, const std::vector<std::int32_t> &sa)
+        {
+            suffix_index index = allocate(make_header(suffix_index_kind::suffix_array, text.size()), 0);
+            std::memcpy(index.section<char>(header::text), text.data(), text.size());
+            std::ranges::copy(sa, index.section<std::uint32_t>(header::suffix_array));
+            index.seal();
+            return index;
+        }
+
+        static suffix_index build_fm_index(std::span<const unsigned char> text, const std::vector<std::int32_t> &sa,
+                                           std::uint32_t sample_rate)
+        {
+            const std::size_t n = text.size();
+            const std::size_t rows = n + 1; // Row 0 is the suffix `$`; row r > 0 is suffix sa[r - 1].
+            auto position = [&](std::size_t row) { return row == 0 ? n : static_cast<std::size_t>(sa[row - 1]); };
+
+            detail::fm_tables tables{};
+            std::array<std::uint64_t, 256> frequency{};
+            for (const unsigned char c : text)
+            {
+                ++frequency[c];
+            }
+            std::uint32_t sigma = 0;
+            std::uint64_t less = 1; // `$` sorts first.
+            for (std::size_t c = 0; c < 256; ++c)
+            {
+                tables.code[c] = frequency[c] != 0 ? static_cast<std::uint16_t>(sigma++) : detail::fm_tables::absent;
+                tables.less[c] = less;
+                less += frequency[c];
+            }
+            std::uint64_t samples = 0;
+            for (std::size_t row = 0; row < rows; ++row)
+            {
+                samples += position(row) % sample_rate == 0 || position(row) == n ? 1 : 0;
+            }
+
+            header h = make_header(suffix_index_kind::fm_index, n);
+            h.sigma = sigma;
+            h.sample_rate = sample_rate;
+            suffix_index index = allocate(h, samples);
+
+            // `$` has no byte; its row holds text[n - 1], which rank() then discounts.
+            auto *bwt = index.section<unsigned char>(header::bwt);
+            for (std::size_t row = 0; row < rows; ++row)
+            {
+                const std::size_t p = position(row);
+                if (p == 0)
+                {
+                    index.header_.dollar_row = row;
+                }
+                bwt[row] = p == 0 ? (n != 0 ? text[n - 1] : 0) : text[p - 1];
+            }
+            std::memcpy(index.section<detail::fm_tables>(header::tables), &tables, sizeof(tables));
+
+            auto *superblocks = index.section<std::uint32_t>(header::superblocks);
+            auto *blocks = index.section<std::uint16_t>(header::blocks);
+            std::vector<std::uint32_t> running(sigma);
+            std::vector<std::uint32_t> at_superblock(sigma);
+            for (std::size_t row = 0; row <= rows; ++row)
+            {
+                if (row % 65'536 == 0)
+                {
+                    at_superblock = running;
+                    std::ranges::copy(running, superblocks + (row >> 16) * sigma);
+                }
+                if (row % 256 == 0)
+                {
+                    for (std::uint32_t code = 0; code < sigma; ++code)
+                    {
+                        blocks[(row >> 8) * sigma + code] =
+                            static_cast<std::uint16_t>(running[code] - at_superblock[code]);
+                    }
+                }
+                if (row < rows && sigma != 0)
+                {
+                    ++running[tables.code[bwt[row]]];
+                }
+            }
+
+            auto *bits = index.section<std::uint64_t>(header::sampled_bits);
+            auto *ranks = index.section<std::uint32_t>(header::sampled_ranks);
+            auto *sample = index.section<std::uint32_t>(header::samples);
+            std::uint32_t taken = 0;
+            for (std::size_t row = 0; row < rows; ++row)
+            {
+                if (row % 64 == 0)
+                {
+                    ranks[row / 64] = taken;
+                }
+                const std::size_t p = position(row);
+                if (p % sample_rate == 0 || p == n)
+                {
+                    bits[row / 64] |= std::uint64_t{1} << (row % 64);
+                    sample[taken++] = static_cast<std::uint32_t>(p);
+                }
+            }
+            ranks[(rows + 63) / 64] = taken;
+            index.seal();
+            return index;
+        }
+
+        /**
+         * @brief Checks the header, the section table and, with `mapped_verify::full`, the checksum.
+         */
+        static std::expected<void, std::string> validate(std::span<const std::byte> bytes, mapped_verify verify)
+        {
+            if (bytes.size() < sizeof(header))
+            {
+                return std::unexpected("file too small for header");
+            }
+            header h;
+            std::memcpy(&h, bytes.data(), sizeof(h));
+            if (h.magic != header::expected_magic)
+            {
+                return std::unexpected("not a suffix index file");
+            }
+            if (h.version != header::current_version)
+            {
+                return std::unexpected("unsupported version " + std::to_string(h.version));
+            }
+            if ((h.kind != suffix_index_kind::suffix_array && h.kind != suffix_index_kind::fm_index) ||
+                h.text_size > max_text_size || h.sigma > 256 ||
+                (h.kind == suffix_index_kind::fm_index && (h.sample_rate == 0 || h.dollar_row > h.text_size)))
+            {
+                return std::unexpected("header fields out of range");
+            }
+            const std::uint64_t samples = h.sections[header::samples].size / sizeof(std::uint32_t);
+            const auto sizes = section_sizes(h.kind, h.text_size, h.sigma, samples);
+            std::uint64_t offset = sizeof(header);
+            for (std::size_t s = 0; s < header::section_count; ++s)
+            {
+                const auto [at, size] = h.sections[s];
+                if (size != sizes[s] || (size != 0 && at != offset) || at + size > bytes.size())
+                {
+                    return std::unexpected("section bounds out of range");
+                }
+                offset += size;
+            }
+            if (verify == mapped_verify::full)
+            {
+                checksum64 checksum;
+                checksum.update(bytes.subspan(sizeof(header)));
+                if (checksum.value() != h.checksum)
+                {
+                    return std::unexpected("checksum mismatch");
+                }
+            }
+            return {};
+        }
+
+        /**
+         * @brief Points the section views at @p bytes, a validated buffer or mapping.
+         */
+        void attach(std::span<const std::byte> bytes) noexcept
+        {
+            bytes_ = bytes;
+            std::memcpy(&header_, bytes.data(), sizeof(header_));
+            if (header_.kind == suffix_index_kind::suffix_array)
+            {
+                text_ = {view<char>(header::text), text_size()};
+                sa_ = view<std::uint32_t>(header::suffix_array);
+                return;
+            }
+            bwt_ = view<unsigned char>(header::bwt);
+            tables_ = view<detail::fm_tables>(header::tables);
+            superblocks_ = view<std::uint32_t>(header::superblocks);
+            blocks_ = view<std::uint16_t>(header::blocks);
+            sampled_bits_ = view<std::uint64_t>(header::sampled_bits);
+            sampled_ranks_ = view<std::uint32_t>(header::sampled_ranks);
+            samples_ = view<std::uint32_t>(header::samples);
+        }
+
+        /**
+         * @brief The rows (suffix array entries, or BWT rows) whose suffixes start with @p pattern.
+         */
+        row_range rows(std::string_view pattern) const noexcept
+        {
+            const std::size_t n = text_size();
+            if (header_.kind == suffix_index_kind::suffix_array)
+            {
+                if (pattern.empty())
+                {
+                    return {0, n + 1};
+                }
+                const std::span<const std::uint32_t> sa(sa_, n);
+                auto prefix = [&](std::uint32_t p) { return text_.substr(p, pattern.size()); };
+                const auto first =
+                    std::partition_point(sa.begin(), sa.end(), [&](std::uint32_t p) { return prefix(p) < pattern; });
+                const auto last =
+                    std::partition_point(first, sa.end(), [&](std::uint32_t p) { return prefix(p) == pattern; });
+                return {static_cast<std::size_t>(first - sa.begin()), static_cast<std::size_t>(last - sa.begin())};
+            }
+
+            // Backward search: extend the match one byte to the left at a time.
+            std::size_t first = 0;
+            std::size_t last = n + 1;
+            for (std::size_t i = pattern.size(); i-- > 0 && first < last;)
+            {
+                const auto c = static_cast<unsigned char>(pattern[i]);
+                if (tables_->code[c] == detail::fm_tables::absent)
+                {
+                    return {0, 0};
+                }
+                first = tables_->less[c] + rank(c, first);
+                last = tables_->less[c] + rank(c, last);
+            }
+            return first < last ? row_range{first, last} : row_range{0, 0};
+        }
+
+        /**
+         * @brief Occurrences of @p c in BWT rows `[0, row)`, not counting the `$` row.
+         */
+        std::size_t rank(unsigned char c, std::size_t row) const noexcept
+        {
+            const std::size_t sigma = header_.sigma;
+            const std::size_t code = tables_->code[c];
+            std::size_t r = superblocks_[(row >> 16) * sigma + code] + blocks_[(row >> 8) * sigma + code] +
+                            detail::count_byte(bwt_ + (row & ~std::size_t{255}), row & 255, c);
+            if (header_.dollar_row < row && bwt_[header_.dollar_row] == c)
+            {
+                --r;
+            }
+            return r;
+        }
+
+        /**
+         * @brief The text position of the suffix in @p row.
+         */
+        std::size_t position_of(std::size_t row) const noexcept
+        {
+            if (header_.kind == suffix_index_kind::suffix_array)
+            {
+                return sa_[row];
+            }
+            // LF mapping steps to the row of the suffix one position to the left,
+            // until a row with a sampled position. The `$` row (position 0) is sampled.
+            std::size_t steps = 0;
+            while ((sampled_bits_[row / 64] >> (row % 64) & 1) == 0)
+            {
+                const unsigned char c = bwt_[row];
+                row = tables_->less[c] + rank(c, row);
+                ++steps;
+            }
+            const std::uint64_t below = sampled_bits_[row / 64] & ((std::uint64_t{1} << (row % 64)) - 1);
+            return samples_[sampled_ranks_[row / 64] + std::popcount(below)] + steps;
+        }
+
+        std::vector<std::uint64_t> owned_; ///< The buffer of a built index; empty when mapped.
+        mapped_file file_;
+        std::span<const std::byte> bytes_;
+        header header_{};
+        std::string_view text_;
+        const std::uint32_t *sa_ = nullptr;
+        const unsigned char *bwt_ = nullptr;
+        const detail::fm_tables *tables_ = nullptr;
+        const std::uint32_t *superblocks_ = nullptr;
+        const std::uint16_t *blocks_ = nullptr;
+        const std::uint64_t *sampled_bits_ = nullptr;
+        const std::uint32_t *sampled_ranks_ = nullptr;
+        const std::uint32_t *samples_ = nullptr;
+    };
+} // namespace learnings
@@ -0,0 +1,356 @@
+/**
+ * @file utf8.hpp
+ * @brief UTF-8 decoding, simple case folding and a SIMD validator.
+ *
+ * The validator is the lookup algorithm of Keiser and Lemire ("Validating
+ * UTF-8 In Less Than One Instruction Per Byte", 2021), as used by simdjson:
+ * three `pshufb` table lookups on the high and low nibbles of each byte and
+ * the high nibble of its predecessor classify every two-byte window, and the
+ * few rules that need three or four bytes are checked with shifted copies of
+ * the input. Blocks of pure ASCII skip all of that. It needs SSSE3 and falls
+ * back to a scalar decoder elsewhere.
+ *
+ * Case folding covers the scripts whose simple case mappings keep the encoded
+ * length: ASCII, Latin-1, Latin Extended-A, Greek and Cyrillic. That makes a
+ * folded comparison a byte-aligned walk over both strings, which is what the
+ * case-insensitive search relies on. Other code points compare exactly.
+ */
+
+#pragma once
+
+#include "simd_dispatch.hpp"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+
+namespace learnings
+{
+    namespace detail
+    {
+        /**
+         * @brief A decoded character: a code point, or 0x110000 + byte for a byte that starts no valid sequence.
+         */
+        struct utf8_char
+        {
+            char32_t code_point;
+            std::size_t length;
+        };
+
+        /**
+         * @brief Decodes the character at the front of @p s, which must not be empty.
+         */
+        constexpr utf8_char decode_utf8(std::string_view s) noexcept
+        {
+            const auto b0 = static_cast<unsigned char>(s[0]);
+            const utf8_char raw{static_cast<char32_t>(0x110000 + b0), 1};
+            auto continuation = [&](std::size_t i) {
+                return i < s.size() && (static_cast<unsigned char>(s[i]) & 0xc0) == 0x80;
+            };
+            auto bits = [&](std::size_t i) { return static_cast<char32_t>(static_cast<unsigned char>(s[i]) & 0x3f); };
+            if (b0 < 0x80)
+            {
+                return {b0, 1};
+            }
+            if (b0 >= 0xc2 && b0 < 0xe0 && continuation(1))
+            {
+                return {(static_cast<char32_t>(b0 & 0x1f) << 6) | bits(1), 2};
+            }
+            if (b0 >= 0xe0 && b0 < 0xf0 && continuation(1) && continuation(2))
+            {
+                const char32_t cp = (static_cast<char32_t>(b0 & 0x0f) << 12) | (bits(1) << 6) | bits(2);
+                return cp >= 0x800 && (cp < 0xd800 || cp > 0xdfff) ? utf8_char{cp, 3} : raw;
+            }
+            if (b0 >= 0xf0 && b0 < 0xf5 && continuation(1) && continuation(2) && continuation(3))
+            {
+                const char32_t cp =
+                    (static_cast<char32_t>(b0 & 0x07) << 18) | (bits(1) << 12) | (bits(2) << 6) | bits(3);
+                return cp >= 0x10000 && cp <= 0x10ffff ? utf8_char{cp, 4} : raw;
+            }
+            return raw;
+        }
+
+        /**
+         * @brief Encodes a code point below U+0800 and returns its length.
+         */
+        constexpr std::size_t encode_utf8_short(char32_t cp, char (&out)[2]) noexcept
+        {
+            if (cp < 0x80)
+            {
+                out[0] = static_cast<char>(cp);
+                return 1;
+            }
+            out[0] = static_cast<char>(0xc0 | (cp >> 6));
+            out[1] = static_cast<char>(0x80 | (cp & 0x3f));
+            return 2;
+        }
+    } // namespace detail
+
+    /**
+     * @brief Simple case folding (to lower case) for ASCII, Latin-1, Latin Extended-A, Greek and Cyrillic.
+     * @details Every mapping keeps the UTF-8 length. Other code points are returned unchanged.
+     */
+    constexpr char32_t fold_case(char32_t cp) noexcept
+    {
+        auto even_to_odd = [cp](char32_t first, char32_t last) { return cp >= first && cp <= last && cp % 2 == 0; };
+        auto odd_to_even = [cp](char32_t first, char32_t last) { return cp >= first && cp <= last && cp % 2 == 1; };
+        if (cp < 0x80)
+        {
+            return cp >= 'A' && cp <= 'Z' ? cp + 0x20 : cp;
+        }
+        if ((cp >= 0xc0 && cp <= 0xde && cp != 0xd7) || (cp >= 0x391 && cp <= 0x3ab && cp != 0x3a2) ||
+            (cp >= 0x410 && cp <= 0x42f))
+        {
+            return cp + 0x20;
+        }
+        if (even_to_odd(0x100, 0x12f) || even_to_odd(0x132, 0x137) || odd_to_even(0x139, 0x148) ||
+            even_to_odd(0x14a, 0x177) || odd_to_even(0x179, 0x17e) || cp == 0x3c2) // Final sigma folds to sigma.
+        {
+            return cp + 1;
+        }
+        if (cp == 0x178)
+        {
+            return 0xff; // Y with diaeresis.
+        }
+        if (cp >= 0x386 && cp <= 0x38f) // Greek capitals with tonos.
+        {
+            switch (cp)
+            {
+            case 0x386:
+                return 0x3ac;
+            case 0x388:
+            case 0x389:
+            case 0x38a:
+                return cp + 0x25;
+            case 0x38c:
+                return 0x3cc;
+            case 0x38e:
+            case 0x38f:
+                return cp + 0x3f;
+            default:
+                return cp;
+            }
+        }
+        if (cp >= 0x400 && cp <= 0x40f)
+        {
+            return cp + 0x50;
+        }
+        return cp;
+    }
+
+    namespace detail
+    {
+        /**
+         * @brief Calls @p fn(cp) for every code point whose fold is @p folded (including itself).
+         */
+        template <typename F>
+        constexpr void for_each_case_variant(char32_t folded, F fn)
+        {
+            // Every rule in fold_case adds 0x20, 1 or 0x50, except U+0178 -> U+00FF and the
+            // Greek capitals with tonos, which add 0x25, 0x26, 0x3f or 0x40.
+            const char32_t candidates[] = {folded,        folded - 0x20, folded - 1,    folded - 0x50, 0x178,
+                                           folded - 0x25, folded - 0x26, folded - 0x3f, folded - 0x40};
+            for (const char32_t c : candidates)
+            {
+                if (c < 0x110000 && fold_case(c) == folded)
+                {
+                    fn(c);
+                }
+            }
+        }
+
+        /**
+         * @brief Compares @p haystack's prefix with @p needle, folding both; true if they are equal.
+         * @details Relies on folding preserving lengths, so both sides advance together.
+         */
+        constexpr bool utf8_iequal_prefix(std::string_view haystack, std::string_view needle) noexcept
+        {
+            if (haystack.size() < needle.size())
+            {
+                return false;
+            }
+            std::size_t i = 0;
+            while (i < needle.size())
+            {
+                const auto n = static_cast<unsigned char>(needle[i]);
+                const auto h = static_cast<unsigned char>(haystack[i]);
+                if (n < 0x80 && h < 0x80)
+                {
+                    if (fold_case(n) != fold_case(h))
+                    {
+                        return false;
+                    }
+                    ++i;
+                    continue;
+                }
+                const utf8_char nc = decode_utf8(needle.substr(i));
+                const utf8_char hc = decode_utf8(haystack.substr(i, needle.size() - i));
+                if (nc.length != hc.length || fold_case(nc.code_point) != fold_case(hc.code_point))
+                {
+                    return false;
+                }
+                i += nc.length;
+            }
+            return true;
+        }
+
+        /**
+         * @brief Scalar validator, used for the tail of SIMD validation and without SSSE3.
+         */
+        constexpr bool validate_utf8_scalar(std::string_view s) noexcept
+        {
+            for (std::size_t i = 0; i < s.size();)
+            {
+                const utf8_char c = decode_utf8(s.substr(i));
+                if (c.code_point >= 0x110000)
+                {
+                    return false;
+                }
+                i += c.length;
+            }
+            return true;
+        }
+
+#if LEARNINGS_SIMD_X86
+        /**
+         * @brief Incremental SSSE3 UTF-8 validator over 16-byte blocks (Keiser-Lemire lookup algorithm).
+         */
+        class utf8_validator_ssse3
+        {
+        public:
+            /**
+             * @brief Checks the next 16 bytes; sequences may continue into the next block.
+             */
+            LEARNINGS_TARGET("ssse3")
+            void update(__m128i input) noexcept
+            {
+                if (_mm_movemask_epi8(input) == 0)
+                {
+                    error_ = _mm_or_si128(error_, incomplete_); // ASCII cannot complete a pending sequence.
+                }
+                else
+                {
+                    const __m128i prev1 = _mm_alignr_epi8(input, previous_, 15);
+                    const __m128i prev2 = _mm_alignr_epi8(input, previous_, 14);
+                    const __m128i prev3 = _mm_alignr_epi8(input, previous_, 13);
+                    const __m128i special = special_cases(input, prev1);
+                    // Third and fourth bytes of a sequence must be continuations, and nothing else may be one twice.
+                    const __m128i third = _mm_subs_epu8(prev2, _mm_set1_epi8(static_cast<char>(0xe0 - 0x80)));
+                    const __m128i fourth = _mm_subs_epu8(prev3, _mm_set1_epi8(static_cast<char>(0xf0 - 0x80)));
+                    const __m128i must_continue =
+                        _mm_and_si128(_mm_or_si128(third, fourth), _mm_set1_epi8(static_cast<char>(0x80)));
+                    error_ = _mm_or_si128(error_, _mm_xor_si128(must_continue, special));
+                    // A lead byte in the last three positions needs bytes from the next block.
+                    const __m128i limits = _mm_setr_epi8(-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+                                                         static_cast<char>(0xf0 - 1), static_cast<char>(0xe0 - 1),
+                                                         static_cast<char>(0xc0 - 1));
+                    incomplete_ = _mm_subs_epu8(input, limits);
+                }
+                previous_ = input;
+            }
+
+            /**
+             * @brief Returns whether every byte so far is valid and no sequence is left open.
+             */
+            LEARNINGS_TARGET("ssse3")
+            bool finish() const noexcept
+            {
+                const __m128i error = _mm_or_si128(error_, incomplete_);
+                return _mm_movemask_epi8(_mm_cmpeq_epi8(error, _mm_setzero_si128())) == 0xffff;
+            }
+
+            /**
+             * @brief Returns whether an error has been seen in the blocks so far (open sequences excluded).
+             */
+            LEARNINGS_TARGET("ssse3")
+            bool failed() const noexcept
+            {
+                return _mm_movemask_epi8(_mm_cmpeq_epi8(error_, _mm_setzero_si128())) != 0xffff;
+            }
+
+        private:
+            LEARNINGS_TARGET("ssse3")
+            static __m128i special_cases(__m128i input, __m128i prev1) noexcept
+            {
+                constexpr char too_short = 1 << 0;  // Lead byte or ASCII followed by a lead byte.
+                constexpr char too_long = 1 << 1;   // ASCII followed by a continuation.
+                constexpr char overlong_3 = 1 << 2; // 11100000 100_____
+                constexpr char too_large = 1 << 3;  // Above U+10FFFF.
+                constexpr char surrogate = 1 << 4;  // 11101101 101_____
+                constexpr char overlong_2 = 1 << 5; // 1100000_ 10______
+                constexpr char too_large_1000 = 1 << 6;
+                constexpr char overlong_4 = 1 << 6; // 11110000 1000____
+                constexpr char two_continuations = static_cast<char>(1 << 7);
+                constexpr char carry = too_short | too_long | two_continuations;
+
+                const __m128i nibble = _mm_set1_epi8(0x0f);
+                const __m128i byte_1_high = _mm_shuffle_epi8(
+                    _mm_setr_epi8(too_long, too_long, too_long, too_long, too_long, too_long, too_long, too_long,
+                                  two_continuations, two_continuations, two_continuations, two_continuations,
+                                  too_short | overlong_2, too_short, too_short | overlong_3 | surrogate,
+                                  too_short | too_large | too_large_1000 | overlong_4),
+                    _mm_and_si128(_mm_srli_epi16(prev1, 4), nibble));
+                const __m128i byte_1_low = _mm_shuffle_epi8(
+                    _mm_setr_epi8(carry | overlong_3 | overlong_2 | overlong_4, carry | overlong_2, carry, carry,
+                                  carry | too_large, carry | too_large | too_large_1000,
+                                  carry | too_large | too_large_1000, carry | too_large | too_large_1000,
+                                  carry | too_large | too_large_1000, carry | too_large | too_large_1000,
+                                  carry | too_large | too_large_1000, carry | too_large | too_large_1000,
+                                  carry | too_large | too_large_1000, carry | too_large | too_large_1000 | surrogate,
+                                  carry | too_large | too_large_1000, carry | too_large | too_large_1000),
+                    _mm_and_si128(prev1, nibble));
+                const __m128i byte_2_high = _mm_shuffle_epi8(
+                    _mm_setr_epi8(too_short, too_short, too_short, too_short, too_short, too_short, too_short,
+                                  too_short,
+                                  too_long | overlong_2 | two_continuations | overlong_3 | too_large_1000 | overlong_4,
+                                  too_long | overlong_2 | two_continuations | overlong_3 | too_large,
+                                  too_long | overlong_2 | two_continuations | surrogate | too_large,
+                                  too_long | overlong_2 | two_continuations | surrogate | too_large, too_short,
+                                  too_short, too_short, too_short),
+                    _mm_and_si128(_mm_srli_epi16(input, 4), nibble));
+                return _mm_and_si128(_mm_and_si128(byte_1_high, byte_1_low), byte_2_high);
+            }
+
+            __m128i previous_ = _mm_setzero_si128();
+            __m128i error_ = _mm_setzero_si128();
+            __m128i incomplete_ = _mm_setzero_si128();
+        };
+
+        /**
+         * @brief Feeds the bytes of @p s from @p offset on, the last partial block zero-padded.
+         */
+        LEARNINGS_TARGET("ssse3")
+        inline void validate_utf8_rest(utf8_validator_ssse3 &validator, std::string_view s, std::size_t offset) noexcept
+        {
+            for (; offset + 16 <= s.size(); offset += 16)
+            {
+                validator.update(_mm_loadu_si128(reinterpret_cast<const __m128i *>(s.data() + offset)));
+            }
+            if (offset < s.size())
+            {
+                alignas(16) char block[16] = {}; // Zeros are ASCII and close nothing.
+                std::memcpy(block, s.data() + offset, s.size() - offset);
+                validator.update(_mm_load_si128(reinterpret_cast<const __m128i *>(block)));
+            }
+        }
+#endif
+    } // namespace detail
+
+    /**
+     * @brief Returns whether @p s is well-formed UTF-8 (no overlongs, surrogates or values above U+10FFFF).
+     */
+    inline bool validate_utf8(std::string_view s) noexcept
+    {
+#if LEARNINGS_SIMD_X86
+        if (active_simd_level() >= simd_level::ssse3)
+        {
+            detail::utf8_validator_ssse3 validator;
+            detail::validate_utf8_rest(validator, s, 0);
+            return validator.finish();
+        }
+#endif
+        return detail::validate_utf8_scalar(s);
+    }
+} // namespace learnings
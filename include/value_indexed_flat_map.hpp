@@ -0,0 +1,211 @@
+/**
+ * @file value_indexed_flat_map.hpp
+ * @brief `std::flat_map` with a secondary index ordered by value.
+ *
+ * Questions such as "who is between 25 and 35" or "who are the ten oldest"
+ * are a full scan of a key-ordered map. `value_indexed_flat_map` keeps, next
+ * to the map, the positions of its entries sorted by value, so such queries
+ * cost two binary searches plus the size of the answer. Positions are 32-bit
+ * indices into the map's containers and are kept in step with every insert
+ * and erase; both already move O(n) elements in a flat_map, and renumbering
+ * the index is a linear pass of the same order.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <flat_map>
+#include <functional>
+#include <limits>
+#include <numeric>
+#include <ranges>
+#include <span>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace learnings
+{
+    /**
+     * @brief A read-mostly flat_map that also answers value-range and top-k queries.
+     *
+     * @tparam Key          The key type.
+     * @tparam T            The mapped type.
+     * @tparam Compare      The key ordering.
+     * @tparam ValueCompare The value ordering used by the index.
+     * @details Entries with equal values are indexed in key order.
+     */
+    template <typename Key, typename T, typename Compare = std::less<Key>, typename ValueCompare = std::less<T>>
+    class value_indexed_flat_map
+    {
+    public:
+        using map_type = std::flat_map<Key, T, Compare>;
+        using const_iterator = typename map_type::const_iterator;
+        using position = std::uint32_t;
+
+        value_indexed_flat_map() = default;
+
+        /**
+         * @brief Adopts @p map and sorts its positions by value. O(n log n).
+         * @throws std::length_error if the map has more entries than a position can address.
+         */
+        explicit value_indexed_flat_map(map_type map, ValueCompare value_comp = ValueCompare())
+            : map_(std::move(map)), value_comp_(std::move(value_comp))
+        {
+            check_capacity(map_.size());
+            index_.resize(map_.size());
+            std::iota(index_.begin(), index_.end(), position{0});
+            std::ranges::stable_sort(index_, [this](position a, position b) {
+                return value_comp_(value_at(a), value_at(b));
+            });
+        }
+
+        const map_type &map() const noexcept { return map_; }
+        std::size_t size() const noexcept { return map_.size(); }
+        const_iterator begin() const noexcept { return map_.begin(); }
+        const_iterator end() const noexcept { return map_.end(); }
+        const_iterator find(const Key &key) const { return map_.find(key); }
+        bool contains(const Key &key) const { return map_.contains(key); }
+
+        /**
+         * @brief Inserts or overwrites the entry for @p key, updating the index. O(n).
+         */
+        void insert_or_assign(const Key &key, T value)
+        {
+            auto it = map_.lower_bound(key);
+            auto p = static_cast<position>(it - map_.begin());
+            if (it != map_.end() && !map_.key_comp()(key, it->first))
+            {
+                index_.erase(locate(p));
+                it->second = std::move(value);
+            }
+            else
+            {
+                check_capacity(map_.size() + 1);
+                map_.emplace_hint(it, key, std::move(value));
+                for (position &q : index_)
+                {
+                    q += static_cast<position>(q >= p); // Entries at or after p moved up by one.
+                }
+            }
+            index_.insert(slot_for(p), p);
+        }
+
+        /**
+         * @brief Erases the entry for @p key, if any, updating the index. O(n).
+         * @return Whether an entry was erased.
+         */
+        bool erase(const Key &key)
+        {
+            const auto it = map_.find(key);
+            if (it == map_.end())
+            {
+                return false;
+            }
+            const auto p = static_cast<position>(it - map_.begin());
+            index_.erase(locate(p));
+            map_.erase(it);
+            for (position &q : index_)
+            {
+                q -= static_cast<position>(q > p);
+            }
+            return true;
+        }
+
+        /**
+         * @brief Returns the entries with values in [@p lo, @p hi], in value order. O(log n) plus iteration.
+         * @return A view of map iterators; invalidated by the next insert or erase.
+         */
+        auto values_between(const T &lo, const T &hi) const
+        {
+            const auto first = std::ranges::lower_bound(index_, lo, value_comp_, [this](position p) -> const T & {
+                return value_at(p);
+            });
+            const auto last = std::ranges::upper_bound(first, index_.end(), hi, value_comp_,
+                                                       [this](position p) -> const T & { return value_at(p); });
+            return entries(std::span<const position>(first, last));
+        }
+
+        /**
+         * @brief Returns how many entries have values in [@p lo, @p hi]. O(log n).
+         */
+        std::size_t count_between(const T &lo, const T &hi) const
+        {
+            return static_cast<std::size_t>(std::ranges::distance(values_between(lo, hi)));
+        }
+
+        /**
+         * @brief Returns the @p k entries with the smallest values, smallest first. O(k).
+         */
+        auto smallest(std::size_t k) const
+        {
+            return entries(std::span<const position>(index_).first(std::min(k, index_.size())));
+        }
+
+        /**
+         * @brief Returns the @p k entries with the largest values, largest first. O(k).
+         */
+        auto largest(std::size_t k) const
+        {
+            return entries(std::span<const position>(index_).last(std::min(k, index_.size()))) | std::views::reverse;
+        }
+
+        /**
+         * @brief Returns the heap bytes owned by the index alone.
+         */
+        std::size_t index_bytes() const noexcept { return index_.capacity() * sizeof(position); }
+
+    private:
+        static void check_capacity(std::size_t n)
+        {
+            if (n > std::numeric_limits<position>::max())
+            {
+                throw std::length_error("value_indexed_flat_map: too many entries");
+            }
+        }
+
+        const T &value_at(position p) const noexcept { return map_.values()[p]; }
+
+        /// Orders positions by value, then by position, i.e. by key among equal values.
+        bool index_less(position a, position b) const
+        {
+            if (value_comp_(value_at(a), value_at(b)))
+            {
+                return true;
+            }
+            return !value_comp_(value_at(b), value_at(a)) && a < b;
+        }
+
+        /**
+         * @brief Returns where position @p p belongs in the index, given its current value.
+         */
+        typename std::vector<position>::iterator slot_for(position p)
+        {
+            return std::ranges::lower_bound(index_, p, [this](position a, position b) { return index_less(a, b); });
+        }
+
+        /**
+         * @brief Finds the index slot holding @p p; its entry must be indexed under its current value.
+         */
+        typename std::vector<position>::iterator locate(position p)
+        {
+            const auto slot = slot_for(p);
+            if (slot == index_.end() || *slot != p)
+            {
+                throw std::logic_error("value_indexed_flat_map: index out of sync");
+            }
+            return slot;
+        }
+
+        auto entries(std::span<const position> positions) const
+        {
+            return positions | std::views::transform([this](position p) { return map_.begin() + p; });
+        }
+
+        map_type map_;
+        std::vector<position> index_; ///< Positions into map_, ordered by (value, position).
+        [[no_unique_address]] ValueCompare value_comp_;
+    };
+} // namespace learnings
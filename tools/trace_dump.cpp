@@ -0,0 +1,60 @@
+/**
+ * @file trace_dump.cpp
+ * @brief Prints a file written by `trace_ring_buffer::dump` as text, one access per line.
+ *
+ * Columns are the time since the first event in microseconds, the recording
+ * thread's index, the object address and the accessor overload. Events come
+ * from each thread's most recent `trace_ring::capacity` accesses.
+ *
+ * Usage: `trace_dump <file> [--summary]`. With `--summary`, prints the number
+ * of accesses per thread and kind instead of every event.
+ */
+
+#include "access_trace.hpp"
+
+#include <cstdlib>
+#include <map>
+#include <print>
+#include <string_view>
+#include <utility>
+
+int main(int argc, char **argv)
+{
+    if (argc < 2)
+    {
+        std::print(stderr, "usage: {} <file> [--summary]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+    const auto trace = learnings::read_trace_file(argv[1]);
+    if (!trace)
+    {
+        std::print(stderr, "{}\n", trace.error());
+        return EXIT_FAILURE;
+    }
+    const auto &[header, events] = *trace;
+
+    if (argc > 2 && std::string_view(argv[2]) == "--summary")
+    {
+        std::map<std::pair<std::uint32_t, learnings::access_kind>, std::size_t> counts;
+        for (const auto &event : events)
+        {
+            ++counts[{event.thread, event.kind}];
+        }
+        std::print("thread,access,count\n");
+        for (const auto &[key, count] : counts)
+        {
+            std::print("{},{},{}\n", key.first, learnings::to_string(key.second), count);
+        }
+        return EXIT_SUCCESS;
+    }
+
+    const std::uint64_t origin = events.empty() ? 0 : events.front().tick;
+    const double us_per_tick = header.ticks_per_second > 0 ? 1e6 / header.ticks_per_second : 0.0;
+    std::print("time_us,thread,object,access\n");
+    for (const auto &event : events)
+    {
+        std::print("{:.3f},{},{:#x},{}\n", static_cast<double>(event.tick - origin) * us_per_tick, event.thread,
+                   event.object, learnings::to_string(event.kind));
+    }
+    return EXIT_SUCCESS;
+}